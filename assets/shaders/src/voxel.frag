@@ -4,10 +4,13 @@ layout(set = 0, binding = 0)
 uniform sampler2D texture_sampler;
 
 layout(location = 0) in vec2 frag_uv;
+layout(location = 1) in float frag_shade;
 
 layout(location = 0) out vec4 out_color;
 
 void main()
 {
-    out_color = texture(texture_sampler, frag_uv);
+    vec4 color = texture(texture_sampler, frag_uv);
+
+    out_color = vec4(color.rgb * frag_shade, color.a);
 }
\ No newline at end of file
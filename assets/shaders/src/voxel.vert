@@ -4,21 +4,77 @@ layout(push_constant)
 uniform Push
 {
     mat4 projection_view_matrix;
+    uint sector_index;
 }
 push;
 
+// Mirrors VulkanCullSector in render/render.h. Each sector is drawn as the
+// instance of its index, and its minimum corner holds the cell size in w.
+
+struct Sector
+{
+    vec4 min_position;
+    vec4 max_position;
+    uint vertex_count;
+    uint first_vertex;
+    uint face_count;
+};
+
+layout(std430, set = 1, binding = 0)
+readonly buffer SectorBuffer
+{
+    Sector sector_array[];
+};
+
+// Packed voxel vertex, mirroring VoxelVertex in render/mesh.h:
+// x 5 | y 5 | z 5 | direction 3 | u 5 | v 5 | ambient occlusion 2
+// and block light 4 | sky light 4
+
 layout(location = 0)
-in vec3 in_position;
+in uint in_data;
 
 layout(location = 1)
-in vec2 in_uv;
+in uint in_light;
 
 layout(location = 0)
 out vec2 frag_uv;
 
+layout(location = 1)
+out float frag_shade;
+
+const float face_shade[6] = float[6](0.8, 0.8, 0.9, 0.9, 1.0, 0.6);
+
+// Corner brightness by ambient occlusion, from fully occluded to open
+
+const float ambient_occlusion_shade[4] = float[4](0.4, 0.6, 0.8, 1.0);
+
+// Each light level below the maximum dims by a constant factor, with a floor
+// so unlit caves stay readable
+
+const float light_falloff = 0.8;
+const float light_minimum = 0.05;
+
 void main()
 {
-    gl_Position = push.projection_view_matrix * vec4(in_position, 1.0);
+    uvec3 corner = uvec3(
+        bitfieldExtract(in_data, 0, 5),
+        bitfieldExtract(in_data, 5, 5),
+        bitfieldExtract(in_data, 10, 5)
+    );
+
+    uint direction = bitfieldExtract(in_data, 15, 3);
+
+    vec4 sector_origin = sector_array[gl_InstanceIndex].min_position;
+
+    vec3 position = sector_origin.xyz + vec3(corner) * sector_origin.w;
+
+    gl_Position = push.projection_view_matrix * vec4(position, 1.0);
+
+    frag_uv = vec2(bitfieldExtract(in_data, 18, 5), bitfieldExtract(in_data, 23, 5));
+    uint ambient_occlusion = bitfieldExtract(in_data, 28, 2);
+
+    uint light_level = max(bitfieldExtract(in_light, 4, 4), bitfieldExtract(in_light, 0, 4));
+    float light_shade = max(pow(light_falloff, float(15 - light_level)), light_minimum);
 
-    frag_uv = in_uv;
+    frag_shade = face_shade[direction] * ambient_occlusion_shade[ambient_occlusion] * light_shade;
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#version 450
+
+#extension GL_ARB_shader_draw_parameters : require
+
+// Mirrors VoxelPushConstants in render/render.h. Indirect draws push sector
+// index 0 and draw each sector's faces as the draw of its index.
+
+layout(push_constant) 
+uniform Push
+{
+    mat4 projection_view_matrix;
+    uint sector_index;
+}
+push;
+
+// Mirrors VulkanCullSector in render/render.h. The minimum corner holds the
+// cell size in w.
+
+struct Sector
+{
+    vec4 min_position;
+    vec4 max_position;
+    uint vertex_count;
+    uint first_vertex;
+    uint face_count;
+};
+
+layout(std430, set = 1, binding = 0)
+readonly buffer SectorBuffer
+{
+    Sector sector_array[];
+};
+
+// Packed voxel faces in the vertex arena, mirroring VoxelFace in
+// render/mesh.h:
+// x 4 | y 4 | z 4 | direction 3 | lod 2 | ambient occlusion 4 x 2 | light 4
+
+layout(std430, set = 0, binding = 1)
+readonly buffer FaceBuffer
+{
+    uint face_array[];
+};
+
+layout(location = 0)
+out vec2 frag_uv;
+
+layout(location = 1)
+out float frag_shade;
+
+// Corners of each face, counter-clockwise around the outward normal, as in
+// render/mesh.c
+
+const vec3 face_corner[24] = vec3[24](
+    vec3(1, 0, 0), vec3(1, 1, 0), vec3(1, 1, 1), vec3(1, 0, 1),
+    vec3(0, 0, 0), vec3(0, 0, 1), vec3(0, 1, 1), vec3(0, 1, 0),
+    vec3(0, 1, 0), vec3(0, 1, 1), vec3(1, 1, 1), vec3(1, 1, 0),
+    vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 0, 1), vec3(0, 0, 1),
+    vec3(0, 0, 1), vec3(1, 0, 1), vec3(1, 1, 1), vec3(0, 1, 1),
+    vec3(0, 0, 0), vec3(0, 1, 0), vec3(1, 1, 0), vec3(1, 0, 0)
+);
+
+// Axes spanned by each face, mapped to the texture u and v coordinates
+
+const uvec2 face_tangent_axis[6] = uvec2[6](
+    uvec2(1, 2), uvec2(1, 2), uvec2(0, 2), uvec2(0, 2), uvec2(0, 1), uvec2(0, 1)
+);
+
+// Strip orders of the corners, splitting the quad along the diagonal through
+// corners 0 and 2, or through corners 1 and 3 when those are less occluded
+
+const uint strip_corner[8] = uint[8](1, 2, 0, 3, 0, 1, 3, 2);
+
+const float face_shade[6] = float[6](0.8, 0.8, 0.9, 0.9, 1.0, 0.6);
+
+// Corner brightness by ambient occlusion, from fully occluded to open
+
+const float ambient_occlusion_shade[4] = float[4](0.4, 0.6, 0.8, 1.0);
+
+// Each light level below the maximum dims by a constant factor, with a floor
+// so unlit caves stay readable
+
+const float light_falloff = 0.8;
+const float light_minimum = 0.05;
+
+void main()
+{
+    uint face = face_array[gl_InstanceIndex];
+
+    uvec3 cell = uvec3(
+        bitfieldExtract(face, 0, 4),
+        bitfieldExtract(face, 4, 4),
+        bitfieldExtract(face, 8, 4)
+    );
+
+    uint direction = bitfieldExtract(face, 12, 3);
+    uint scale = 1u << bitfieldExtract(face, 15, 2);
+
+    uint ambient_occlusion_mask = bitfieldExtract(face, 17, 8);
+
+    uint ambient_occlusion_array[4] = uint[4](
+        bitfieldExtract(ambient_occlusion_mask, 0, 2),
+        bitfieldExtract(ambient_occlusion_mask, 2, 2),
+        bitfieldExtract(ambient_occlusion_mask, 4, 2),
+        bitfieldExtract(ambient_occlusion_mask, 6, 2)
+    );
+
+    bool is_flipped =
+        ambient_occlusion_array[1] + ambient_occlusion_array[3] >
+        ambient_occlusion_array[0] + ambient_occlusion_array[2];
+
+    uint corner_index = strip_corner[(is_flipped ? 4 : 0) + gl_VertexIndex];
+    vec3 corner = face_corner[direction * 4 + corner_index];
+
+    Sector sector = sector_array[push.sector_index + gl_DrawIDARB];
+
+    // Cells of a downsampled level are clipped to the far side of the sector,
+    // as the mesher clips them
+
+    float sector_size_in_cells = round((sector.max_position.x - sector.min_position.x) / sector.min_position.w);
+
+    vec3 min_corner = vec3(cell * scale);
+    vec3 max_corner = min(vec3((cell + 1u) * scale), vec3(sector_size_in_cells));
+
+    vec3 corner_position = mix(min_corner, max_corner, corner);
+
+    vec3 position = sector.min_position.xyz + corner_position * sector.min_position.w;
+
+    gl_Position = push.projection_view_matrix * vec4(position, 1.0);
+
+    uvec2 tangent_axis = face_tangent_axis[direction];
+
+    vec3 extent = max_corner - min_corner;
+
+    frag_uv = vec2(
+        corner[tangent_axis.x] * extent[tangent_axis.x],
+        corner[tangent_axis.y] * extent[tangent_axis.y]
+    );
+
+    uint light_level = bitfieldExtract(face, 25, 4);
+    float light_shade = max(pow(light_falloff, float(15 - light_level)), light_minimum);
+
+    frag_shade = face_shade[direction] * ambient_occlusion_shade[ambient_occlusion_array[corner_index]] * light_shade;
+}
\ No newline at end of file
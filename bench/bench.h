@@ -0,0 +1,28 @@
+#ifndef BENCH_H
+#define BENCH_H 1
+
+#include <stdio.h>
+#include <time.h>
+
+#include "core/types.h"
+
+static inline f64 bench_get_time(void)
+{
+    struct timespec time_spec;
+    clock_gettime(CLOCK_MONOTONIC, &time_spec);
+
+    return (f64)time_spec.tv_sec + (f64)time_spec.tv_nsec * 1e-9;
+}
+
+static inline void bench_report(const char* name, f64 elapsed_seconds, f64 item_count, const char* item_name)
+{
+    printf(
+        "%-40s %10.3f ms %14.2f M%s/s\n",
+        name,
+        elapsed_seconds * 1e3,
+        item_count / elapsed_seconds * 1e-6,
+        item_name
+    );
+}
+
+#endif
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench/bench.h"
+#include "core/math/morton.h"
+
+#define CELL_LAYOUT_BENCH_SIZE_LOG2     6
+#define CELL_LAYOUT_BENCH_SIZE          (1 << CELL_LAYOUT_BENCH_SIZE_LOG2)
+#define CELL_LAYOUT_BENCH_VOLUME        (CELL_LAYOUT_BENCH_SIZE * CELL_LAYOUT_BENCH_SIZE * CELL_LAYOUT_BENCH_SIZE)
+#define CELL_LAYOUT_BENCH_ITERATIONS    16
+
+typedef u32 (*CellLayoutIndexFunction)(u32 x, u32 y, u32 z);
+
+static u32 cell_layout_index_linear(u32 x, u32 y, u32 z)
+{
+    return x | y << CELL_LAYOUT_BENCH_SIZE_LOG2 | z << (2 * CELL_LAYOUT_BENCH_SIZE_LOG2);
+}
+
+static u32 cell_layout_index_morton(u32 x, u32 y, u32 z)
+{
+    return morton_encode_3d(x, y, z);
+}
+
+static inline u32 cell_layout_sample(const u16* cell_array, CellLayoutIndexFunction index_function, u32 x, u32 y, u32 z)
+{
+    if (x >= CELL_LAYOUT_BENCH_SIZE || y >= CELL_LAYOUT_BENCH_SIZE || z >= CELL_LAYOUT_BENCH_SIZE)
+    {
+        return 0;
+    }
+
+    return cell_array[index_function(x, y, z)] != 0;
+}
+
+static inline u32 cell_layout_count_neighbors(const u16* cell_array, CellLayoutIndexFunction index_function, u32 x, u32 y, u32 z)
+{
+    return
+        cell_layout_sample(cell_array, index_function, x - 1, y, z) +
+        cell_layout_sample(cell_array, index_function, x + 1, y, z) +
+        cell_layout_sample(cell_array, index_function, x, y - 1, z) +
+        cell_layout_sample(cell_array, index_function, x, y + 1, z) +
+        cell_layout_sample(cell_array, index_function, x, y, z - 1) +
+        cell_layout_sample(cell_array, index_function, x, y, z + 1);
+}
+
+static u64 cell_layout_sweep_x(const u16* cell_array, CellLayoutIndexFunction index_function)
+{
+    u64 neighbor_count = 0;
+
+    for (u32 z = 0; z < CELL_LAYOUT_BENCH_SIZE; ++z)
+    {
+        for (u32 y = 0; y < CELL_LAYOUT_BENCH_SIZE; ++y)
+        {
+            for (u32 x = 0; x < CELL_LAYOUT_BENCH_SIZE; ++x)
+            {
+                neighbor_count += cell_layout_count_neighbors(cell_array, index_function, x, y, z);
+            }
+        }
+    }
+
+    return neighbor_count;
+}
+
+static u64 cell_layout_sweep_z(const u16* cell_array, CellLayoutIndexFunction index_function)
+{
+    u64 neighbor_count = 0;
+
+    for (u32 x = 0; x < CELL_LAYOUT_BENCH_SIZE; ++x)
+    {
+        for (u32 y = 0; y < CELL_LAYOUT_BENCH_SIZE; ++y)
+        {
+            for (u32 z = 0; z < CELL_LAYOUT_BENCH_SIZE; ++z)
+            {
+                neighbor_count += cell_layout_count_neighbors(cell_array, index_function, x, y, z);
+            }
+        }
+    }
+
+    return neighbor_count;
+}
+
+static void cell_layout_fill(u16* cell_array, CellLayoutIndexFunction index_function)
+{
+    srand(1);
+
+    for (u32 z = 0; z < CELL_LAYOUT_BENCH_SIZE; ++z)
+    {
+        for (u32 y = 0; y < CELL_LAYOUT_BENCH_SIZE; ++y)
+        {
+            for (u32 x = 0; x < CELL_LAYOUT_BENCH_SIZE; ++x)
+            {
+                cell_array[index_function(x, y, z)] = (u16)(rand() % 3 == 0);
+            }
+        }
+    }
+}
+
+static void cell_layout_run(const char* layout_name, CellLayoutIndexFunction index_function)
+{
+    u16* cell_array = malloc(sizeof(u16) * CELL_LAYOUT_BENCH_VOLUME);
+
+    cell_layout_fill(cell_array, index_function);
+
+    char name[64];
+    u64 checksum = 0;
+
+    f64 start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < CELL_LAYOUT_BENCH_ITERATIONS; ++iteration)
+    {
+        checksum += cell_layout_sweep_x(cell_array, index_function);
+    }
+
+    snprintf(name, sizeof(name), "%s neighbors, x-major sweep", layout_name);
+    bench_report(name, bench_get_time() - start_time, (f64)CELL_LAYOUT_BENCH_VOLUME * CELL_LAYOUT_BENCH_ITERATIONS, "cells");
+
+    start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < CELL_LAYOUT_BENCH_ITERATIONS; ++iteration)
+    {
+        checksum += cell_layout_sweep_z(cell_array, index_function);
+    }
+
+    snprintf(name, sizeof(name), "%s neighbors, z-major sweep", layout_name);
+    bench_report(name, bench_get_time() - start_time, (f64)CELL_LAYOUT_BENCH_VOLUME * CELL_LAYOUT_BENCH_ITERATIONS, "cells");
+
+    printf("checksum: %llu\n", (unsigned long long)checksum);
+
+    free(cell_array);
+}
+
+static void cell_layout_run_encode(void)
+{
+    u32* x_array = malloc(sizeof(u32) * CELL_LAYOUT_BENCH_VOLUME);
+    u32* y_array = malloc(sizeof(u32) * CELL_LAYOUT_BENCH_VOLUME);
+    u32* z_array = malloc(sizeof(u32) * CELL_LAYOUT_BENCH_VOLUME);
+    u32* code_array = malloc(sizeof(u32) * CELL_LAYOUT_BENCH_VOLUME);
+
+    for (u32 index = 0; index < CELL_LAYOUT_BENCH_VOLUME; ++index)
+    {
+        x_array[index] = index & (CELL_LAYOUT_BENCH_SIZE - 1);
+        y_array[index] = (index >> CELL_LAYOUT_BENCH_SIZE_LOG2) & (CELL_LAYOUT_BENCH_SIZE - 1);
+        z_array[index] = index >> (2 * CELL_LAYOUT_BENCH_SIZE_LOG2);
+    }
+
+    u64 checksum = 0;
+
+    f64 start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < CELL_LAYOUT_BENCH_ITERATIONS; ++iteration)
+    {
+        morton_encode_3d_batch(x_array, y_array, z_array, code_array, CELL_LAYOUT_BENCH_VOLUME);
+
+        checksum += code_array[iteration];
+    }
+
+    bench_report("morton_encode_3d_batch", bench_get_time() - start_time, (f64)CELL_LAYOUT_BENCH_VOLUME * CELL_LAYOUT_BENCH_ITERATIONS, "cells");
+
+    start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < CELL_LAYOUT_BENCH_ITERATIONS; ++iteration)
+    {
+        morton_decode_3d_batch(code_array, x_array, y_array, z_array, CELL_LAYOUT_BENCH_VOLUME);
+
+        checksum += x_array[iteration];
+    }
+
+    bench_report("morton_decode_3d_batch", bench_get_time() - start_time, (f64)CELL_LAYOUT_BENCH_VOLUME * CELL_LAYOUT_BENCH_ITERATIONS, "cells");
+
+    printf("checksum: %llu\n", (unsigned long long)checksum);
+
+    free(code_array);
+    free(z_array);
+    free(y_array);
+    free(x_array);
+}
+
+int main(int argc, char** argv)
+{
+#if defined(__BMI2__)
+    printf("morton backend: bmi2\n");
+#else
+    printf("morton backend: table\n");
+#endif
+
+    cell_layout_run("linear", cell_layout_index_linear);
+    cell_layout_run("morton", cell_layout_index_morton);
+
+    cell_layout_run_encode();
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench/bench.h"
+#include "core/math/math.h"
+#include "render/cull.h"
+
+// Culls a cube of resident sectors, grouped in 2 x 2 x 2 blocks, from the
+// center of the cube in random view directions. Every box is also tested on
+// its own against every plane for comparison.
+
+#define CULL_BENCH_SIZE_IN_SECTORS 32
+#define CULL_BENCH_SECTOR_SIZE 16.0f
+#define CULL_BENCH_FAR_PLANE 256.0f
+
+#define CULL_BENCH_VIEW_COUNT 256
+
+static f32 cull_bench_random(void)
+{
+    return (f32)rand() / (f32)RAND_MAX;
+}
+
+static u32 cull_bench_get_box_index(u32 x, u32 y, u32 z)
+{
+    const u32 group_size = CULL_BENCH_SIZE_IN_SECTORS / 2;
+    const u32 group_index = x / 2 + y / 2 * group_size + z / 2 * group_size * group_size;
+
+    return group_index * CULL_GROUP_SIZE + ((x & 1) | (y & 1) << 1 | (z & 1) << 2);
+}
+
+static bool cull_bench_is_box_visible(const Frustum* frustum, const vec3 min, const vec3 max)
+{
+    for (u32 plane_index = 0; plane_index < CULL_PLANE_COUNT; ++plane_index)
+    {
+        const f32* plane = frustum->plane_array[plane_index];
+
+        f32 distance = plane[3];
+
+        for (u32 axis = 0; axis < 3; ++axis)
+        {
+            distance += plane[axis] * (plane[axis] > 0.0f ? max[axis] : min[axis]);
+        }
+
+        if (distance < 0.0f)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    const u32 box_count = CULL_BENCH_SIZE_IN_SECTORS * CULL_BENCH_SIZE_IN_SECTORS * CULL_BENCH_SIZE_IN_SECTORS;
+
+    Cull* cull = cull_create(box_count);
+
+    vec3* box_min_array = malloc(sizeof(vec3) * box_count);
+    vec3* box_max_array = malloc(sizeof(vec3) * box_count);
+
+    const f32 half_size = 0.5f * CULL_BENCH_SIZE_IN_SECTORS * CULL_BENCH_SECTOR_SIZE;
+
+    for (u32 z = 0; z < CULL_BENCH_SIZE_IN_SECTORS; ++z)
+    {
+        for (u32 y = 0; y < CULL_BENCH_SIZE_IN_SECTORS; ++y)
+        {
+            for (u32 x = 0; x < CULL_BENCH_SIZE_IN_SECTORS; ++x)
+            {
+                const u32 box_index = cull_bench_get_box_index(x, y, z);
+
+                vec3 min = { x * CULL_BENCH_SECTOR_SIZE - half_size, y * CULL_BENCH_SECTOR_SIZE - half_size, z * CULL_BENCH_SECTOR_SIZE - half_size };
+                vec3 max;
+                glm_vec3_adds(min, CULL_BENCH_SECTOR_SIZE, max);
+
+                glm_vec3_copy(min, box_min_array[box_index]);
+                glm_vec3_copy(max, box_max_array[box_index]);
+
+                cull_set_box(cull, box_index, box_index, min, max);
+            }
+        }
+    }
+
+    mat4 projection_matrix;
+    perspective_lh(glm_rad(60.0f), 16.0f / 9.0f, 0.1f, CULL_BENCH_FAR_PLANE, projection_matrix);
+
+    Frustum* frustum_array = malloc(sizeof(Frustum) * CULL_BENCH_VIEW_COUNT);
+
+    srand(1);
+
+    for (u32 view_index = 0; view_index < CULL_BENCH_VIEW_COUNT; ++view_index)
+    {
+        vec3 eye = { 0.0f, 0.0f, 0.0f };
+        vec3 center = { cull_bench_random() - 0.5f, cull_bench_random() - 0.5f, cull_bench_random() - 0.5f };
+
+        mat4 view_matrix;
+        look_at_lh(eye, center, GLM_ZUP, view_matrix);
+
+        mat4 projection_view_matrix;
+        glm_mat4_mul(projection_matrix, view_matrix, projection_view_matrix);
+
+        frustum_from_projection_view_matrix(projection_view_matrix, &frustum_array[view_index]);
+    }
+
+    u64 visible_count = 0;
+    u64 tested_box_count = 0;
+
+    f64 start_time = bench_get_time();
+
+    for (u32 view_index = 0; view_index < CULL_BENCH_VIEW_COUNT; ++view_index)
+    {
+        visible_count += cull_frustum(cull, &frustum_array[view_index]);
+        tested_box_count += cull->tested_box_count;
+    }
+
+    bench_report("grouped", bench_get_time() - start_time, (f64)CULL_BENCH_VIEW_COUNT * box_count, "sectors");
+
+    u64 reference_visible_count = 0;
+
+    start_time = bench_get_time();
+
+    for (u32 view_index = 0; view_index < CULL_BENCH_VIEW_COUNT; ++view_index)
+    {
+        for (u32 box_index = 0; box_index < box_count; ++box_index)
+        {
+            reference_visible_count += cull_bench_is_box_visible(&frustum_array[view_index], box_min_array[box_index], box_max_array[box_index]);
+        }
+    }
+
+    bench_report("per sector", bench_get_time() - start_time, (f64)CULL_BENCH_VIEW_COUNT * box_count, "sectors");
+
+    printf(
+        "%-40s %10.1f%% visible, %.1f%% tested individually, %s reference\n",
+        "",
+        100.0 * visible_count / ((f64)CULL_BENCH_VIEW_COUNT * box_count),
+        100.0 * tested_box_count / ((f64)CULL_BENCH_VIEW_COUNT * box_count),
+        visible_count == reference_visible_count ? "matches" : "differs from"
+    );
+
+    free(frustum_array);
+    free(box_max_array);
+    free(box_min_array);
+
+    cull_destroy(cull);
+
+    return 0;
+}
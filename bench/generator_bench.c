@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench/bench.h"
+#include "app/world/generator.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+#include "core/job/job.h"
+
+// Generates a block of sectors around the surface on 1..N workers and checks
+// that the result does not depend on the worker count
+
+#define GENERATOR_BENCH_SIZE_IN_SECTORS 16
+#define GENERATOR_BENCH_HEIGHT_IN_SECTORS 4
+#define GENERATOR_BENCH_ITERATION_COUNT 4
+
+#define GENERATOR_BENCH_SECTOR_COUNT \
+    (GENERATOR_BENCH_SIZE_IN_SECTORS * GENERATOR_BENCH_SIZE_IN_SECTORS * GENERATOR_BENCH_HEIGHT_IN_SECTORS)
+
+#define GENERATOR_BENCH_ROW_COUNT 4096
+
+static u64 generator_bench_hash_sector_array(GeneratorJob* generator_job_array)
+{
+    u64 hash = 14695981039346656037ull;
+
+    for (u32 sector_index = 0; sector_index < GENERATOR_BENCH_SECTOR_COUNT; ++sector_index)
+    {
+        Sector* sector = generator_job_array[sector_index].sector;
+
+        for (CellIndex cell_index = 0; cell_index < get_sector_volume_in_cells(); ++cell_index)
+        {
+            const CellType cell_type = sector ? sector_get_cell(sector, cell_index) : CELL_TYPE_AIR;
+
+            hash = (hash ^ cell_type) * 1099511628211ull;
+        }
+    }
+
+    return hash;
+}
+
+static void generator_bench_sample_rows(Generator* generator)
+{
+    i32 height_array[GENERATOR_ROW_CAPACITY];
+
+    u32 mismatch_count = 0;
+
+    for (i32 row = 0; row < 256; ++row)
+    {
+        const i32 x = (row - 128) * GENERATOR_ROW_CAPACITY;
+
+        generator_sample_height_row(generator, x, row - 128, height_array);
+
+        for (u32 column = 0; column < GENERATOR_ROW_CAPACITY; ++column)
+        {
+            if (height_array[column] != generator_sample_height(generator, x + (i32)column, row - 128))
+            {
+                mismatch_count++;
+            }
+        }
+    }
+
+    printf("%u lanes, %u mismatches against scalar\n", GENERATOR_LANE_COUNT, mismatch_count);
+
+    i64 height_sum = 0;
+
+    f64 start_time = bench_get_time();
+
+    for (i32 row = 0; row < GENERATOR_BENCH_ROW_COUNT; ++row)
+    {
+        generator_sample_height_row(generator, 0, row, height_array);
+
+        height_sum += height_array[0];
+    }
+
+    bench_report("sample height rows", bench_get_time() - start_time, (f64)GENERATOR_BENCH_ROW_COUNT * GENERATOR_ROW_CAPACITY, "columns");
+
+    start_time = bench_get_time();
+
+    for (i32 row = 0; row < GENERATOR_BENCH_ROW_COUNT; ++row)
+    {
+        for (u32 column = 0; column < GENERATOR_ROW_CAPACITY; ++column)
+        {
+            height_sum += generator_sample_height(generator, (i32)column, row);
+        }
+    }
+
+    bench_report("sample height scalar", bench_get_time() - start_time, (f64)GENERATOR_BENCH_ROW_COUNT * GENERATOR_ROW_CAPACITY, "columns");
+
+    printf("%-40s %lld\n", "height sum", (long long)height_sum);
+}
+
+int main(int argc, char** argv)
+{
+    printf("sector size %u, %u sectors\n", get_sector_size_in_cells(), GENERATOR_BENCH_SECTOR_COUNT);
+
+    Generator generator;
+    generator_init(&generator, 1337);
+
+    generator_bench_sample_rows(&generator);
+
+    GeneratorJob* generator_job_array = malloc(sizeof(GeneratorJob) * GENERATOR_BENCH_SECTOR_COUNT);
+    Job* job_array = malloc(sizeof(Job) * GENERATOR_BENCH_SECTOR_COUNT);
+
+    for (u32 sector_index = 0; sector_index < GENERATOR_BENCH_SECTOR_COUNT; ++sector_index)
+    {
+        GeneratorJob* generator_job = &generator_job_array[sector_index];
+
+        generator_job->generator = &generator;
+        generator_job->sector_coordinate[0] = (i32)(sector_index % GENERATOR_BENCH_SIZE_IN_SECTORS) - GENERATOR_BENCH_SIZE_IN_SECTORS / 2;
+        generator_job->sector_coordinate[1] = (i32)((sector_index / GENERATOR_BENCH_SIZE_IN_SECTORS) % GENERATOR_BENCH_SIZE_IN_SECTORS) - GENERATOR_BENCH_SIZE_IN_SECTORS / 2;
+        generator_job->sector_coordinate[2] = (i32)(sector_index / (GENERATOR_BENCH_SIZE_IN_SECTORS * GENERATOR_BENCH_SIZE_IN_SECTORS)) - GENERATOR_BENCH_HEIGHT_IN_SECTORS / 2;
+        generator_job->sector = NULL;
+
+        job_array[sector_index].function = generator_run_job;
+        job_array[sector_index].data = generator_job;
+    }
+
+    const u32 max_worker_count = argc > 1 ? (u32)atoi(argv[1]) : job_get_core_count();
+
+    u64 single_worker_hash = 0;
+    f64 single_worker_seconds = 0.0;
+
+    for (u32 worker_count = 1; worker_count <= max_worker_count; ++worker_count)
+    {
+        JobSystem* job_system = job_system_create(worker_count);
+
+        JobCounter job_counter;
+        atomic_init(&job_counter.value, 0);
+
+        f64 elapsed_seconds = 0.0;
+
+        for (u32 iteration = 0; iteration < GENERATOR_BENCH_ITERATION_COUNT; ++iteration)
+        {
+            for (u32 sector_index = 0; sector_index < GENERATOR_BENCH_SECTOR_COUNT; ++sector_index)
+            {
+                if (generator_job_array[sector_index].sector)
+                {
+                    sector_destroy(generator_job_array[sector_index].sector);
+
+                    generator_job_array[sector_index].sector = NULL;
+                }
+            }
+
+            const f64 start_time = bench_get_time();
+
+            job_system_submit(job_system, job_array, GENERATOR_BENCH_SECTOR_COUNT, &job_counter);
+            job_system_wait(job_system, &job_counter);
+
+            elapsed_seconds += bench_get_time() - start_time;
+        }
+
+        const u64 hash = generator_bench_hash_sector_array(generator_job_array);
+
+        if (worker_count == 1)
+        {
+            single_worker_hash = hash;
+            single_worker_seconds = elapsed_seconds;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "generate on %u workers", worker_count);
+
+        bench_report(name, elapsed_seconds, (f64)GENERATOR_BENCH_ITERATION_COUNT * GENERATOR_BENCH_SECTOR_COUNT, "sectors");
+
+        printf(
+            "%-40s %10.2fx speedup, %s\n",
+            "",
+            single_worker_seconds / elapsed_seconds,
+            hash == single_worker_hash ? "identical" : "DIFFERENT"
+        );
+
+        job_system_destroy(job_system);
+    }
+
+    for (u32 sector_index = 0; sector_index < GENERATOR_BENCH_SECTOR_COUNT; ++sector_index)
+    {
+        if (generator_job_array[sector_index].sector)
+        {
+            sector_destroy(generator_job_array[sector_index].sector);
+        }
+    }
+
+    free(job_array);
+    free(generator_job_array);
+
+    return 0;
+}
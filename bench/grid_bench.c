@@ -0,0 +1,101 @@
+#include <stdio.h>
+
+#include "bench/bench.h"
+#include "app/world/grid.h"
+
+#define GRID_BENCH_ITERATION_COUNT 64
+
+static u64 grid_bench_grid_to_indices(void)
+{
+    const i32 world_min_in_cells = get_world_min_in_cells();
+    const i32 world_max_in_cells = get_world_max_in_cells();
+
+    u64 checksum = 0;
+
+    for (i32 z = world_min_in_cells; z <= world_max_in_cells; ++z)
+    {
+        for (i32 y = world_min_in_cells; y <= world_max_in_cells; ++y)
+        {
+            for (i32 x = world_min_in_cells; x <= world_max_in_cells; ++x)
+            {
+                GridCoordinate grid_coordinate = { x, y, z };
+
+                checksum += grid_coordinate_to_sector_index(grid_coordinate);
+                checksum += grid_coordinate_to_cell_index(grid_coordinate);
+            }
+        }
+    }
+
+    return checksum;
+}
+
+static u64 grid_bench_indices_to_grid(void)
+{
+    const u32 world_volume_in_sectors = get_world_volume_in_sectors();
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+
+    SectorCoordinate window_sector_coordinate = { 0, 0, 0 };
+
+    u64 checksum = 0;
+
+    for (SectorIndex sector_index = 0; sector_index < world_volume_in_sectors; ++sector_index)
+    {
+        for (CellIndex cell_index = 0; cell_index < sector_volume_in_cells; ++cell_index)
+        {
+            GridCoordinate grid_coordinate;
+            indices_to_grid_coordinate(sector_index, cell_index, window_sector_coordinate, grid_coordinate);
+
+            checksum += (u32)(grid_coordinate[0] ^ grid_coordinate[1] ^ grid_coordinate[2]);
+        }
+    }
+
+    return checksum;
+}
+
+int main(int argc, char** argv)
+{
+    const f64 world_volume_in_cells = 
+        (f64)get_world_volume_in_sectors() * (f64)get_sector_volume_in_cells();
+
+#if defined(GRID_POWER_OF_TWO)
+    printf("grid mode: power of two, sector size %u\n", get_sector_size_in_cells());
+#else
+    printf("grid mode: odd centered, sector size %u\n", get_sector_size_in_cells());
+#endif
+
+    printf("world volume: %.0f cells\n", world_volume_in_cells);
+
+    u64 checksum = 0;
+
+    f64 start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < GRID_BENCH_ITERATION_COUNT; ++iteration)
+    {
+        checksum += grid_bench_grid_to_indices();
+    }
+
+    bench_report(
+        "grid_coordinate_to_indices",
+        bench_get_time() - start_time,
+        world_volume_in_cells * GRID_BENCH_ITERATION_COUNT,
+        "cells"
+    );
+
+    start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < GRID_BENCH_ITERATION_COUNT; ++iteration)
+    {
+        checksum += grid_bench_indices_to_grid();
+    }
+
+    bench_report(
+        "indices_to_grid_coordinate",
+        bench_get_time() - start_time,
+        world_volume_in_cells * GRID_BENCH_ITERATION_COUNT,
+        "cells"
+    );
+
+    printf("checksum: %llu\n", (unsigned long long)checksum);
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench/bench.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+#include "core/job/job.h"
+#include "render/mesh.h"
+
+// Meshes a fixed synthetic world of sectors on 1..N workers
+
+#define JOB_BENCH_WORLD_SIZE_IN_SECTORS 8
+#define JOB_BENCH_ITERATION_COUNT 20
+
+#define JOB_BENCH_SECTOR_COUNT \
+    (JOB_BENCH_WORLD_SIZE_IN_SECTORS * JOB_BENCH_WORLD_SIZE_IN_SECTORS * JOB_BENCH_WORLD_SIZE_IN_SECTORS)
+
+typedef struct JobBenchMeshJob
+{
+    Sector* sector;
+    Sector* neighbor_sector_array[GRID_NEIGHBORHOOD_COUNT];
+    const u8* neighbor_light_array[GRID_NEIGHBORHOOD_COUNT];
+
+    Mesh* mesh;
+}
+JobBenchMeshJob;
+
+static u32 job_bench_get_sector_index(i32 x, i32 y, i32 z)
+{
+    return (u32)(x + (y + z * JOB_BENCH_WORLD_SIZE_IN_SECTORS) * JOB_BENCH_WORLD_SIZE_IN_SECTORS);
+}
+
+static bool job_bench_is_sector_valid(i32 x, i32 y, i32 z)
+{
+    return
+        x >= 0 && x < JOB_BENCH_WORLD_SIZE_IN_SECTORS &&
+        y >= 0 && y < JOB_BENCH_WORLD_SIZE_IN_SECTORS &&
+        z >= 0 && z < JOB_BENCH_WORLD_SIZE_IN_SECTORS;
+}
+
+static Sector* job_bench_create_sector(SectorCoordinate sector_coordinate)
+{
+    Sector* sector = sector_create(sector_coordinate);
+
+    GridCoordinate sector_grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector_coordinate, sector_grid_coordinate);
+
+    const i32 world_size_in_cells = JOB_BENCH_WORLD_SIZE_IN_SECTORS * (i32)get_sector_size_in_cells();
+
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+
+    for (CellIndex cell_index = 0; cell_index < sector_volume_in_cells; ++cell_index)
+    {
+        CellCoordinate cell_coordinate;
+        cell_index_to_cell_coordinate(cell_index, cell_coordinate);
+
+        GridCoordinate grid_coordinate;
+        glm_ivec3_add(sector_grid_coordinate, cell_coordinate, grid_coordinate);
+
+        const i32 height =
+            world_size_in_cells / 2 +
+            (grid_coordinate[0] * 7 + grid_coordinate[1] * 13) % 11 - 5;
+
+        CellType cell_type = CELL_TYPE_AIR;
+
+        if (grid_coordinate[2] < height)
+        {
+            cell_type = CELL_TYPE_STONE;
+        }
+        else if (grid_coordinate[2] == height)
+        {
+            cell_type = CELL_TYPE_GRASS;
+        }
+
+        sector_set_cell(sector, cell_index, cell_type);
+    }
+
+    return sector;
+}
+
+static void job_bench_mesh_sector(void* data)
+{
+    JobBenchMeshJob* mesh_job = data;
+
+    mesh_clear(mesh_job->mesh);
+    mesh_build_sector(
+        mesh_job->mesh,
+        MESH_MODE_GREEDY,
+        0,
+        0,
+        mesh_job->sector,
+        mesh_job->neighbor_sector_array,
+        mesh_job->neighbor_light_array
+    );
+}
+
+int main(int argc, char** argv)
+{
+    printf("sector size %u, %u sectors\n", get_sector_size_in_cells(), JOB_BENCH_SECTOR_COUNT);
+
+    Sector** sector_array = malloc(sizeof(Sector*) * JOB_BENCH_SECTOR_COUNT);
+
+    JobBenchMeshJob* mesh_job_array = malloc(sizeof(JobBenchMeshJob) * JOB_BENCH_SECTOR_COUNT);
+    Job* job_array = malloc(sizeof(Job) * JOB_BENCH_SECTOR_COUNT);
+
+    for (i32 z = 0; z < JOB_BENCH_WORLD_SIZE_IN_SECTORS; ++z)
+    {
+        for (i32 y = 0; y < JOB_BENCH_WORLD_SIZE_IN_SECTORS; ++y)
+        {
+            for (i32 x = 0; x < JOB_BENCH_WORLD_SIZE_IN_SECTORS; ++x)
+            {
+                SectorCoordinate sector_coordinate = { x, y, z };
+
+                sector_array[job_bench_get_sector_index(x, y, z)] = job_bench_create_sector(sector_coordinate);
+            }
+        }
+    }
+
+    for (i32 z = 0; z < JOB_BENCH_WORLD_SIZE_IN_SECTORS; ++z)
+    {
+        for (i32 y = 0; y < JOB_BENCH_WORLD_SIZE_IN_SECTORS; ++y)
+        {
+            for (i32 x = 0; x < JOB_BENCH_WORLD_SIZE_IN_SECTORS; ++x)
+            {
+                const u32 sector_index = job_bench_get_sector_index(x, y, z);
+
+                JobBenchMeshJob* mesh_job = &mesh_job_array[sector_index];
+
+                mesh_job->sector = sector_array[sector_index];
+                mesh_job->mesh = mesh_create();
+
+                for (u32 neighborhood_index = 0; neighborhood_index < GRID_NEIGHBORHOOD_COUNT; ++neighborhood_index)
+                {
+                    i32 offset[3];
+                    grid_neighborhood_index_to_offset(neighborhood_index, offset);
+
+                    const i32 neighbor_x = x + offset[0];
+                    const i32 neighbor_y = y + offset[1];
+                    const i32 neighbor_z = z + offset[2];
+
+                    mesh_job->neighbor_sector_array[neighborhood_index] =
+                        job_bench_is_sector_valid(neighbor_x, neighbor_y, neighbor_z)
+                            ? sector_array[job_bench_get_sector_index(neighbor_x, neighbor_y, neighbor_z)]
+                            : NULL;
+
+                    mesh_job->neighbor_light_array[neighborhood_index] = NULL;
+                }
+
+                job_array[sector_index].function = job_bench_mesh_sector;
+                job_array[sector_index].data = mesh_job;
+            }
+        }
+    }
+
+    // The worker range defaults to the core count and can be overridden
+    // from the command line
+
+    const u32 max_worker_count = argc > 1 ? (u32)atoi(argv[1]) : job_get_core_count();
+
+    f64 single_worker_seconds = 0.0;
+
+    for (u32 worker_count = 1; worker_count <= max_worker_count; ++worker_count)
+    {
+        JobSystem* job_system = job_system_create(worker_count);
+
+        JobCounter job_counter;
+        atomic_init(&job_counter.value, 0);
+
+        const f64 start_time = bench_get_time();
+
+        for (u32 iteration = 0; iteration < JOB_BENCH_ITERATION_COUNT; ++iteration)
+        {
+            job_system_submit(job_system, job_array, JOB_BENCH_SECTOR_COUNT, &job_counter);
+            job_system_wait(job_system, &job_counter);
+        }
+
+        const f64 elapsed_seconds = bench_get_time() - start_time;
+
+        if (worker_count == 1)
+        {
+            single_worker_seconds = elapsed_seconds;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "mesh world on %u workers", worker_count);
+
+        bench_report(
+            name,
+            elapsed_seconds,
+            (f64)JOB_BENCH_ITERATION_COUNT * JOB_BENCH_SECTOR_COUNT * get_sector_volume_in_cells(),
+            "cells"
+        );
+
+        printf("%-40s %10.2fx speedup\n", "", single_worker_seconds / elapsed_seconds);
+
+        job_system_destroy(job_system);
+    }
+
+    u64 vertex_count = 0;
+
+    for (u32 sector_index = 0; sector_index < JOB_BENCH_SECTOR_COUNT; ++sector_index)
+    {
+        vertex_count += mesh_job_array[sector_index].mesh->vertex_count;
+
+        mesh_destroy(mesh_job_array[sector_index].mesh);
+        sector_destroy(sector_array[sector_index]);
+    }
+
+    printf("%llu triangles per pass\n", (unsigned long long)(vertex_count / 3));
+
+    free(job_array);
+    free(mesh_job_array);
+    free(sector_array);
+
+    return 0;
+}
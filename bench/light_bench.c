@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench/bench.h"
+#include "app/world/grid.h"
+#include "app/world/light.h"
+#include "app/world/world.h"
+#include "core/job/job.h"
+
+// Times the incremental relighting of single edits in their worst cases: a
+// torch placed and removed in an open cave, and a roof cell placed and
+// removed over a column of full sky light. The full relight of the window
+// is timed for comparison.
+
+#define LIGHT_BENCH_EDIT_COUNT 256
+
+typedef enum LightBenchScene
+{
+    LIGHT_BENCH_SCENE_TORCH,
+    LIGHT_BENCH_SCENE_ROOF,
+    LIGHT_BENCH_SCENE_COUNT
+}
+LightBenchScene;
+
+static const char* light_bench_scene_name_array[LIGHT_BENCH_SCENE_COUNT] =
+{
+    "torch",
+    "roof",
+};
+
+static const CellType light_bench_scene_cell_type_array[LIGHT_BENCH_SCENE_COUNT] =
+{
+    CELL_TYPE_TORCH,
+    CELL_TYPE_STONE,
+};
+
+// Clears a box around the center of the window so light spreads as far as
+// it can
+
+static void light_bench_carve_cave(World* world, GridCoordinate center_grid_coordinate, i32 radius)
+{
+    for (i32 z = -radius; z <= radius; ++z)
+    {
+        for (i32 y = -radius; y <= radius; ++y)
+        {
+            for (i32 x = -radius; x <= radius; ++x)
+            {
+                GridCoordinate grid_coordinate =
+                {
+                    center_grid_coordinate[0] + x,
+                    center_grid_coordinate[1] + y,
+                    center_grid_coordinate[2] + z,
+                };
+
+                world_set_cell(world, grid_coordinate, CELL_TYPE_AIR);
+            }
+        }
+    }
+}
+
+static void light_bench_get_edit_grid_coordinate(World* world, LightBenchScene scene, GridCoordinate out_grid_coordinate)
+{
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        out_grid_coordinate[axis] = world->window_sector_coordinate[axis] * SECTOR_SIZE_IN_CELLS;
+    }
+
+    // The roof sits in the top layer of the window, where the sky enters
+
+    if (scene == LIGHT_BENCH_SCENE_ROOF)
+    {
+        out_grid_coordinate[2] += get_world_max_in_cells();
+    }
+}
+
+int main(void)
+{
+    JobSystem* job_system = job_system_create(0);
+
+    // Bench worlds are generated fresh and never saved
+
+    World* world = world_create(NULL);
+    world_init(world, job_system);
+
+    printf("sector size %u, %u sectors loaded\n", get_sector_size_in_cells(), world->sector_count);
+
+    GridCoordinate center_grid_coordinate;
+    light_bench_get_edit_grid_coordinate(world, LIGHT_BENCH_SCENE_TORCH, center_grid_coordinate);
+
+    light_bench_carve_cave(world, center_grid_coordinate, LIGHT_LEVEL_MAX);
+
+    for (u32 scene = 0; scene < LIGHT_BENCH_SCENE_COUNT; ++scene)
+    {
+        GridCoordinate grid_coordinate;
+        light_bench_get_edit_grid_coordinate(world, scene, grid_coordinate);
+
+        // A shaft from the roof into the cave carries full sky light down
+
+        if (scene == LIGHT_BENCH_SCENE_ROOF)
+        {
+            for (i32 z = center_grid_coordinate[2]; z <= grid_coordinate[2]; ++z)
+            {
+                GridCoordinate shaft_grid_coordinate = { grid_coordinate[0], grid_coordinate[1], z };
+
+                world_set_cell(world, shaft_grid_coordinate, CELL_TYPE_AIR);
+            }
+        }
+
+        const CellType cell_type = light_bench_scene_cell_type_array[scene];
+
+        f64 place_seconds = 0.0;
+        f64 remove_seconds = 0.0;
+
+        for (u32 edit_index = 0; edit_index < LIGHT_BENCH_EDIT_COUNT; ++edit_index)
+        {
+            f64 start_time = bench_get_time();
+            world_set_cell(world, grid_coordinate, cell_type);
+            place_seconds += bench_get_time() - start_time;
+
+            start_time = bench_get_time();
+            world_set_cell(world, grid_coordinate, CELL_TYPE_AIR);
+            remove_seconds += bench_get_time() - start_time;
+
+            world_clear_dirty_sectors(world);
+        }
+
+        printf(
+            "%-40s %10.3f us per place %10.3f us per remove\n",
+            light_bench_scene_name_array[scene],
+            place_seconds / LIGHT_BENCH_EDIT_COUNT * 1e6,
+            remove_seconds / LIGHT_BENCH_EDIT_COUNT * 1e6
+        );
+    }
+
+    const f64 start_time = bench_get_time();
+
+    for (SectorIndex sector_index = 0; sector_index < get_world_volume_in_sectors(); ++sector_index)
+    {
+        light_clear_sector(world->light, sector_index);
+    }
+
+    for (SectorIndex sector_index = 0; sector_index < get_world_volume_in_sectors(); ++sector_index)
+    {
+        light_install_sector(world, sector_index);
+    }
+
+    bench_report(
+        "window relight",
+        bench_get_time() - start_time,
+        (f64)get_world_volume_in_sectors() * get_sector_volume_in_cells(),
+        "cells"
+    );
+
+    world_destroy(world);
+    job_system_destroy(job_system);
+
+    return 0;
+}
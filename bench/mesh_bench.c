@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench/bench.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+#include "render/mesh.h"
+
+#define MESH_BENCH_ITERATION_COUNT 2000
+
+typedef enum MeshBenchScene
+{
+    MESH_BENCH_SCENE_TERRAIN,
+    MESH_BENCH_SCENE_NOISE,
+    MESH_BENCH_SCENE_SOLID,
+    MESH_BENCH_SCENE_COUNT
+}
+MeshBenchScene;
+
+static const char* mesh_bench_scene_name_array[MESH_BENCH_SCENE_COUNT] =
+{
+    "terrain",
+    "noise",
+    "solid",
+};
+
+static const char* mesh_bench_mode_name_array[MESH_MODE_COUNT] =
+{
+    "culled",
+    "greedy",
+    "instanced",
+};
+
+static CellType mesh_bench_get_cell_type(MeshBenchScene scene, GridCoordinate grid_coordinate)
+{
+    switch (scene)
+    {
+        case MESH_BENCH_SCENE_TERRAIN:
+        {
+            const i32 height = (grid_coordinate[0] * 3 + grid_coordinate[1] * 5) % 7 - 3;
+
+            return grid_coordinate[2] <= height ? CELL_TYPE_STONE : CELL_TYPE_AIR;
+        }
+
+        case MESH_BENCH_SCENE_NOISE:
+        {
+            return rand() % 2 ? CELL_TYPE_STONE : CELL_TYPE_AIR;
+        }
+
+        default:
+        {
+            return CELL_TYPE_STONE;
+        }
+    }
+}
+
+static Sector* mesh_bench_create_sector(MeshBenchScene scene, SectorCoordinate sector_coordinate)
+{
+    Sector* sector = sector_create(sector_coordinate);
+
+    GridCoordinate sector_grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector_coordinate, sector_grid_coordinate);
+
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+
+    for (CellIndex cell_index = 0; cell_index < sector_volume_in_cells; ++cell_index)
+    {
+        CellCoordinate cell_coordinate;
+        cell_index_to_cell_coordinate(cell_index, cell_coordinate);
+
+        GridCoordinate grid_coordinate;
+        glm_ivec3_add(sector_grid_coordinate, cell_coordinate, grid_coordinate);
+
+        sector_set_cell(sector, cell_index, mesh_bench_get_cell_type(scene, grid_coordinate));
+    }
+
+    return sector;
+}
+
+static void mesh_bench_run(MeshBenchScene scene, MeshMode mesh_mode, u32 lod, Mesh* mesh)
+{
+    srand(1);
+
+    SectorCoordinate sector_coordinate = { 0, 0, 0 };
+
+    Sector* sector = mesh_bench_create_sector(scene, sector_coordinate);
+    Sector* neighbor_sector_array[GRID_NEIGHBORHOOD_COUNT];
+
+    for (u32 neighborhood_index = 0; neighborhood_index < GRID_NEIGHBORHOOD_COUNT; ++neighborhood_index)
+    {
+        SectorCoordinate neighbor_sector_coordinate;
+        grid_neighborhood_index_to_offset(neighborhood_index, neighbor_sector_coordinate);
+
+        neighbor_sector_array[neighborhood_index] =
+            neighborhood_index == GRID_NEIGHBORHOOD_CENTER ? sector : mesh_bench_create_sector(scene, neighbor_sector_coordinate);
+    }
+
+    // Unlit, light only changes the shading and not the work per face
+
+    const u8* neighbor_light_array[GRID_NEIGHBORHOOD_COUNT] = { NULL };
+
+    u64 triangle_count = 0;
+    u64 byte_count = 0;
+
+    const f64 start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < MESH_BENCH_ITERATION_COUNT; ++iteration)
+    {
+        mesh_clear(mesh);
+        mesh_build_sector(mesh, mesh_mode, lod, 0, sector, neighbor_sector_array, neighbor_light_array);
+
+        triangle_count += mesh->vertex_count / 3 + 2 * mesh->face_count;
+        byte_count += sizeof(VoxelVertex) * mesh->vertex_count + sizeof(VoxelFace) * mesh->face_count;
+    }
+
+    const f64 elapsed_seconds = bench_get_time() - start_time;
+
+    char name[64];
+    snprintf(
+        name,
+        sizeof(name),
+        "mesh_build_sector %s %s lod %u",
+        mesh_bench_mode_name_array[mesh_mode],
+        mesh_bench_scene_name_array[scene],
+        lod
+    );
+
+    bench_report(
+        name,
+        elapsed_seconds,
+        (f64)MESH_BENCH_ITERATION_COUNT * get_sector_volume_in_cells(),
+        "cells"
+    );
+
+    printf("%-40s %10llu triangles per sector\n", "", (unsigned long long)(triangle_count / MESH_BENCH_ITERATION_COUNT));
+    printf("%-40s %10llu bytes per sector\n", "", (unsigned long long)(byte_count / MESH_BENCH_ITERATION_COUNT));
+
+    for (u32 neighborhood_index = 0; neighborhood_index < GRID_NEIGHBORHOOD_COUNT; ++neighborhood_index)
+    {
+        sector_destroy(neighbor_sector_array[neighborhood_index]);
+    }
+}
+
+int main(void)
+{
+    printf("sector size %u\n", get_sector_size_in_cells());
+
+    Mesh* mesh = mesh_create();
+
+    for (u32 scene = 0; scene < MESH_BENCH_SCENE_COUNT; ++scene)
+    {
+        for (u32 mesh_mode = 0; mesh_mode < MESH_MODE_COUNT; ++mesh_mode)
+        {
+            for (u32 lod = 0; lod < MESH_LOD_COUNT; ++lod)
+            {
+                mesh_bench_run(scene, mesh_mode, lod, mesh);
+            }
+        }
+    }
+
+    mesh_destroy(mesh);
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench/bench.h"
+#include "app/world/grid.h"
+#include "app/world/world.h"
+#include "core/job/job.h"
+#include "core/math/math.h"
+#include "render/cull.h"
+#include "render/occlusion.h"
+
+// Culls the sectors of the window from a camera above the terrain and from
+// a small cave underground, looking around in several directions. Counts
+// the sectors left after the frustum and after occlusion, and times the
+// occluder drawing, the depth pyramid and the box tests per frame.
+
+#define OCCLUSION_BENCH_VIEW_COUNT 8
+#define OCCLUSION_BENCH_ITERATION_COUNT 256
+
+#define OCCLUSION_BENCH_CAVE_RADIUS 2
+
+typedef enum OcclusionBenchScene
+{
+    OCCLUSION_BENCH_SCENE_SURFACE,
+    OCCLUSION_BENCH_SCENE_CAVE,
+    OCCLUSION_BENCH_SCENE_COUNT
+}
+OcclusionBenchScene;
+
+static const char* occlusion_bench_scene_name_array[OCCLUSION_BENCH_SCENE_COUNT] =
+{
+    "surface",
+    "cave",
+};
+
+static const f32 occlusion_bench_scene_pitch_array[OCCLUSION_BENCH_SCENE_COUNT] =
+{
+    -20.0f,
+    0.0f,
+};
+
+static void occlusion_bench_get_sector_bounds(World* world, SectorIndex sector_index, vec3 out_min, vec3 out_max)
+{
+    SectorCoordinate sector_coordinate;
+    sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+    GridCoordinate grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector_coordinate, grid_coordinate);
+    glm_ivec3_adds(grid_coordinate, SECTOR_MIN_CELL, grid_coordinate);
+
+    grid_coordinate_to_world_position(grid_coordinate, out_min);
+    glm_vec3_subs(out_min, CELL_RADIUS, out_min);
+
+    glm_vec3_adds(out_min, get_sector_size_in_cells() * get_cell_size(), out_max);
+}
+
+// Places the camera in the middle of the window, either at its top or in a
+// cave carved one sector above its bottom
+
+static void occlusion_bench_get_camera_grid_coordinate(World* world, OcclusionBenchScene scene, GridCoordinate out_grid_coordinate)
+{
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        out_grid_coordinate[axis] = world->window_sector_coordinate[axis] * SECTOR_SIZE_IN_CELLS;
+    }
+
+    if (scene == OCCLUSION_BENCH_SCENE_SURFACE)
+    {
+        out_grid_coordinate[2] += get_world_max_in_cells() - 1;
+    }
+    else
+    {
+        out_grid_coordinate[2] += get_world_min_in_cells() + (i32)SECTOR_SIZE_IN_CELLS * 3 / 2;
+    }
+}
+
+static void occlusion_bench_carve_cave(World* world, GridCoordinate center_grid_coordinate)
+{
+    for (i32 z = -OCCLUSION_BENCH_CAVE_RADIUS; z <= OCCLUSION_BENCH_CAVE_RADIUS; ++z)
+    {
+        for (i32 y = -OCCLUSION_BENCH_CAVE_RADIUS; y <= OCCLUSION_BENCH_CAVE_RADIUS; ++y)
+        {
+            for (i32 x = -OCCLUSION_BENCH_CAVE_RADIUS; x <= OCCLUSION_BENCH_CAVE_RADIUS; ++x)
+            {
+                GridCoordinate grid_coordinate =
+                {
+                    center_grid_coordinate[0] + x,
+                    center_grid_coordinate[1] + y,
+                    center_grid_coordinate[2] + z,
+                };
+
+                world_set_cell(world, grid_coordinate, CELL_TYPE_AIR);
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    JobSystem* job_system = job_system_create(0);
+
+    // Bench worlds are generated fresh and never saved
+
+    World* world = world_create(NULL);
+    world_init(world, job_system);
+
+    printf("sector size %u, %u sectors loaded\n", get_sector_size_in_cells(), world->sector_count);
+
+    const u32 sector_volume = get_world_volume_in_sectors();
+
+    Cull* cull = cull_create(sector_volume);
+    Occlusion* occlusion = occlusion_create();
+
+    u32* solid_face_mask_array = malloc(sizeof(u32) * sector_volume);
+
+    mat4 projection_matrix;
+    perspective_lh(glm_rad(60.0f), 16.0f / 9.0f, 0.1f, 2.0f * get_world_max_in_cells() * get_cell_size(), projection_matrix);
+
+    for (u32 scene = 0; scene < OCCLUSION_BENCH_SCENE_COUNT; ++scene)
+    {
+        GridCoordinate camera_grid_coordinate;
+        occlusion_bench_get_camera_grid_coordinate(world, scene, camera_grid_coordinate);
+
+        if (scene == OCCLUSION_BENCH_SCENE_CAVE)
+        {
+            occlusion_bench_carve_cave(world, camera_grid_coordinate);
+        }
+
+        vec3 camera_position;
+        grid_coordinate_to_world_position(camera_grid_coordinate, camera_position);
+
+        // Sectors holding solid cells may have a mesh, and their solid faces
+        // occlude
+
+        for (SectorIndex sector_index = 0; sector_index < sector_volume; ++sector_index)
+        {
+            Sector* sector = world_get_sector(world, sector_index);
+
+            solid_face_mask_array[sector_index] = sector ? sector_get_solid_face_mask(sector) : 0;
+
+            if (!sector || sector_is_empty(sector))
+            {
+                cull_clear_box(cull, sector_index);
+
+                continue;
+            }
+
+            vec3 sector_min;
+            vec3 sector_max;
+            occlusion_bench_get_sector_bounds(world, sector_index, sector_min, sector_max);
+
+            cull_set_box(cull, sector_index, sector_index, sector_min, sector_max);
+        }
+
+        u32 frustum_visible_count = 0;
+        u32 visible_count = 0;
+        u32 occluder_face_count = 0;
+
+        f64 elapsed_seconds = 0.0;
+
+        for (u32 view_index = 0; view_index < OCCLUSION_BENCH_VIEW_COUNT; ++view_index)
+        {
+            const f32 yaw = glm_rad(360.0f * view_index / OCCLUSION_BENCH_VIEW_COUNT);
+            const f32 pitch = glm_rad(occlusion_bench_scene_pitch_array[scene]);
+
+            vec3 center =
+            {
+                camera_position[0] + cosf(pitch) * cosf(yaw),
+                camera_position[1] + cosf(pitch) * sinf(yaw),
+                camera_position[2] + sinf(pitch),
+            };
+
+            mat4 view_matrix;
+            look_at_lh(camera_position, center, GLM_ZUP, view_matrix);
+
+            mat4 projection_view_matrix;
+            glm_mat4_mul(projection_matrix, view_matrix, projection_view_matrix);
+
+            Frustum frustum;
+            frustum_from_projection_view_matrix(projection_view_matrix, &frustum);
+
+            frustum_visible_count += cull_frustum(cull, &frustum);
+
+            const f64 start_time = bench_get_time();
+
+            for (u32 iteration = 0; iteration < OCCLUSION_BENCH_ITERATION_COUNT; ++iteration)
+            {
+                occlusion_begin(occlusion, projection_view_matrix, camera_position);
+
+                for (SectorIndex sector_index = 0; sector_index < sector_volume; ++sector_index)
+                {
+                    if (solid_face_mask_array[sector_index] == 0)
+                    {
+                        continue;
+                    }
+
+                    vec3 sector_min;
+                    vec3 sector_max;
+                    occlusion_bench_get_sector_bounds(world, sector_index, sector_min, sector_max);
+
+                    occlusion_draw_box_faces(occlusion, sector_min, sector_max, get_cell_size(), solid_face_mask_array[sector_index]);
+                }
+
+                occlusion_build_pyramid(occlusion);
+
+                for (u32 visible_index = 0; visible_index < cull->visible_count; ++visible_index)
+                {
+                    vec3 sector_min;
+                    vec3 sector_max;
+                    occlusion_bench_get_sector_bounds(world, cull->visible_id_array[visible_index], sector_min, sector_max);
+
+                    occlusion_is_box_visible(occlusion, sector_min, sector_max);
+                }
+            }
+
+            elapsed_seconds += bench_get_time() - start_time;
+
+            visible_count += cull->visible_count - occlusion->hidden_box_count;
+            occluder_face_count += occlusion->occluder_face_count;
+        }
+
+        printf(
+            "%-40s %10.3f us per frame, %.1f sectors in frustum, %.1f visible, %.1f occluder faces\n",
+            occlusion_bench_scene_name_array[scene],
+            elapsed_seconds / (OCCLUSION_BENCH_VIEW_COUNT * OCCLUSION_BENCH_ITERATION_COUNT) * 1e6,
+            (f64)frustum_visible_count / OCCLUSION_BENCH_VIEW_COUNT,
+            (f64)visible_count / OCCLUSION_BENCH_VIEW_COUNT,
+            (f64)occluder_face_count / OCCLUSION_BENCH_VIEW_COUNT
+        );
+    }
+
+    free(solid_face_mask_array);
+
+    occlusion_destroy(occlusion);
+    cull_destroy(cull);
+
+    world_destroy(world);
+    job_system_destroy(job_system);
+
+    return 0;
+}
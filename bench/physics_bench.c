@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "app/world/grid.h"
+#include "app/world/physics.h"
+#include "app/world/world.h"
+#include "core/job/job.h"
+
+// Moves entity sized boxes through the window by the small displacement of
+// a walking frame and by displacements of several cells, as many boxes would
+// be moved in one tick
+
+#define PHYSICS_BENCH_BOX_COUNT 65536
+#define PHYSICS_BENCH_ITERATION_COUNT 8
+
+#define PHYSICS_BENCH_HALF_EXTENT 0.3f
+
+typedef enum PhysicsBenchScene
+{
+    PHYSICS_BENCH_SCENE_WALK,
+    PHYSICS_BENCH_SCENE_FALL,
+    PHYSICS_BENCH_SCENE_COUNT
+}
+PhysicsBenchScene;
+
+static const char* physics_bench_scene_name_array[PHYSICS_BENCH_SCENE_COUNT] =
+{
+    "walk",
+    "fall",
+};
+
+static const f32 physics_bench_scene_distance_array[PHYSICS_BENCH_SCENE_COUNT] =
+{
+    0.1f,
+    8.0f,
+};
+
+static f32 physics_bench_random(void)
+{
+    return (f32)rand() / (f32)RAND_MAX;
+}
+
+static void physics_bench_get_random_position(World* world, vec3 out_position)
+{
+    const f32 window_min = (f32)get_world_min_in_cells();
+    const f32 window_max = (f32)get_world_max_in_cells();
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        const f32 window_offset = (f32)(world->window_sector_coordinate[axis] * SECTOR_SIZE_IN_CELLS);
+
+        out_position[axis] = (window_offset + window_min + physics_bench_random() * (window_max - window_min)) * get_cell_size();
+    }
+}
+
+// Places every box where it overlaps no solid cell
+
+static void physics_bench_create_aabb_array(World* world, Aabb* aabb_array)
+{
+    const vec3 half_extent = {PHYSICS_BENCH_HALF_EXTENT, PHYSICS_BENCH_HALF_EXTENT, PHYSICS_BENCH_HALF_EXTENT};
+
+    for (u32 box_index = 0; box_index < PHYSICS_BENCH_BOX_COUNT; ++box_index)
+    {
+        do
+        {
+            vec3 center;
+            physics_bench_get_random_position(world, center);
+
+            aabb_from_center(center, half_extent, &aabb_array[box_index]);
+        }
+        while (physics_aabb_overlaps_solid(world, &aabb_array[box_index]));
+    }
+}
+
+static void physics_bench_create_displacement_array(PhysicsBenchScene scene, vec3* displacement_array)
+{
+    const f32 distance = physics_bench_scene_distance_array[scene];
+
+    for (u32 box_index = 0; box_index < PHYSICS_BENCH_BOX_COUNT; ++box_index)
+    {
+        vec3 direction =
+        {
+            physics_bench_random() - 0.5f,
+            physics_bench_random() - 0.5f,
+            scene == PHYSICS_BENCH_SCENE_FALL ? -1.0f : physics_bench_random() - 0.5f,
+        };
+
+        glm_vec3_normalize(direction);
+        glm_vec3_scale(direction, distance * get_cell_size(), displacement_array[box_index]);
+    }
+}
+
+int main(void)
+{
+    JobSystem* job_system = job_system_create(0);
+
+    // Bench worlds are generated fresh and never saved
+
+    World* world = world_create(NULL);
+    world_init(world, job_system);
+
+    printf("sector size %u, %u sectors loaded\n", get_sector_size_in_cells(), world->sector_count);
+
+    Aabb* start_aabb_array = malloc(sizeof(Aabb) * PHYSICS_BENCH_BOX_COUNT);
+    Aabb* aabb_array = malloc(sizeof(Aabb) * PHYSICS_BENCH_BOX_COUNT);
+    vec3* displacement_array = malloc(sizeof(vec3) * PHYSICS_BENCH_BOX_COUNT);
+
+    srand(1);
+
+    physics_bench_create_aabb_array(world, start_aabb_array);
+
+    for (u32 scene = 0; scene < PHYSICS_BENCH_SCENE_COUNT; ++scene)
+    {
+        physics_bench_create_displacement_array(scene, displacement_array);
+
+        u32 blocked_count = 0;
+        f64 elapsed_seconds = 0.0;
+
+        for (u32 iteration = 0; iteration < PHYSICS_BENCH_ITERATION_COUNT; ++iteration)
+        {
+            memcpy(aabb_array, start_aabb_array, sizeof(Aabb) * PHYSICS_BENCH_BOX_COUNT);
+
+            blocked_count = 0;
+
+            const f64 start_time = bench_get_time();
+
+            for (u32 box_index = 0; box_index < PHYSICS_BENCH_BOX_COUNT; ++box_index)
+            {
+                PhysicsMove move;
+                physics_move_aabb(world, &aabb_array[box_index], displacement_array[box_index], &move);
+
+                blocked_count += move.blocked_direction_mask != 0;
+            }
+
+            elapsed_seconds += bench_get_time() - start_time;
+        }
+
+        bench_report(
+            physics_bench_scene_name_array[scene],
+            elapsed_seconds,
+            (f64)PHYSICS_BENCH_ITERATION_COUNT * PHYSICS_BENCH_BOX_COUNT,
+            "moves"
+        );
+
+        printf("%-40s %10.1f%% blocked\n", "", 100.0 * blocked_count / PHYSICS_BENCH_BOX_COUNT);
+    }
+
+    free(displacement_array);
+    free(aabb_array);
+    free(start_aabb_array);
+
+    world_destroy(world);
+    job_system_destroy(job_system);
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench/bench.h"
+#include "app/world/grid.h"
+#include "app/world/raycast.h"
+#include "app/world/world.h"
+#include "core/job/job.h"
+
+// Traces picking rays from the camera and line of sight rays between random
+// points of the window, one at a time and as a batch
+
+#define RAYCAST_BENCH_RAY_COUNT 65536
+#define RAYCAST_BENCH_ITERATION_COUNT 8
+
+typedef enum RaycastBenchScene
+{
+    RAYCAST_BENCH_SCENE_PICK,
+    RAYCAST_BENCH_SCENE_LINE_OF_SIGHT,
+    RAYCAST_BENCH_SCENE_COUNT
+}
+RaycastBenchScene;
+
+static const char* raycast_bench_scene_name_array[RAYCAST_BENCH_SCENE_COUNT] =
+{
+    "pick",
+    "line of sight",
+};
+
+static f32 raycast_bench_random(void)
+{
+    return (f32)rand() / (f32)RAND_MAX;
+}
+
+static void raycast_bench_get_random_position(World* world, vec3 out_position)
+{
+    const f32 window_min = (f32)get_world_min_in_cells();
+    const f32 window_max = (f32)get_world_max_in_cells();
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        const f32 window_offset = (f32)(world->window_sector_coordinate[axis] * SECTOR_SIZE_IN_CELLS);
+
+        out_position[axis] = (window_offset + window_min + raycast_bench_random() * (window_max - window_min)) * get_cell_size();
+    }
+}
+
+static void raycast_bench_create_ray_array(World* world, RaycastBenchScene scene, Ray* ray_array)
+{
+    for (u32 ray_index = 0; ray_index < RAYCAST_BENCH_RAY_COUNT; ++ray_index)
+    {
+        Ray* ray = &ray_array[ray_index];
+
+        if (scene == RAYCAST_BENCH_SCENE_PICK)
+        {
+            glm_vec3_copy(world->camera.position, ray->origin);
+
+            vec3 direction =
+            {
+                1.0f,
+                raycast_bench_random() - 0.5f,
+                raycast_bench_random() - 0.8f,
+            };
+
+            glm_vec3_normalize(direction);
+            glm_vec3_copy(direction, ray->direction);
+
+            ray->max_distance = WORLD_PICK_DISTANCE;
+        }
+        else
+        {
+            vec3 target_position;
+
+            raycast_bench_get_random_position(world, ray->origin);
+            raycast_bench_get_random_position(world, target_position);
+
+            glm_vec3_sub(target_position, ray->origin, ray->direction);
+
+            ray->max_distance = glm_vec3_norm(ray->direction);
+
+            glm_vec3_normalize(ray->direction);
+        }
+    }
+}
+
+int main(void)
+{
+    JobSystem* job_system = job_system_create(0);
+
+    // Bench worlds are generated fresh and never saved
+
+    World* world = world_create(NULL);
+    world_init(world, job_system);
+
+    printf("sector size %u, %u sectors loaded\n", get_sector_size_in_cells(), world->sector_count);
+
+    Ray* ray_array = malloc(sizeof(Ray) * RAYCAST_BENCH_RAY_COUNT);
+    RaycastHit* hit_array = malloc(sizeof(RaycastHit) * RAYCAST_BENCH_RAY_COUNT);
+
+    RaycastBatch* raycast_batch = raycast_batch_create(RAYCAST_BENCH_RAY_COUNT);
+
+    srand(1);
+
+    for (u32 scene = 0; scene < RAYCAST_BENCH_SCENE_COUNT; ++scene)
+    {
+        raycast_bench_create_ray_array(world, scene, ray_array);
+
+        const f64 ray_count = (f64)RAYCAST_BENCH_ITERATION_COUNT * RAYCAST_BENCH_RAY_COUNT;
+
+        char name[64];
+
+        f64 start_time = bench_get_time();
+
+        for (u32 iteration = 0; iteration < RAYCAST_BENCH_ITERATION_COUNT; ++iteration)
+        {
+            for (u32 ray_index = 0; ray_index < RAYCAST_BENCH_RAY_COUNT; ++ray_index)
+            {
+                raycast_trace(world, &ray_array[ray_index], &hit_array[ray_index]);
+            }
+        }
+
+        snprintf(name, sizeof(name), "%s single", raycast_bench_scene_name_array[scene]);
+        bench_report(name, bench_get_time() - start_time, ray_count, "rays");
+
+        start_time = bench_get_time();
+
+        for (u32 iteration = 0; iteration < RAYCAST_BENCH_ITERATION_COUNT; ++iteration)
+        {
+            raycast_trace_batch(raycast_batch, world, ray_array, RAYCAST_BENCH_RAY_COUNT, hit_array);
+        }
+
+        snprintf(name, sizeof(name), "%s batch on %u workers", raycast_bench_scene_name_array[scene], job_system->worker_count);
+        bench_report(name, bench_get_time() - start_time, ray_count, "rays");
+
+        u32 hit_count = 0;
+
+        for (u32 ray_index = 0; ray_index < RAYCAST_BENCH_RAY_COUNT; ++ray_index)
+        {
+            hit_count += hit_array[ray_index].is_hit;
+        }
+
+        printf("%-40s %10.1f%% hit\n", "", 100.0 * hit_count / RAYCAST_BENCH_RAY_COUNT);
+    }
+
+    raycast_batch_destroy(raycast_batch);
+
+    free(hit_array);
+    free(ray_array);
+
+    world_destroy(world);
+    job_system_destroy(job_system);
+
+    return 0;
+}
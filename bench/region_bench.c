@@ -0,0 +1,164 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench/bench.h"
+#include "app/world/grid.h"
+#include "app/world/region.h"
+#include "app/world/sector.h"
+#include "core/core.h"
+
+// Compares a cold start that generates every sector of a region against one
+// that loads the same sectors from a saved region file
+
+#define REGION_BENCH_DIRECTORY "region_bench_save"
+#define REGION_BENCH_ITERATION_COUNT 20
+
+static CellType region_bench_generate_cell(GridCoordinate grid_coordinate)
+{
+    const f32 x = (f32)grid_coordinate[0];
+    const f32 y = (f32)grid_coordinate[1];
+
+    const i32 height = (i32)(6.0f * sinf(0.3f * x) + 6.0f * cosf(0.2f * y));
+
+    if (grid_coordinate[2] > height)
+    {
+        return CELL_TYPE_AIR;
+    }
+
+    return grid_coordinate[2] == height ? CELL_TYPE_GRASS : CELL_TYPE_STONE;
+}
+
+static Sector* region_bench_generate_sector(SectorCoordinate sector_coordinate)
+{
+    Sector* sector = sector_create(sector_coordinate);
+
+    GridCoordinate sector_grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector_coordinate, sector_grid_coordinate);
+
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+
+    for (CellIndex cell_index = 0; cell_index < sector_volume_in_cells; ++cell_index)
+    {
+        CellCoordinate cell_coordinate;
+        cell_index_to_cell_coordinate(cell_index, cell_coordinate);
+
+        GridCoordinate grid_coordinate;
+        glm_ivec3_add(sector_grid_coordinate, cell_coordinate, grid_coordinate);
+
+        const CellType cell_type = region_bench_generate_cell(grid_coordinate);
+
+        if (cell_type != CELL_TYPE_AIR)
+        {
+            sector_set_cell(sector, cell_index, cell_type);
+        }
+    }
+
+    return sector;
+}
+
+static void region_bench_get_sector_coordinate(u32 region_sector_index, SectorCoordinate out_sector_coordinate)
+{
+    // The region reaches up to the ground so that it holds surface and solid
+    // sectors
+
+    out_sector_coordinate[0] = (i32)(region_sector_index % REGION_SIZE_IN_SECTORS);
+    out_sector_coordinate[1] = (i32)((region_sector_index / REGION_SIZE_IN_SECTORS) % REGION_SIZE_IN_SECTORS);
+    out_sector_coordinate[2] = (i32)(region_sector_index / (REGION_SIZE_IN_SECTORS * REGION_SIZE_IN_SECTORS)) - REGION_SIZE_IN_SECTORS;
+}
+
+int main(void)
+{
+    printf("sector size %u, %u sectors per region\n", get_sector_size_in_cells(), REGION_VOLUME_IN_SECTORS);
+
+    if (!create_directory(REGION_BENCH_DIRECTORY))
+    {
+        return 1;
+    }
+
+    SectorCoordinate first_sector_coordinate;
+    region_bench_get_sector_coordinate(0, first_sector_coordinate);
+
+    RegionCoordinate region_coordinate;
+    sector_coordinate_to_region_coordinate(first_sector_coordinate, region_coordinate);
+
+    Region* region = region_open(REGION_BENCH_DIRECTORY, region_coordinate);
+
+    for (u32 region_sector_index = 0; region_sector_index < REGION_VOLUME_IN_SECTORS; ++region_sector_index)
+    {
+        SectorCoordinate sector_coordinate;
+        region_bench_get_sector_coordinate(region_sector_index, sector_coordinate);
+
+        Sector* sector = region_bench_generate_sector(sector_coordinate);
+
+        region_save_sector(region, sector_coordinate, sector);
+
+        sector_destroy(sector);
+    }
+
+    printf("region file %zu bytes\n", region->file_size);
+
+    char region_path[REGION_PATH_CAPACITY];
+    snprintf(region_path, sizeof(region_path), "%s", region->path);
+
+    region_close(region);
+
+    const f64 cell_count = (f64)REGION_BENCH_ITERATION_COUNT * REGION_VOLUME_IN_SECTORS * get_sector_volume_in_cells();
+
+    f64 start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < REGION_BENCH_ITERATION_COUNT; ++iteration)
+    {
+        for (u32 region_sector_index = 0; region_sector_index < REGION_VOLUME_IN_SECTORS; ++region_sector_index)
+        {
+            SectorCoordinate sector_coordinate;
+            region_bench_get_sector_coordinate(region_sector_index, sector_coordinate);
+
+            sector_destroy(region_bench_generate_sector(sector_coordinate));
+        }
+    }
+
+    bench_report("generate region", bench_get_time() - start_time, cell_count, "cells");
+
+    // Every iteration opens and maps the region again, as a cold start does.
+    // The file itself stays in the page cache after the first iteration.
+
+    u32 loaded_sector_count = 0;
+
+    start_time = bench_get_time();
+
+    for (u32 iteration = 0; iteration < REGION_BENCH_ITERATION_COUNT; ++iteration)
+    {
+        region = region_open(REGION_BENCH_DIRECTORY, region_coordinate);
+
+        for (u32 region_sector_index = 0; region_sector_index < REGION_VOLUME_IN_SECTORS; ++region_sector_index)
+        {
+            SectorCoordinate sector_coordinate;
+            region_bench_get_sector_coordinate(region_sector_index, sector_coordinate);
+
+            Sector* sector;
+
+            if (region_load_sector(region, sector_coordinate, &sector))
+            {
+                loaded_sector_count++;
+            }
+
+            if (sector)
+            {
+                sector_destroy(sector);
+            }
+        }
+
+        region_close(region);
+    }
+
+    bench_report("load region", bench_get_time() - start_time, cell_count, "cells");
+
+    printf("%u of %u sectors loaded\n", loaded_sector_count, REGION_BENCH_ITERATION_COUNT * REGION_VOLUME_IN_SECTORS);
+
+    unlink(region_path);
+    rmdir(REGION_BENCH_DIRECTORY);
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "render/tlsf.h"
+
+// Streams reallocations of a set of resource slots through one TLSF block,
+// with sizes skewed towards small resources and alignments from 16 bytes to
+// 64 KiB, as buffers and images ask for. Each slot allocates its new range
+// before freeing the old one. Every range is then checked for alignment and
+// against a map of the owner of each minimum block.
+
+#define TLSF_BENCH_SLOT_COUNT 3072
+#define TLSF_BENCH_SIZE (256ull * 1024 * 1024)
+#define TLSF_BENCH_MAX_RESOURCE_SIZE (256 * 1024)
+
+#define TLSF_BENCH_REALLOCATION_COUNT 1000000
+
+typedef struct TlsfBenchSlot
+{
+    u32 block;
+    u64 offset;
+    u64 size;
+    u64 alignment;
+}
+TlsfBenchSlot;
+
+static u64 tlsf_bench_get_resource_size(void)
+{
+    const f32 random = (f32)rand() / (f32)RAND_MAX;
+
+    return 1 + (u64)(random * random * random * TLSF_BENCH_MAX_RESOURCE_SIZE);
+}
+
+static u64 tlsf_bench_get_alignment(void)
+{
+    return 16ull << (rand() % 13);
+}
+
+int main(void)
+{
+    Tlsf* tlsf = tlsf_create(TLSF_BENCH_SIZE);
+
+    TlsfBenchSlot* slot_array = calloc(TLSF_BENCH_SLOT_COUNT, sizeof(TlsfBenchSlot));
+
+    u32 failed_count = 0;
+
+    srand(1);
+
+    f64 start_time = bench_get_time();
+
+    for (u32 reallocation_index = 0; reallocation_index < TLSF_BENCH_REALLOCATION_COUNT; ++reallocation_index)
+    {
+        TlsfBenchSlot* slot = &slot_array[rand() % TLSF_BENCH_SLOT_COUNT];
+
+        const u64 size = tlsf_bench_get_resource_size();
+        const u64 alignment = tlsf_bench_get_alignment();
+
+        u32 block;
+        u64 offset;
+
+        if (!tlsf_allocate(tlsf, size, alignment, &block, &offset))
+        {
+            failed_count++;
+
+            continue;
+        }
+
+        if (slot->size > 0)
+        {
+            tlsf_free(tlsf, slot->block);
+        }
+
+        slot->block = block;
+        slot->offset = offset;
+        slot->size = size;
+        slot->alignment = alignment;
+    }
+
+    bench_report("reallocate", bench_get_time() - start_time, TLSF_BENCH_REALLOCATION_COUNT, "reallocations");
+
+    const u64 unit_count = TLSF_BENCH_SIZE / TLSF_MIN_BLOCK_SIZE;
+
+    u32* owner_array = calloc(unit_count, sizeof(u32));
+
+    u32 overlap_count = 0;
+    u32 misaligned_count = 0;
+    u64 requested_size = 0;
+
+    for (u32 slot_index = 0; slot_index < TLSF_BENCH_SLOT_COUNT; ++slot_index)
+    {
+        const TlsfBenchSlot* slot = &slot_array[slot_index];
+
+        if (slot->size == 0)
+        {
+            continue;
+        }
+
+        misaligned_count += (slot->offset & (slot->alignment - 1)) != 0;
+        requested_size += slot->size;
+
+        const u64 first_unit = slot->offset / TLSF_MIN_BLOCK_SIZE;
+        const u64 last_unit = (slot->offset + slot->size - 1) / TLSF_MIN_BLOCK_SIZE;
+
+        for (u64 unit = first_unit; unit <= last_unit; ++unit)
+        {
+            overlap_count += owner_array[unit] != 0;
+            owner_array[unit] = slot_index + 1;
+        }
+    }
+
+    for (u32 block = 0; block < tlsf->block_count; ++block)
+    {
+        const TlsfBlock* tlsf_block = &tlsf->block_array[block];
+
+        if (!tlsf_block->is_free)
+        {
+            continue;
+        }
+
+        for (u64 unit = tlsf_block->offset / TLSF_MIN_BLOCK_SIZE; unit < (tlsf_block->offset + tlsf_block->size) / TLSF_MIN_BLOCK_SIZE; ++unit)
+        {
+            overlap_count += owner_array[unit] != 0;
+        }
+    }
+
+    const u64 free_size = tlsf->size - tlsf->used_size;
+
+    printf(
+        "%-40s %10.1f%% used, %.1f%% requested, %u free blocks, largest %.1f%% of free, %u failed, %u misaligned, %u overlapping\n",
+        "",
+        100.0 * tlsf->used_size / tlsf->size,
+        100.0 * requested_size / tlsf->size,
+        tlsf->free_block_count,
+        free_size > 0 ? 100.0 * tlsf_get_largest_free_size(tlsf) / free_size : 0.0,
+        failed_count,
+        misaligned_count,
+        overlap_count
+    );
+
+    free(owner_array);
+    free(slot_array);
+
+    tlsf_destroy(tlsf);
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "render/vertex_arena.h"
+
+// Streams remeshes of a set of sector slots through one vertex arena. Each
+// remesh allocates the new mesh before freeing the old one, as uploads do.
+// Mesh sizes are skewed towards small meshes, with a few large ones. Every
+// vertex is then checked against a map of the owner of each vertex.
+
+#define VERTEX_ARENA_BENCH_SLOT_COUNT 4096
+#define VERTEX_ARENA_BENCH_CAPACITY (16 * 1024 * 1024)
+#define VERTEX_ARENA_BENCH_MAX_MESH_VERTEX_COUNT 12288
+
+#define VERTEX_ARENA_BENCH_REMESH_COUNT 250000
+
+static u32 vertex_arena_bench_get_mesh_vertex_count(void)
+{
+    const f32 random = (f32)rand() / (f32)RAND_MAX;
+
+    return 6 + (u32)(random * random * random * VERTEX_ARENA_BENCH_MAX_MESH_VERTEX_COUNT) / 6 * 6;
+}
+
+int main(void)
+{
+    VertexArena* vertex_arena = vertex_arena_create(VERTEX_ARENA_BENCH_CAPACITY);
+
+    VertexArenaRange* slot_range_array = calloc(VERTEX_ARENA_BENCH_SLOT_COUNT, sizeof(VertexArenaRange));
+
+    u32 failed_count = 0;
+
+    srand(1);
+
+    f64 start_time = bench_get_time();
+
+    for (u32 remesh_index = 0; remesh_index < VERTEX_ARENA_BENCH_REMESH_COUNT; ++remesh_index)
+    {
+        VertexArenaRange* slot_range = &slot_range_array[rand() % VERTEX_ARENA_BENCH_SLOT_COUNT];
+
+        const u32 vertex_count = vertex_arena_bench_get_mesh_vertex_count();
+
+        u32 first_vertex;
+
+        if (!vertex_arena_allocate(vertex_arena, vertex_count, &first_vertex))
+        {
+            failed_count++;
+
+            continue;
+        }
+
+        vertex_arena_free(vertex_arena, slot_range->first_vertex, slot_range->vertex_count);
+
+        slot_range->first_vertex = first_vertex;
+        slot_range->vertex_count = vertex_count;
+    }
+
+    bench_report("remesh", bench_get_time() - start_time, VERTEX_ARENA_BENCH_REMESH_COUNT, "remeshes");
+
+    u32* owner_array = calloc(VERTEX_ARENA_BENCH_CAPACITY, sizeof(u32));
+
+    u32 overlap_count = 0;
+
+    for (u32 slot_index = 0; slot_index < VERTEX_ARENA_BENCH_SLOT_COUNT; ++slot_index)
+    {
+        const VertexArenaRange* slot_range = &slot_range_array[slot_index];
+
+        for (u32 vertex = 0; vertex < slot_range->vertex_count; ++vertex)
+        {
+            u32* owner = &owner_array[slot_range->first_vertex + vertex];
+
+            overlap_count += *owner != 0;
+            *owner = slot_index + 1;
+        }
+    }
+
+    for (u32 range_index = 0; range_index < vertex_arena->free_range_count; ++range_index)
+    {
+        const VertexArenaRange* free_range = &vertex_arena->free_range_array[range_index];
+
+        for (u32 vertex = 0; vertex < free_range->vertex_count; ++vertex)
+        {
+            overlap_count += owner_array[free_range->first_vertex + vertex] != 0;
+        }
+    }
+
+    const u32 free_vertex_count = VERTEX_ARENA_BENCH_CAPACITY - vertex_arena->used_vertex_count;
+
+    printf(
+        "%-40s %10.1f%% used, %u free ranges, largest %.1f%% of free, %u failed, %u overlapping vertices\n",
+        "",
+        100.0 * vertex_arena->used_vertex_count / VERTEX_ARENA_BENCH_CAPACITY,
+        vertex_arena->free_range_count,
+        free_vertex_count > 0 ? 100.0 * vertex_arena_get_largest_free_range(vertex_arena) / free_vertex_count : 0.0,
+        failed_count,
+        overlap_count
+    );
+
+    free(owner_array);
+    free(slot_range_array);
+
+    vertex_arena_destroy(vertex_arena);
+
+    return 0;
+}
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include "core/log/log.h"
+#include "core/job/job.h"
 #include "render/render.h"
 #include "platform/platform.h"
 #include "app/world/world.h"
@@ -16,7 +17,9 @@ App* app_create(void)
     app->platform = platform_create();
     app->render = render_create(app->platform);
 
-    app->world = world_create();
+    app->job_system = job_system_create(0);
+
+    app->world = world_create(WORLD_REGION_DIRECTORY);
 
     return app;
 }
@@ -26,6 +29,8 @@ void app_destroy(App* app)
     platform_destroy(app->platform);
     render_destroy(app->render);
 
+    job_system_destroy(app->job_system);
+
     world_destroy(app->world);
 
     LOG_INFO("App Destroyed");
@@ -39,9 +44,9 @@ void app_init(App* app)
     app->delta_time = 0.0;
 
     platform_init(app->platform);
-    render_init(app->render, app->platform);
+    render_init(app->render, app->platform, app->job_system);
 
-    world_init(app->world);
+    world_init(app->world, app->job_system);
 
     LOG_INFO("App Initialized");
 }
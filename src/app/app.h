@@ -8,6 +8,7 @@
 typedef struct Platform Platform;
 typedef struct Render Render;
 typedef struct World World;
+typedef struct JobSystem JobSystem;
 
 typedef struct
 {
@@ -19,6 +20,8 @@ typedef struct
     Platform* platform;
     Render* render;
 
+    JobSystem* job_system;
+
     World* world;
 }
 App;
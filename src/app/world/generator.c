@@ -0,0 +1,410 @@
+#include "app/world/generator.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define GENERATOR_HASH_X            0x8da6b343u
+#define GENERATOR_HASH_Y            0xd8163841u
+#define GENERATOR_HASH_MIX          0x5bd1e995u
+#define GENERATOR_OCTAVE_SEED_STEP  0x9e3779b9u
+
+// Heights are offset into positive range before truncation so that
+// truncation rounds down in every path
+
+#define GENERATOR_FLOOR_BIAS        1024
+
+static const u32 generator_octave_period_log2_array[GENERATOR_OCTAVE_COUNT] = { 6, 5, 4, 3 };
+static const f32 generator_octave_amplitude_array[GENERATOR_OCTAVE_COUNT] = { 8.0f, 4.0f, 2.0f, 1.0f };
+
+static inline u32 generator_hash(u32 seed, i32 x, i32 y)
+{
+    u32 hash = seed ^ ((u32)x * GENERATOR_HASH_X) ^ ((u32)y * GENERATOR_HASH_Y);
+
+    hash ^= hash >> 15;
+    hash *= GENERATOR_HASH_MIX;
+    hash ^= hash >> 13;
+
+    return hash;
+}
+
+static inline f32 generator_hash_to_value(u32 hash)
+{
+    return (f32)(hash >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline f32 generator_smooth(f32 weight)
+{
+    return weight * weight * (3.0f - 2.0f * weight);
+}
+
+static inline f32 generator_lerp(f32 a, f32 b, f32 weight)
+{
+    return a + (b - a) * weight;
+}
+
+void generator_init(Generator* generator, u32 seed)
+{
+    generator->seed = seed;
+    generator->base_height = -4;
+}
+
+i32 generator_sample_height(const Generator* generator, i32 x, i32 y)
+{
+    f32 height = 0.0f;
+
+    for (u32 octave = 0; octave < GENERATOR_OCTAVE_COUNT; ++octave)
+    {
+        const u32 period_log2 = generator_octave_period_log2_array[octave];
+        const i32 period_mask = (1 << period_log2) - 1;
+        const f32 inverse_period = 1.0f / (f32)(1 << period_log2);
+
+        const u32 octave_seed = generator->seed + octave * GENERATOR_OCTAVE_SEED_STEP;
+
+        const i32 lattice_x = x >> period_log2;
+        const i32 lattice_y = y >> period_log2;
+
+        const f32 weight_x = generator_smooth((f32)(x & period_mask) * inverse_period);
+        const f32 weight_y = generator_smooth((f32)(y & period_mask) * inverse_period);
+
+        const f32 value_00 = generator_hash_to_value(generator_hash(octave_seed, lattice_x, lattice_y));
+        const f32 value_10 = generator_hash_to_value(generator_hash(octave_seed, lattice_x + 1, lattice_y));
+        const f32 value_01 = generator_hash_to_value(generator_hash(octave_seed, lattice_x, lattice_y + 1));
+        const f32 value_11 = generator_hash_to_value(generator_hash(octave_seed, lattice_x + 1, lattice_y + 1));
+
+        const f32 value = generator_lerp(
+            generator_lerp(value_00, value_10, weight_x),
+            generator_lerp(value_01, value_11, weight_x),
+            weight_y
+        );
+
+        height = height + generator_octave_amplitude_array[octave] * (value * 2.0f - 1.0f);
+    }
+
+    return generator->base_height + (i32)(height + (f32)GENERATOR_FLOOR_BIAS) - GENERATOR_FLOOR_BIAS;
+}
+
+#if defined(__AVX2__)
+
+static inline __m256i generator_hash_avx2(u32 seed_y, __m256i lattice_x)
+{
+    __m256i hash = _mm256_xor_si256(
+        _mm256_set1_epi32((i32)seed_y),
+        _mm256_mullo_epi32(lattice_x, _mm256_set1_epi32((i32)GENERATOR_HASH_X))
+    );
+
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15));
+    hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((i32)GENERATOR_HASH_MIX));
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 13));
+
+    return hash;
+}
+
+static inline __m256 generator_hash_to_value_avx2(__m256i hash)
+{
+    return _mm256_mul_ps(
+        _mm256_cvtepi32_ps(_mm256_srli_epi32(hash, 8)),
+        _mm256_set1_ps(1.0f / 16777216.0f)
+    );
+}
+
+static inline __m256 generator_lerp_avx2(__m256 a, __m256 b, __m256 weight)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), weight));
+}
+
+static void generator_sample_height_row_avx2(const Generator* generator, i32 x, i32 y, i32* out_height_array)
+{
+    for (u32 column = 0; column < GENERATOR_ROW_CAPACITY; column += 8)
+    {
+        const __m256i column_x = _mm256_add_epi32(
+            _mm256_set1_epi32(x + (i32)column),
+            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)
+        );
+
+        __m256 height = _mm256_setzero_ps();
+
+        for (u32 octave = 0; octave < GENERATOR_OCTAVE_COUNT; ++octave)
+        {
+            const u32 period_log2 = generator_octave_period_log2_array[octave];
+            const i32 period_mask = (1 << period_log2) - 1;
+            const f32 inverse_period = 1.0f / (f32)(1 << period_log2);
+
+            const u32 octave_seed = generator->seed + octave * GENERATOR_OCTAVE_SEED_STEP;
+
+            const i32 lattice_y = y >> period_log2;
+            const f32 weight_y = generator_smooth((f32)(y & period_mask) * inverse_period);
+
+            const __m256i lattice_x = _mm256_sra_epi32(column_x, _mm_cvtsi32_si128((i32)period_log2));
+            const __m256i lattice_x_next = _mm256_add_epi32(lattice_x, _mm256_set1_epi32(1));
+
+            __m256 weight_x = _mm256_mul_ps(
+                _mm256_cvtepi32_ps(_mm256_and_si256(column_x, _mm256_set1_epi32(period_mask))),
+                _mm256_set1_ps(inverse_period)
+            );
+
+            weight_x = _mm256_mul_ps(
+                _mm256_mul_ps(weight_x, weight_x),
+                _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_set1_ps(2.0f), weight_x))
+            );
+
+            const u32 seed_y = octave_seed ^ ((u32)lattice_y * GENERATOR_HASH_Y);
+            const u32 seed_y_next = octave_seed ^ ((u32)(lattice_y + 1) * GENERATOR_HASH_Y);
+
+            const __m256 value_00 = generator_hash_to_value_avx2(generator_hash_avx2(seed_y, lattice_x));
+            const __m256 value_10 = generator_hash_to_value_avx2(generator_hash_avx2(seed_y, lattice_x_next));
+            const __m256 value_01 = generator_hash_to_value_avx2(generator_hash_avx2(seed_y_next, lattice_x));
+            const __m256 value_11 = generator_hash_to_value_avx2(generator_hash_avx2(seed_y_next, lattice_x_next));
+
+            const __m256 value = generator_lerp_avx2(
+                generator_lerp_avx2(value_00, value_10, weight_x),
+                generator_lerp_avx2(value_01, value_11, weight_x),
+                _mm256_set1_ps(weight_y)
+            );
+
+            height = _mm256_add_ps(
+                height,
+                _mm256_mul_ps(
+                    _mm256_set1_ps(generator_octave_amplitude_array[octave]),
+                    _mm256_sub_ps(_mm256_mul_ps(value, _mm256_set1_ps(2.0f)), _mm256_set1_ps(1.0f))
+                )
+            );
+        }
+
+        const __m256i height_in_cells = _mm256_add_epi32(
+            _mm256_cvttps_epi32(_mm256_add_ps(height, _mm256_set1_ps((f32)GENERATOR_FLOOR_BIAS))),
+            _mm256_set1_epi32(generator->base_height - GENERATOR_FLOOR_BIAS)
+        );
+
+        _mm256_storeu_si256((__m256i*)&out_height_array[column], height_in_cells);
+    }
+}
+
+#elif defined(__SSE2__)
+
+// SSE2 has no 32-bit multiply, so the low halves of the even and odd lane
+// products are interleaved back together
+
+static inline __m128i generator_mullo_epi32_sse2(__m128i a, __m128i b)
+{
+    const __m128i even_product = _mm_mul_epu32(a, b);
+    const __m128i odd_product = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+    return _mm_unpacklo_epi32(
+        _mm_shuffle_epi32(even_product, _MM_SHUFFLE(0, 0, 2, 0)),
+        _mm_shuffle_epi32(odd_product, _MM_SHUFFLE(0, 0, 2, 0))
+    );
+}
+
+static inline __m128i generator_hash_sse2(u32 seed_y, __m128i lattice_x)
+{
+    __m128i hash = _mm_xor_si128(
+        _mm_set1_epi32((i32)seed_y),
+        generator_mullo_epi32_sse2(lattice_x, _mm_set1_epi32((i32)GENERATOR_HASH_X))
+    );
+
+    hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 15));
+    hash = generator_mullo_epi32_sse2(hash, _mm_set1_epi32((i32)GENERATOR_HASH_MIX));
+    hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 13));
+
+    return hash;
+}
+
+static inline __m128 generator_hash_to_value_sse2(__m128i hash)
+{
+    return _mm_mul_ps(
+        _mm_cvtepi32_ps(_mm_srli_epi32(hash, 8)),
+        _mm_set1_ps(1.0f / 16777216.0f)
+    );
+}
+
+static inline __m128 generator_lerp_sse2(__m128 a, __m128 b, __m128 weight)
+{
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), weight));
+}
+
+static void generator_sample_height_row_sse2(const Generator* generator, i32 x, i32 y, i32* out_height_array)
+{
+    for (u32 column = 0; column < GENERATOR_ROW_CAPACITY; column += 4)
+    {
+        const __m128i column_x = _mm_add_epi32(
+            _mm_set1_epi32(x + (i32)column),
+            _mm_setr_epi32(0, 1, 2, 3)
+        );
+
+        __m128 height = _mm_setzero_ps();
+
+        for (u32 octave = 0; octave < GENERATOR_OCTAVE_COUNT; ++octave)
+        {
+            const u32 period_log2 = generator_octave_period_log2_array[octave];
+            const i32 period_mask = (1 << period_log2) - 1;
+            const f32 inverse_period = 1.0f / (f32)(1 << period_log2);
+
+            const u32 octave_seed = generator->seed + octave * GENERATOR_OCTAVE_SEED_STEP;
+
+            const i32 lattice_y = y >> period_log2;
+            const f32 weight_y = generator_smooth((f32)(y & period_mask) * inverse_period);
+
+            const __m128i lattice_x = _mm_sra_epi32(column_x, _mm_cvtsi32_si128((i32)period_log2));
+            const __m128i lattice_x_next = _mm_add_epi32(lattice_x, _mm_set1_epi32(1));
+
+            __m128 weight_x = _mm_mul_ps(
+                _mm_cvtepi32_ps(_mm_and_si128(column_x, _mm_set1_epi32(period_mask))),
+                _mm_set1_ps(inverse_period)
+            );
+
+            weight_x = _mm_mul_ps(
+                _mm_mul_ps(weight_x, weight_x),
+                _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), weight_x))
+            );
+
+            const u32 seed_y = octave_seed ^ ((u32)lattice_y * GENERATOR_HASH_Y);
+            const u32 seed_y_next = octave_seed ^ ((u32)(lattice_y + 1) * GENERATOR_HASH_Y);
+
+            const __m128 value_00 = generator_hash_to_value_sse2(generator_hash_sse2(seed_y, lattice_x));
+            const __m128 value_10 = generator_hash_to_value_sse2(generator_hash_sse2(seed_y, lattice_x_next));
+            const __m128 value_01 = generator_hash_to_value_sse2(generator_hash_sse2(seed_y_next, lattice_x));
+            const __m128 value_11 = generator_hash_to_value_sse2(generator_hash_sse2(seed_y_next, lattice_x_next));
+
+            const __m128 value = generator_lerp_sse2(
+                generator_lerp_sse2(value_00, value_10, weight_x),
+                generator_lerp_sse2(value_01, value_11, weight_x),
+                _mm_set1_ps(weight_y)
+            );
+
+            height = _mm_add_ps(
+                height,
+                _mm_mul_ps(
+                    _mm_set1_ps(generator_octave_amplitude_array[octave]),
+                    _mm_sub_ps(_mm_mul_ps(value, _mm_set1_ps(2.0f)), _mm_set1_ps(1.0f))
+                )
+            );
+        }
+
+        const __m128i height_in_cells = _mm_add_epi32(
+            _mm_cvttps_epi32(_mm_add_ps(height, _mm_set1_ps((f32)GENERATOR_FLOOR_BIAS))),
+            _mm_set1_epi32(generator->base_height - GENERATOR_FLOOR_BIAS)
+        );
+
+        _mm_storeu_si128((__m128i*)&out_height_array[column], height_in_cells);
+    }
+}
+
+#endif
+
+// Samples GENERATOR_ROW_CAPACITY columns starting at x. Columns past the
+// sector size only pad the row to whole SIMD steps.
+
+void generator_sample_height_row(const Generator* generator, i32 x, i32 y, i32* out_height_array)
+{
+#if defined(__AVX2__)
+    generator_sample_height_row_avx2(generator, x, y, out_height_array);
+#elif defined(__SSE2__)
+    generator_sample_height_row_sse2(generator, x, y, out_height_array);
+#else
+    for (u32 column = 0; column < GENERATOR_ROW_CAPACITY; ++column)
+    {
+        out_height_array[column] = generator_sample_height(generator, x + (i32)column, y);
+    }
+#endif
+}
+
+// Samples the heightmap over the sector's columns and fills every column up
+// to its height, skipping sectors entirely above or below the surface
+
+Sector* generator_generate_sector(const Generator* generator, SectorCoordinate sector_coordinate)
+{
+    GridCoordinate sector_grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector_coordinate, sector_grid_coordinate);
+
+    const i32 min_z = sector_grid_coordinate[2] + SECTOR_MIN_CELL;
+    const i32 max_z = sector_grid_coordinate[2] + SECTOR_MAX_CELL;
+
+    i32 height_array[SECTOR_SIZE_IN_CELLS][GENERATOR_ROW_CAPACITY];
+
+    i32 min_height = INT32_MAX;
+    i32 max_height = INT32_MIN;
+
+    for (i32 row = 0; row < SECTOR_SIZE_IN_CELLS; ++row)
+    {
+        generator_sample_height_row(
+            generator,
+            sector_grid_coordinate[0] + SECTOR_MIN_CELL,
+            sector_grid_coordinate[1] + SECTOR_MIN_CELL + row,
+            height_array[row]
+        );
+
+        for (i32 column = 0; column < SECTOR_SIZE_IN_CELLS; ++column)
+        {
+            const i32 height = height_array[row][column];
+
+            min_height = height < min_height ? height : min_height;
+            max_height = height > max_height ? height : max_height;
+        }
+    }
+
+    if (min_z > max_height)
+    {
+        return NULL;
+    }
+
+    Sector* sector = sector_create(sector_coordinate);
+
+    if (max_z < min_height)
+    {
+        sector_set_cell_run(sector, 0, get_sector_volume_in_cells(), CELL_TYPE_STONE);
+
+        return sector;
+    }
+
+    CellType cell_type_array[SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS];
+
+    for (i32 row = 0; row < SECTOR_SIZE_IN_CELLS; ++row)
+    {
+        for (i32 column = 0; column < SECTOR_SIZE_IN_CELLS; ++column)
+        {
+            const i32 height = height_array[row][column];
+
+            for (i32 z = min_z; z <= max_z; ++z)
+            {
+                CellCoordinate cell_coordinate =
+                {
+                    column + SECTOR_MIN_CELL,
+                    row + SECTOR_MIN_CELL,
+                    z - sector_grid_coordinate[2],
+                };
+
+                CellType cell_type = CELL_TYPE_AIR;
+
+                if (z < height)
+                {
+                    cell_type = CELL_TYPE_STONE;
+                }
+                else if (z == height)
+                {
+                    cell_type = CELL_TYPE_GRASS;
+                }
+
+                cell_type_array[cell_coordinate_to_cell_index(cell_coordinate)] = cell_type;
+            }
+        }
+    }
+
+    sector_set_cell_array(sector, cell_type_array);
+
+    if (sector_is_empty(sector))
+    {
+        sector_destroy(sector);
+
+        return NULL;
+    }
+
+    return sector;
+}
+
+void generator_run_job(void* data)
+{
+    GeneratorJob* generator_job = data;
+
+    generator_job->sector = generator_generate_sector(generator_job->generator, generator_job->sector_coordinate);
+}
@@ -0,0 +1,59 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H 1
+
+#include "core/types.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+
+// Terrain is a heightmap of fractal value noise. Every octave places its
+// lattice on a power of two cell period, so lattice coordinates and
+// interpolation weights come from integer shifts and masks of the grid
+// coordinate and a sector depends only on the seed and its coordinate.
+//
+// Heights are sampled a row of columns at a time, 8 columns per step with
+// AVX2, 4 with SSE2 and one at a time otherwise. Every path evaluates the
+// same operations in the same order.
+
+#define GENERATOR_OCTAVE_COUNT 4
+
+#if defined(__AVX2__)
+#define GENERATOR_LANE_COUNT 8
+#elif defined(__SSE2__)
+#define GENERATOR_LANE_COUNT 4
+#else
+#define GENERATOR_LANE_COUNT 1
+#endif
+
+#define GENERATOR_ROW_CAPACITY \
+    ((SECTOR_SIZE_IN_CELLS + GENERATOR_LANE_COUNT - 1) / GENERATOR_LANE_COUNT * GENERATOR_LANE_COUNT)
+
+typedef struct Generator
+{
+    u32 seed;
+
+    i32 base_height;
+}
+Generator;
+
+// A sector to generate on a job. Generated sectors that are all air are
+// returned as NULL.
+
+typedef struct GeneratorJob
+{
+    const Generator* generator;
+
+    SectorCoordinate sector_coordinate;
+    Sector* sector;
+}
+GeneratorJob;
+
+void generator_init(Generator* generator, u32 seed);
+
+i32 generator_sample_height(const Generator* generator, i32 x, i32 y);
+void generator_sample_height_row(const Generator* generator, i32 x, i32 y, i32* out_height_array);
+
+Sector* generator_generate_sector(const Generator* generator, SectorCoordinate sector_coordinate);
+
+void generator_run_job(void* data);
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef GRID_H
 #define GRID_H 1
 
+#include <stdlib.h>
 #include <cglm/cglm.h>
 
 #include "core/types.h"
+#include "core/math/morton.h"
 
 typedef u32 SectorIndex;
 typedef ivec3 SectorCoordinate;
@@ -14,9 +16,99 @@ typedef ivec3 CellCoordinate;
 typedef ivec3 GridCoordinate;
 
 #define WORLD_RADIUS_IN_SECTORS     2
-#define SECTOR_RADIUS_IN_CELLS      2
 #define CELL_RADIUS                 0.5f
 
+// The world keeps a window of resident sectors, WORLD_RADIUS_IN_SECTORS
+// around a window sector that follows the camera. Sector indices address the
+// window toroidally: every axis of a sector coordinate wraps modulo the window
+// size, so a sector keeps its index while the window moves and the sectors of
+// any window map to distinct indices.
+
+// GRID_POWER_OF_TWO selects sectors with a power of two edge length so that
+// every cell conversion reduces to shifts and masks. Cell coordinates then
+// span [-size / 2, size / 2 - 1] instead of being centered on an odd size.
+
+#if defined(GRID_POWER_OF_TWO)
+
+#define SECTOR_SIZE_IN_CELLS_LOG2   4
+#define SECTOR_SIZE_IN_CELLS        (1 << SECTOR_SIZE_IN_CELLS_LOG2)
+#define SECTOR_CELL_MASK            (SECTOR_SIZE_IN_CELLS - 1)
+
+#define SECTOR_MIN_CELL             (-(SECTOR_SIZE_IN_CELLS / 2))
+#define SECTOR_MAX_CELL             (SECTOR_SIZE_IN_CELLS / 2 - 1)
+
+#else
+
+#define SECTOR_RADIUS_IN_CELLS      2
+#define SECTOR_SIZE_IN_CELLS        (2 * SECTOR_RADIUS_IN_CELLS + 1)
+
+#define SECTOR_MIN_CELL             (-SECTOR_RADIUS_IN_CELLS)
+#define SECTOR_MAX_CELL             (SECTOR_RADIUS_IN_CELLS)
+
+#endif
+
+// GRID_CELL_LAYOUT_MORTON orders the cells of a sector along a Z-order curve
+// so that neighbors along every axis stay close in memory. The curve only
+// covers a sector densely when its edge length is a power of two.
+
+#if defined(GRID_CELL_LAYOUT_MORTON)
+
+#if !defined(GRID_POWER_OF_TWO)
+#error "GRID_CELL_LAYOUT_MORTON requires GRID_POWER_OF_TWO"
+#endif
+
+#if SECTOR_SIZE_IN_CELLS_LOG2 > MORTON_AXIS_BITS
+#error "Sector size exceeds the Morton code range"
+#endif
+
+#endif
+
+// Face neighbor directions, ordered so that direction ^ 1 is the opposite
+
+typedef enum GridDirection
+{
+    GRID_DIRECTION_POSITIVE_X,
+    GRID_DIRECTION_NEGATIVE_X,
+    GRID_DIRECTION_POSITIVE_Y,
+    GRID_DIRECTION_NEGATIVE_Y,
+    GRID_DIRECTION_POSITIVE_Z,
+    GRID_DIRECTION_NEGATIVE_Z,
+    GRID_DIRECTION_COUNT
+}
+GridDirection;
+
+static const i32 grid_direction_offset_array[GRID_DIRECTION_COUNT][3] =
+{
+    { +1, +0, +0 },
+    { -1, +0, +0 },
+    { +0, +1, +0 },
+    { +0, -1, +0 },
+    { +0, +0, +1 },
+    { +0, +0, -1 },
+};
+
+// The neighborhood of a sector or cell holds everything sharing a face, an
+// edge or a corner with it, indexed by offset as (x + 1) + 3 (y + 1) + 9 (z + 1)
+
+#define GRID_NEIGHBORHOOD_SIZE      3
+#define GRID_NEIGHBORHOOD_COUNT     27
+#define GRID_NEIGHBORHOOD_CENTER    13
+
+static inline u32 grid_offset_to_neighborhood_index(const i32* offset)
+{
+    return
+        (u32)(offset[0] + 1) +
+        (u32)(offset[1] + 1) * GRID_NEIGHBORHOOD_SIZE +
+        (u32)(offset[2] + 1) * GRID_NEIGHBORHOOD_SIZE * GRID_NEIGHBORHOOD_SIZE;
+}
+
+static inline void grid_neighborhood_index_to_offset(u32 neighborhood_index, i32* out_offset)
+{
+    out_offset[0] = (i32)(neighborhood_index % GRID_NEIGHBORHOOD_SIZE) - 1;
+    out_offset[1] = (i32)((neighborhood_index / GRID_NEIGHBORHOOD_SIZE) % GRID_NEIGHBORHOOD_SIZE) - 1;
+    out_offset[2] = (i32)(neighborhood_index / (GRID_NEIGHBORHOOD_SIZE * GRID_NEIGHBORHOOD_SIZE)) - 1;
+}
+
 static inline u32 get_world_size_in_sectors()
 {
     return 2 * WORLD_RADIUS_IN_SECTORS + 1;
@@ -38,7 +130,7 @@ static inline u32 get_world_volume_in_sectors()
 
 static inline u32 get_sector_size_in_cells()
 {
-    return 2 * SECTOR_RADIUS_IN_CELLS + 1;
+    return SECTOR_SIZE_IN_CELLS;
 }
 
 static inline u32 get_sector_area_in_cells()
@@ -55,9 +147,16 @@ static inline u32 get_sector_volume_in_cells()
     return sector_size_in_cells * sector_size_in_cells * sector_size_in_cells;
 }
 
-static inline u32 get_world_radius_in_cells()
+// Extent of the window centered on the origin sector
+
+static inline i32 get_world_min_in_cells()
 {
-    return WORLD_RADIUS_IN_SECTORS * get_sector_size_in_cells() + SECTOR_RADIUS_IN_CELLS;
+    return -WORLD_RADIUS_IN_SECTORS * SECTOR_SIZE_IN_CELLS + SECTOR_MIN_CELL;
+}
+
+static inline i32 get_world_max_in_cells()
+{
+    return WORLD_RADIUS_IN_SECTORS * SECTOR_SIZE_IN_CELLS + SECTOR_MAX_CELL;
 }
 
 static inline f32 get_cell_size()
@@ -89,31 +188,20 @@ static inline bool cell_index_is_valid(CellIndex cell_index)
     return cell_index < get_sector_volume_in_cells();
 }
 
-static inline bool sector_coordinate_is_valid(SectorCoordinate sector_coordinate)
+static inline bool sector_coordinate_is_valid(SectorCoordinate sector_coordinate, SectorCoordinate window_sector_coordinate)
 {
-    const bool in_x_range = sector_coordinate[0] >= -WORLD_RADIUS_IN_SECTORS && sector_coordinate[0] <= WORLD_RADIUS_IN_SECTORS;
-    const bool in_y_range = sector_coordinate[1] >= -WORLD_RADIUS_IN_SECTORS && sector_coordinate[1] <= WORLD_RADIUS_IN_SECTORS;
-    const bool in_z_range = sector_coordinate[2] >= -WORLD_RADIUS_IN_SECTORS && sector_coordinate[2] <= WORLD_RADIUS_IN_SECTORS;
+    const bool in_x_range = abs(sector_coordinate[0] - window_sector_coordinate[0]) <= WORLD_RADIUS_IN_SECTORS;
+    const bool in_y_range = abs(sector_coordinate[1] - window_sector_coordinate[1]) <= WORLD_RADIUS_IN_SECTORS;
+    const bool in_z_range = abs(sector_coordinate[2] - window_sector_coordinate[2]) <= WORLD_RADIUS_IN_SECTORS;
 
     return in_x_range && in_y_range && in_z_range;
 }
 
 static inline bool cell_coordinate_is_valid(CellCoordinate cell_coordinate)
 {
-    const bool in_x_range = cell_coordinate[0] >= -SECTOR_RADIUS_IN_CELLS && cell_coordinate[0] <= SECTOR_RADIUS_IN_CELLS;
-    const bool in_y_range = cell_coordinate[1] >= -SECTOR_RADIUS_IN_CELLS && cell_coordinate[1] <= SECTOR_RADIUS_IN_CELLS;
-    const bool in_z_range = cell_coordinate[2] >= -SECTOR_RADIUS_IN_CELLS && cell_coordinate[2] <= SECTOR_RADIUS_IN_CELLS;
-
-    return in_x_range && in_y_range && in_z_range;
-}
-
-static inline bool grid_coordinate_is_valid(GridCoordinate grid_coordinate)
-{
-    const u32 world_radius_in_cells = get_world_radius_in_cells();
-
-    const bool in_x_range = grid_coordinate[0] >= -world_radius_in_cells && grid_coordinate[0] <= world_radius_in_cells;
-    const bool in_y_range = grid_coordinate[1] >= -world_radius_in_cells && grid_coordinate[1] <= world_radius_in_cells;
-    const bool in_z_range = grid_coordinate[2] >= -world_radius_in_cells && grid_coordinate[2] <= world_radius_in_cells;
+    const bool in_x_range = cell_coordinate[0] >= SECTOR_MIN_CELL && cell_coordinate[0] <= SECTOR_MAX_CELL;
+    const bool in_y_range = cell_coordinate[1] >= SECTOR_MIN_CELL && cell_coordinate[1] <= SECTOR_MAX_CELL;
+    const bool in_z_range = cell_coordinate[2] >= SECTOR_MIN_CELL && cell_coordinate[2] <= SECTOR_MAX_CELL;
 
     return in_x_range && in_y_range && in_z_range;
 }
@@ -127,36 +215,133 @@ static inline void grid_coordinate_to_world_position(GridCoordinate grid_coordin
     out_world_position[2] = (f32)grid_coordinate[2] * cell_size;
 }
 
-static inline void sector_index_to_sector_coordinate(SectorIndex sector_index, SectorCoordinate out_sector_coordinate)
+static inline void world_position_to_grid_coordinate(vec3 world_position, GridCoordinate out_grid_coordinate)
 {
+    const f32 cell_size = get_cell_size();
+
+    out_grid_coordinate[0] = (i32)floorf(world_position[0] / cell_size + 0.5f);
+    out_grid_coordinate[1] = (i32)floorf(world_position[1] / cell_size + 0.5f);
+    out_grid_coordinate[2] = (i32)floorf(world_position[2] / cell_size + 0.5f);
+}
+
+// Wraps a value into [0, size) for toroidal addressing
+
+static inline u32 grid_wrap(i32 value, u32 size)
+{
+    const i32 remainder = value % (i32)size;
+
+    return (u32)(remainder < 0 ? remainder + (i32)size : remainder);
+}
+
+static inline i32 grid_floor_divide(i32 value, i32 divisor)
+{
+    const i32 quotient = value / divisor;
+
+    return quotient - (value % divisor < 0);
+}
+
+// Recovers the coordinate that a sector index addresses inside the window
+
+static inline void sector_index_to_sector_coordinate(
+    SectorIndex sector_index,
+    SectorCoordinate window_sector_coordinate,
+    SectorCoordinate out_sector_coordinate
+) {
     const u32 world_area_in_sectors = get_world_area_in_sectors();
     const u32 world_size_in_sectors = get_world_size_in_sectors();
 
-    out_sector_coordinate[0] = sector_index % world_size_in_sectors;
-    out_sector_coordinate[1] = (sector_index / world_size_in_sectors) % world_size_in_sectors;
-    out_sector_coordinate[2] = sector_index / world_area_in_sectors;
+    const u32 slot_array[3] =
+    {
+        sector_index % world_size_in_sectors,
+        (sector_index / world_size_in_sectors) % world_size_in_sectors,
+        sector_index / world_area_in_sectors,
+    };
 
-    glm_ivec3_subs(out_sector_coordinate, WORLD_RADIUS_IN_SECTORS, out_sector_coordinate);
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        const i32 window_min = window_sector_coordinate[axis] - WORLD_RADIUS_IN_SECTORS;
+
+        out_sector_coordinate[axis] = window_min + (i32)grid_wrap((i32)slot_array[axis] - window_min, world_size_in_sectors);
+    }
 }
 
 static inline SectorIndex sector_coordinate_to_sector_index(SectorCoordinate sector_coordinate)
 {
-    SectorCoordinate sector_coordinate_indexable;
-    glm_ivec3_adds(sector_coordinate, WORLD_RADIUS_IN_SECTORS, sector_coordinate_indexable);
+    const u32 world_size_in_sectors = get_world_size_in_sectors();
 
     SectorIndex out_sector_index = 
-        sector_coordinate_indexable[0] +
-        sector_coordinate_indexable[1] * get_world_size_in_sectors() +
-        sector_coordinate_indexable[2] * get_world_area_in_sectors();
+        grid_wrap(sector_coordinate[0], world_size_in_sectors) +
+        grid_wrap(sector_coordinate[1], world_size_in_sectors) * world_size_in_sectors +
+        grid_wrap(sector_coordinate[2], world_size_in_sectors) * get_world_area_in_sectors();
 
     return out_sector_index;
 }
 
 static inline void sector_coordinate_to_grid_coordinate(SectorCoordinate sector_coordinate, GridCoordinate out_grid_coordinate)
 {
-    glm_ivec3_scale(sector_coordinate, get_sector_size_in_cells(), out_grid_coordinate);
+    glm_ivec3_scale(sector_coordinate, SECTOR_SIZE_IN_CELLS, out_grid_coordinate);
+}
+
+#if defined(GRID_POWER_OF_TWO)
+
+#if defined(GRID_CELL_LAYOUT_MORTON)
+
+static inline void cell_index_to_cell_coordinate(CellIndex cell_index, CellCoordinate out_cell_coordinate)
+{
+    u32 x, y, z;
+    morton_decode_3d(cell_index, &x, &y, &z);
+
+    out_cell_coordinate[0] = (i32)x + SECTOR_MIN_CELL;
+    out_cell_coordinate[1] = (i32)y + SECTOR_MIN_CELL;
+    out_cell_coordinate[2] = (i32)z + SECTOR_MIN_CELL;
+}
+
+static inline CellIndex cell_coordinate_to_cell_index(CellCoordinate cell_coordinate)
+{
+    return morton_encode_3d(
+        (u32)(cell_coordinate[0] - SECTOR_MIN_CELL),
+        (u32)(cell_coordinate[1] - SECTOR_MIN_CELL),
+        (u32)(cell_coordinate[2] - SECTOR_MIN_CELL)
+    );
 }
 
+#else
+
+static inline void cell_index_to_cell_coordinate(CellIndex cell_index, CellCoordinate out_cell_coordinate)
+{
+    out_cell_coordinate[0] = (i32)(cell_index & SECTOR_CELL_MASK) + SECTOR_MIN_CELL;
+    out_cell_coordinate[1] = (i32)((cell_index >> SECTOR_SIZE_IN_CELLS_LOG2) & SECTOR_CELL_MASK) + SECTOR_MIN_CELL;
+    out_cell_coordinate[2] = (i32)(cell_index >> (2 * SECTOR_SIZE_IN_CELLS_LOG2)) + SECTOR_MIN_CELL;
+}
+
+static inline CellIndex cell_coordinate_to_cell_index(CellCoordinate cell_coordinate)
+{
+    CellIndex out_cell_index = 
+        (CellIndex)(cell_coordinate[0] - SECTOR_MIN_CELL) |
+        (CellIndex)(cell_coordinate[1] - SECTOR_MIN_CELL) << SECTOR_SIZE_IN_CELLS_LOG2 |
+        (CellIndex)(cell_coordinate[2] - SECTOR_MIN_CELL) << (2 * SECTOR_SIZE_IN_CELLS_LOG2);
+
+    return out_cell_index;
+}
+
+#endif
+
+static inline void grid_coordinate_to_sector_coordinate(GridCoordinate grid_coordinate, SectorCoordinate out_sector_coordinate)
+{
+    out_sector_coordinate[0] = (grid_coordinate[0] - SECTOR_MIN_CELL) >> SECTOR_SIZE_IN_CELLS_LOG2;
+    out_sector_coordinate[1] = (grid_coordinate[1] - SECTOR_MIN_CELL) >> SECTOR_SIZE_IN_CELLS_LOG2;
+    out_sector_coordinate[2] = (grid_coordinate[2] - SECTOR_MIN_CELL) >> SECTOR_SIZE_IN_CELLS_LOG2;
+}
+
+static inline void grid_coordinate_to_cell_coordinate(GridCoordinate grid_coordinate, CellCoordinate out_cell_coordinate)
+{
+    out_cell_coordinate[0] = ((grid_coordinate[0] - SECTOR_MIN_CELL) & SECTOR_CELL_MASK) + SECTOR_MIN_CELL;
+    out_cell_coordinate[1] = ((grid_coordinate[1] - SECTOR_MIN_CELL) & SECTOR_CELL_MASK) + SECTOR_MIN_CELL;
+    out_cell_coordinate[2] = ((grid_coordinate[2] - SECTOR_MIN_CELL) & SECTOR_CELL_MASK) + SECTOR_MIN_CELL;
+}
+
+#else
+
 static inline void cell_index_to_cell_coordinate(CellIndex cell_index, CellCoordinate out_cell_coordinate)
 {
     const u32 sector_area_in_cells = get_sector_area_in_cells();
@@ -184,30 +369,24 @@ static inline CellIndex cell_coordinate_to_cell_index(CellCoordinate cell_coordi
 
 static inline void grid_coordinate_to_sector_coordinate(GridCoordinate grid_coordinate, SectorCoordinate out_sector_coordinate)
 {
-    GridCoordinate grid_coordinate_indexable;
-    glm_ivec3_adds(grid_coordinate, get_world_radius_in_cells(), grid_coordinate_indexable);
-
-    SectorCoordinate sector_coordinate_indexable;
-    glm_ivec3_divs(grid_coordinate_indexable,get_sector_size_in_cells(), sector_coordinate_indexable);
+    const i32 sector_size_in_cells = (i32)get_sector_size_in_cells();
 
-    glm_ivec3_subs(sector_coordinate_indexable, WORLD_RADIUS_IN_SECTORS, out_sector_coordinate);
+    out_sector_coordinate[0] = grid_floor_divide(grid_coordinate[0] - SECTOR_MIN_CELL, sector_size_in_cells);
+    out_sector_coordinate[1] = grid_floor_divide(grid_coordinate[1] - SECTOR_MIN_CELL, sector_size_in_cells);
+    out_sector_coordinate[2] = grid_floor_divide(grid_coordinate[2] - SECTOR_MIN_CELL, sector_size_in_cells);
 }
 
 static inline void grid_coordinate_to_cell_coordinate(GridCoordinate grid_coordinate, CellCoordinate out_cell_coordinate)
 {
     const u32 sector_size_in_cells = get_sector_size_in_cells();
 
-    GridCoordinate grid_coordinate_indexable;
-    glm_ivec3_adds(grid_coordinate, get_world_radius_in_cells(), grid_coordinate_indexable);
-
-    CellCoordinate cell_coordinate_indexable;
-    cell_coordinate_indexable[0] = grid_coordinate_indexable[0] % sector_size_in_cells;
-    cell_coordinate_indexable[1] = grid_coordinate_indexable[1] % sector_size_in_cells;
-    cell_coordinate_indexable[2] = grid_coordinate_indexable[2] % sector_size_in_cells;
-
-    glm_ivec3_subs(cell_coordinate_indexable, SECTOR_RADIUS_IN_CELLS, out_cell_coordinate);
+    out_cell_coordinate[0] = (i32)grid_wrap(grid_coordinate[0] - SECTOR_MIN_CELL, sector_size_in_cells) + SECTOR_MIN_CELL;
+    out_cell_coordinate[1] = (i32)grid_wrap(grid_coordinate[1] - SECTOR_MIN_CELL, sector_size_in_cells) + SECTOR_MIN_CELL;
+    out_cell_coordinate[2] = (i32)grid_wrap(grid_coordinate[2] - SECTOR_MIN_CELL, sector_size_in_cells) + SECTOR_MIN_CELL;
 }
 
+#endif
+
 static inline SectorIndex grid_coordinate_to_sector_index(GridCoordinate grid_coordinate)
 {
     SectorCoordinate sector_coordinate;
@@ -216,6 +395,14 @@ static inline SectorIndex grid_coordinate_to_sector_index(GridCoordinate grid_co
     return sector_coordinate_to_sector_index(sector_coordinate);
 }
 
+static inline bool grid_coordinate_is_valid(GridCoordinate grid_coordinate, SectorCoordinate window_sector_coordinate)
+{
+    SectorCoordinate sector_coordinate;
+    grid_coordinate_to_sector_coordinate(grid_coordinate, sector_coordinate);
+
+    return sector_coordinate_is_valid(sector_coordinate, window_sector_coordinate);
+}
+
 static inline CellIndex grid_coordinate_to_cell_index(GridCoordinate grid_coordinate)
 {
     CellCoordinate cell_coordinate;
@@ -224,16 +411,42 @@ static inline CellIndex grid_coordinate_to_cell_index(GridCoordinate grid_coordi
     return cell_coordinate_to_cell_index(cell_coordinate);
 }
 
-static inline void indices_to_grid_coordinate(SectorIndex sector_index, CellIndex cell_index, GridCoordinate out_grid_coordinate)
-{
+static inline void indices_to_grid_coordinate(
+    SectorIndex sector_index,
+    CellIndex cell_index,
+    SectorCoordinate window_sector_coordinate,
+    GridCoordinate out_grid_coordinate
+) {
     SectorCoordinate sector_coordinate;
     CellCoordinate cell_coordinate;
 
-    sector_index_to_sector_coordinate(sector_index, sector_coordinate);
+    sector_index_to_sector_coordinate(sector_index, window_sector_coordinate, sector_coordinate);
     cell_index_to_cell_coordinate(cell_index, cell_coordinate);
 
-    glm_ivec3_scale(sector_coordinate, get_sector_size_in_cells(), out_grid_coordinate);
+    sector_coordinate_to_grid_coordinate(sector_coordinate, out_grid_coordinate);
     glm_ivec3_add(out_grid_coordinate, cell_coordinate, out_grid_coordinate);
 }
 
+static inline void cell_coordinate_array_to_cell_index_array(
+    const CellCoordinate* cell_coordinate_array,
+    CellIndex* out_cell_index_array,
+    u32 count
+) {
+    for (u32 index = 0; index < count; ++index)
+    {
+        out_cell_index_array[index] = cell_coordinate_to_cell_index((i32*)cell_coordinate_array[index]);
+    }
+}
+
+static inline void cell_index_array_to_cell_coordinate_array(
+    const CellIndex* cell_index_array,
+    CellCoordinate* out_cell_coordinate_array,
+    u32 count
+) {
+    for (u32 index = 0; index < count; ++index)
+    {
+        cell_index_to_cell_coordinate(cell_index_array[index], out_cell_coordinate_array[index]);
+    }
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,508 @@
+#include "app/world/light.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/log/log.h"
+#include "app/world/world.h"
+
+#define LIGHT_INITIAL_QUEUE_CAPACITY 4096
+
+static void light_queue_push(LightQueue* light_queue, const i32* grid_coordinate, u32 level)
+{
+    if (light_queue->tail == light_queue->capacity)
+    {
+        light_queue->capacity = light_queue->capacity ? 2 * light_queue->capacity : LIGHT_INITIAL_QUEUE_CAPACITY;
+        light_queue->node_array = realloc(light_queue->node_array, sizeof(LightNode) * light_queue->capacity);
+
+        if (!light_queue->node_array)
+        {
+            LOG_FATAL("Failed to allocate light queue");
+        }
+    }
+
+    LightNode* light_node = &light_queue->node_array[light_queue->tail++];
+
+    glm_ivec3_copy((i32*)grid_coordinate, light_node->grid_coordinate);
+    light_node->level = level;
+}
+
+static bool light_queue_pop(LightQueue* light_queue, LightNode* out_light_node)
+{
+    if (light_queue->head == light_queue->tail)
+    {
+        light_queue->head = 0;
+        light_queue->tail = 0;
+
+        return false;
+    }
+
+    *out_light_node = light_queue->node_array[light_queue->head++];
+
+    return true;
+}
+
+static inline u32 light_get_level(const Light* light, u32 level_index, LightChannel light_channel)
+{
+    const u8 packed_light = light->level_array[level_index];
+
+    return light_channel == LIGHT_CHANNEL_SKY ? light_get_sky(packed_light) : light_get_block(packed_light);
+}
+
+static inline void light_set_level(Light* light, u32 level_index, LightChannel light_channel, u32 level)
+{
+    const u8 packed_light = light->level_array[level_index];
+
+    light->level_array[level_index] =
+        light_channel == LIGHT_CHANNEL_SKY
+            ? light_pack(level, light_get_block(packed_light))
+            : light_pack(light_get_sky(packed_light), level);
+}
+
+// Finds the level slot and the type of a cell. Returns false when the cell is
+// outside the window or its sector is not loaded yet.
+
+static bool light_locate_cell(World* world, const i32* grid_coordinate, u32* out_level_index, CellType* out_cell_type)
+{
+    SectorCoordinate sector_coordinate;
+    grid_coordinate_to_sector_coordinate((i32*)grid_coordinate, sector_coordinate);
+
+    if (!sector_coordinate_is_valid(sector_coordinate, world->window_sector_coordinate))
+    {
+        return false;
+    }
+
+    const SectorIndex sector_index = sector_coordinate_to_sector_index(sector_coordinate);
+
+    if (!world_sector_is_loaded(world, sector_index))
+    {
+        return false;
+    }
+
+    const CellIndex cell_index = grid_coordinate_to_cell_index((i32*)grid_coordinate);
+
+    Sector* sector = world->sector_array[sector_index];
+
+    *out_level_index = sector_index * get_sector_volume_in_cells() + cell_index;
+    *out_cell_type = sector ? sector_get_cell(sector, cell_index) : CELL_TYPE_AIR;
+
+    return true;
+}
+
+// Cells in the top layer of the window see the sky when they are at or above
+// the terrain surface of their column. Below it, the terrain above the window
+// covers them.
+
+static inline bool light_is_under_open_sky(World* world, const i32* grid_coordinate)
+{
+    const i32 window_top_cell =
+        world->window_sector_coordinate[2] * SECTOR_SIZE_IN_CELLS +
+        WORLD_RADIUS_IN_SECTORS * SECTOR_SIZE_IN_CELLS +
+        SECTOR_MAX_CELL;
+
+    if (grid_coordinate[2] != window_top_cell)
+    {
+        return false;
+    }
+
+    return grid_coordinate[2] >= generator_sample_height(&world->generator, grid_coordinate[0], grid_coordinate[1]);
+}
+
+// Level that light of the given level carries into the neighbor in a
+// direction. Full sky light falls without loss.
+
+static inline u32 light_get_spread_level(LightChannel light_channel, GridDirection direction, u32 level)
+{
+    if (light_channel == LIGHT_CHANNEL_SKY && direction == GRID_DIRECTION_NEGATIVE_Z && level == LIGHT_LEVEL_MAX)
+    {
+        return LIGHT_LEVEL_MAX;
+    }
+
+    return level - 1;
+}
+
+// A cell on the boundary of its sector is sampled by the meshes of the
+// neighbors it touches, across faces, edges and corners
+
+static void light_set_cell_level(World* world, const i32* grid_coordinate, u32 level_index, LightChannel light_channel, u32 level)
+{
+    Light* light = world->light;
+
+    light_set_level(light, level_index, light_channel, level);
+
+    CellCoordinate cell_coordinate;
+    grid_coordinate_to_cell_coordinate((i32*)grid_coordinate, cell_coordinate);
+
+    static const u32 neighborhood_stride_array[3] =
+    {
+        1,
+        GRID_NEIGHBORHOOD_SIZE,
+        GRID_NEIGHBORHOOD_SIZE * GRID_NEIGHBORHOOD_SIZE
+    };
+
+    u32 neighborhood_mask = 1u << GRID_NEIGHBORHOOD_CENTER;
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        if (cell_coordinate[axis] == SECTOR_MIN_CELL)
+        {
+            neighborhood_mask |= neighborhood_mask >> neighborhood_stride_array[axis];
+        }
+        else if (cell_coordinate[axis] == SECTOR_MAX_CELL)
+        {
+            neighborhood_mask |= neighborhood_mask << neighborhood_stride_array[axis];
+        }
+    }
+
+    light->dirty_neighborhood_mask_array[level_index / get_sector_volume_in_cells()] |= neighborhood_mask;
+}
+
+static void light_mark_dirty_sectors(World* world)
+{
+    Light* light = world->light;
+
+    for (SectorIndex sector_index = 0; sector_index < get_world_volume_in_sectors(); ++sector_index)
+    {
+        u32 neighborhood_mask = light->dirty_neighborhood_mask_array[sector_index];
+
+        if (neighborhood_mask == 0)
+        {
+            continue;
+        }
+
+        light->dirty_neighborhood_mask_array[sector_index] = 0;
+
+        SectorCoordinate sector_coordinate;
+        sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+        while (neighborhood_mask)
+        {
+            const u32 neighborhood_index = (u32)__builtin_ctz(neighborhood_mask);
+            neighborhood_mask &= neighborhood_mask - 1;
+
+            i32 offset[3];
+            grid_neighborhood_index_to_offset(neighborhood_index, offset);
+
+            SectorCoordinate neighbor_sector_coordinate;
+            glm_ivec3_add(sector_coordinate, offset, neighbor_sector_coordinate);
+
+            if (!sector_coordinate_is_valid(neighbor_sector_coordinate, world->window_sector_coordinate))
+            {
+                continue;
+            }
+
+            const SectorIndex neighbor_sector_index = sector_coordinate_to_sector_index(neighbor_sector_coordinate);
+
+            if (world_sector_is_loaded(world, neighbor_sector_index))
+            {
+                world_mark_sector_dirty(world, neighbor_sector_index);
+            }
+        }
+    }
+}
+
+static void light_propagate(World* world, LightChannel light_channel)
+{
+    Light* light = world->light;
+
+    LightNode light_node;
+
+    while (light_queue_pop(&light->add_queue, &light_node))
+    {
+        u32 level_index;
+        CellType cell_type;
+
+        if (!light_locate_cell(world, light_node.grid_coordinate, &level_index, &cell_type))
+        {
+            continue;
+        }
+
+        const u32 level = light_get_level(light, level_index, light_channel);
+
+        if (level <= 1)
+        {
+            continue;
+        }
+
+        for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+        {
+            GridCoordinate neighbor_grid_coordinate;
+            glm_ivec3_add(light_node.grid_coordinate, (i32*)grid_direction_offset_array[direction], neighbor_grid_coordinate);
+
+            u32 neighbor_level_index;
+            CellType neighbor_cell_type;
+
+            if (
+                !light_locate_cell(world, neighbor_grid_coordinate, &neighbor_level_index, &neighbor_cell_type) ||
+                light_is_opaque(neighbor_cell_type)
+            ) {
+                continue;
+            }
+
+            const u32 spread_level = light_get_spread_level(light_channel, direction, level);
+
+            if (light_get_level(light, neighbor_level_index, light_channel) < spread_level)
+            {
+                light_set_cell_level(world, neighbor_grid_coordinate, neighbor_level_index, light_channel, spread_level);
+                light_queue_push(&light->add_queue, neighbor_grid_coordinate, 0);
+            }
+        }
+    }
+}
+
+// Clears every level that may have come through the cells of the removal
+// queue. Neighbors at least as bright as the light that reached them have
+// another source and are queued to relight the cleared cells.
+
+static void light_retract(World* world, LightChannel light_channel)
+{
+    Light* light = world->light;
+
+    LightNode light_node;
+
+    while (light_queue_pop(&light->remove_queue, &light_node))
+    {
+        for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+        {
+            GridCoordinate neighbor_grid_coordinate;
+            glm_ivec3_add(light_node.grid_coordinate, (i32*)grid_direction_offset_array[direction], neighbor_grid_coordinate);
+
+            u32 neighbor_level_index;
+            CellType neighbor_cell_type;
+
+            if (!light_locate_cell(world, neighbor_grid_coordinate, &neighbor_level_index, &neighbor_cell_type))
+            {
+                continue;
+            }
+
+            const u32 neighbor_level = light_get_level(light, neighbor_level_index, light_channel);
+
+            if (neighbor_level == 0)
+            {
+                continue;
+            }
+
+            const bool is_source = light_channel == LIGHT_CHANNEL_BLOCK && light_get_emission(neighbor_cell_type) > 0;
+
+            const bool is_dependent =
+                neighbor_level < light_node.level ||
+                light_get_spread_level(light_channel, direction, light_node.level) == neighbor_level;
+
+            if (is_dependent && !is_source)
+            {
+                light_set_cell_level(world, neighbor_grid_coordinate, neighbor_level_index, light_channel, 0);
+                light_queue_push(&light->remove_queue, neighbor_grid_coordinate, neighbor_level);
+            }
+            else
+            {
+                light_queue_push(&light->add_queue, neighbor_grid_coordinate, 0);
+            }
+        }
+    }
+}
+
+Light* light_create(void)
+{
+    Light* light = malloc(sizeof(*light));
+
+    if (!light)
+    {
+        LOG_FATAL("Failed to allocate light");
+    }
+
+    light->level_array = calloc((size_t)get_world_volume_in_sectors() * get_sector_volume_in_cells(), sizeof(u8));
+
+    if (!light->level_array)
+    {
+        LOG_FATAL("Failed to allocate light levels");
+    }
+
+    light->dirty_neighborhood_mask_array = calloc(get_world_volume_in_sectors(), sizeof(u32));
+
+    if (!light->dirty_neighborhood_mask_array)
+    {
+        LOG_FATAL("Failed to allocate light dirty masks");
+    }
+
+    memset(&light->add_queue, 0, sizeof(light->add_queue));
+    memset(&light->remove_queue, 0, sizeof(light->remove_queue));
+
+    return light;
+}
+
+void light_destroy(Light* light)
+{
+    free(light->remove_queue.node_array);
+    free(light->add_queue.node_array);
+
+    free(light->dirty_neighborhood_mask_array);
+    free(light->level_array);
+    free(light);
+}
+
+void light_clear_sector(Light* light, SectorIndex sector_index)
+{
+    memset((u8*)light_get_sector_level_array(light, sector_index), 0, get_sector_volume_in_cells());
+}
+
+// Seeds a sector entering the window with its own sources, the sky above the
+// window and the boundary cells of its loaded face neighbors, then floods
+// both channels from them
+
+void light_install_sector(World* world, SectorIndex sector_index)
+{
+    Light* light = world->light;
+
+    light_clear_sector(light, sector_index);
+
+    SectorCoordinate sector_coordinate;
+    sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+    GridCoordinate sector_grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector_coordinate, sector_grid_coordinate);
+
+    Sector* sector = world->sector_array[sector_index];
+
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+
+    for (u32 light_channel = 0; light_channel < LIGHT_CHANNEL_COUNT; ++light_channel)
+    {
+        for (CellIndex cell_index = 0; cell_index < sector_volume_in_cells; ++cell_index)
+        {
+            const CellType cell_type = sector ? sector_get_cell(sector, cell_index) : CELL_TYPE_AIR;
+
+            CellCoordinate cell_coordinate;
+            cell_index_to_cell_coordinate(cell_index, cell_coordinate);
+
+            GridCoordinate grid_coordinate;
+            glm_ivec3_add(sector_grid_coordinate, cell_coordinate, grid_coordinate);
+
+            u32 level = 0;
+
+            if (light_channel == LIGHT_CHANNEL_BLOCK)
+            {
+                level = light_get_emission(cell_type);
+            }
+            else if (!light_is_opaque(cell_type) && light_is_under_open_sky(world, grid_coordinate))
+            {
+                level = LIGHT_LEVEL_MAX;
+            }
+
+            if (level > 0)
+            {
+                light_set_cell_level(world, grid_coordinate, sector_index * sector_volume_in_cells + cell_index, light_channel, level);
+                light_queue_push(&light->add_queue, grid_coordinate, 0);
+            }
+        }
+
+        for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+        {
+            const u32 axis = direction / 2;
+            const u32 u_axis = (axis + 1) % 3;
+            const u32 v_axis = (axis + 2) % 3;
+
+            const bool is_positive = grid_direction_offset_array[direction][axis] > 0;
+
+            for (i32 v = SECTOR_MIN_CELL; v <= SECTOR_MAX_CELL; ++v)
+            {
+                for (i32 u = SECTOR_MIN_CELL; u <= SECTOR_MAX_CELL; ++u)
+                {
+                    GridCoordinate neighbor_grid_coordinate;
+                    neighbor_grid_coordinate[axis] = sector_grid_coordinate[axis] + (is_positive ? SECTOR_MAX_CELL + 1 : SECTOR_MIN_CELL - 1);
+                    neighbor_grid_coordinate[u_axis] = sector_grid_coordinate[u_axis] + u;
+                    neighbor_grid_coordinate[v_axis] = sector_grid_coordinate[v_axis] + v;
+
+                    u32 neighbor_level_index;
+                    CellType neighbor_cell_type;
+
+                    if (
+                        light_locate_cell(world, neighbor_grid_coordinate, &neighbor_level_index, &neighbor_cell_type) &&
+                        light_get_level(light, neighbor_level_index, light_channel) > 1
+                    ) {
+                        light_queue_push(&light->add_queue, neighbor_grid_coordinate, 0);
+                    }
+                }
+            }
+        }
+
+        light_propagate(world, light_channel);
+    }
+
+    light_mark_dirty_sectors(world);
+}
+
+void light_update_cell(World* world, GridCoordinate grid_coordinate, CellType old_cell_type, CellType new_cell_type)
+{
+    Light* light = world->light;
+
+    u32 level_index;
+    CellType cell_type;
+
+    if (!light_locate_cell(world, grid_coordinate, &level_index, &cell_type))
+    {
+        return;
+    }
+
+    const bool is_opaque = light_is_opaque(new_cell_type);
+
+    for (u32 light_channel = 0; light_channel < LIGHT_CHANNEL_COUNT; ++light_channel)
+    {
+        const u32 old_emission = light_channel == LIGHT_CHANNEL_BLOCK ? light_get_emission(old_cell_type) : 0;
+        const u32 new_emission = light_channel == LIGHT_CHANNEL_BLOCK ? light_get_emission(new_cell_type) : 0;
+
+        const u32 level = light_get_level(light, level_index, light_channel);
+
+        // Light that the cell emitted or let through and no longer does is
+        // retracted first
+
+        if (level > 0 && (is_opaque || old_emission > 0))
+        {
+            light_set_cell_level(world, grid_coordinate, level_index, light_channel, 0);
+            light_queue_push(&light->remove_queue, grid_coordinate, level);
+
+            light_retract(world, light_channel);
+        }
+
+        if (new_emission > 0)
+        {
+            light_set_cell_level(world, grid_coordinate, level_index, light_channel, new_emission);
+            light_queue_push(&light->add_queue, grid_coordinate, 0);
+        }
+
+        // A cell that lets light through again is filled from its neighbors
+
+        if (!is_opaque)
+        {
+            if (light_channel == LIGHT_CHANNEL_SKY && light_is_under_open_sky(world, grid_coordinate))
+            {
+                light_set_cell_level(world, grid_coordinate, level_index, light_channel, LIGHT_LEVEL_MAX);
+                light_queue_push(&light->add_queue, grid_coordinate, 0);
+            }
+
+            for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+            {
+                GridCoordinate neighbor_grid_coordinate;
+                glm_ivec3_add(grid_coordinate, (i32*)grid_direction_offset_array[direction], neighbor_grid_coordinate);
+
+                light_queue_push(&light->add_queue, neighbor_grid_coordinate, 0);
+            }
+        }
+
+        light_propagate(world, light_channel);
+    }
+
+    light_mark_dirty_sectors(world);
+}
+
+u8 light_get_cell(World* world, GridCoordinate grid_coordinate)
+{
+    u32 level_index;
+    CellType cell_type;
+
+    if (!light_locate_cell(world, grid_coordinate, &level_index, &cell_type))
+    {
+        return 0;
+    }
+
+    return world->light->level_array[level_index];
+}
@@ -0,0 +1,119 @@
+#ifndef LIGHT_H
+#define LIGHT_H 1
+
+#include "core/types.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+
+// Every cell of the window carries a sky light and a block light level in
+// [0, LIGHT_LEVEL_MAX], packed into one byte. Light spreads through air with
+// a breadth-first flood fill that loses one level per cell, except that full
+// sky light falls straight down without loss. Solid cells block both
+// channels, and cells at the top of the window that are at or above the
+// terrain surface of their column receive full sky light, so caves stay dark
+// however deep the window goes.
+//
+// Edits relight incrementally. Light that a changed cell no longer lets
+// through is retracted with a removal flood that clears every level that
+// could have come through the cell and queues the brighter cells around the
+// cleared region, which then refill it with the regular flood. Both floods
+// stop where the levels stop changing, so an edit only touches the cells
+// whose light it changes.
+//
+// Sectors entering the window pull in the light of their loaded neighbors.
+// Light does not enter sectors that are not loaded yet.
+
+#define LIGHT_LEVEL_MAX 15
+#define LIGHT_TORCH_LEVEL 14
+
+#define LIGHT_SKY_SHIFT 4
+#define LIGHT_BLOCK_MASK 0x0F
+
+typedef enum LightChannel
+{
+    LIGHT_CHANNEL_SKY,
+    LIGHT_CHANNEL_BLOCK,
+    LIGHT_CHANNEL_COUNT
+}
+LightChannel;
+
+typedef struct World World;
+
+typedef struct LightNode
+{
+    GridCoordinate grid_coordinate;
+    u32 level;
+}
+LightNode;
+
+// Queues are reset once drained, so they only grow to the largest flood
+
+typedef struct LightQueue
+{
+    u32 head;
+    u32 tail;
+    u32 capacity;
+
+    LightNode* node_array;
+}
+LightQueue;
+
+typedef struct Light
+{
+    // Packed levels of every cell of the window, indexed by sector index and
+    // cell index
+
+    u8* level_array;
+
+    // Neighborhood of every sector whose meshes sample the levels changed by
+    // the current flood, as bits by neighborhood index. Collected per cell
+    // and marked dirty once per flood.
+
+    u32* dirty_neighborhood_mask_array;
+
+    LightQueue add_queue;
+    LightQueue remove_queue;
+}
+Light;
+
+static inline u32 light_get_sky(u8 light)
+{
+    return light >> LIGHT_SKY_SHIFT;
+}
+
+static inline u32 light_get_block(u8 light)
+{
+    return light & LIGHT_BLOCK_MASK;
+}
+
+static inline u8 light_pack(u32 sky, u32 block)
+{
+    return (u8)(sky << LIGHT_SKY_SHIFT | block);
+}
+
+static inline bool light_is_opaque(CellType cell_type)
+{
+    return cell_type != CELL_TYPE_AIR;
+}
+
+static inline u32 light_get_emission(CellType cell_type)
+{
+    return cell_type == CELL_TYPE_TORCH ? LIGHT_TORCH_LEVEL : 0;
+}
+
+Light* light_create(void);
+void light_destroy(Light* light);
+
+static inline const u8* light_get_sector_level_array(Light* light, SectorIndex sector_index)
+{
+    return &light->level_array[sector_index * get_sector_volume_in_cells()];
+}
+
+void light_clear_sector(Light* light, SectorIndex sector_index);
+
+void light_install_sector(World* world, SectorIndex sector_index);
+void light_update_cell(World* world, GridCoordinate grid_coordinate, CellType old_cell_type, CellType new_cell_type);
+
+u8 light_get_cell(World* world, GridCoordinate grid_coordinate);
+
+#endif
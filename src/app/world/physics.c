@@ -0,0 +1,170 @@
+#include "app/world/physics.h"
+
+#include <math.h>
+
+#include "app/world/world.h"
+
+// Sweep order, vertical first so that a box moving into a slope settles on
+// top of it before sliding along it
+
+static const u32 physics_axis_order_array[3] = { 2, 0, 1 };
+
+// Cell i spans [(i - 1/2) size, (i + 1/2) size) along each axis. Returns the
+// range of cells an interval overlaps by more than the skin width.
+
+static inline void physics_get_cell_range(f32 min_position, f32 max_position, i32* out_min_cell, i32* out_max_cell)
+{
+    const f32 cell_size = get_cell_size();
+
+    *out_min_cell = (i32)floorf((min_position + PHYSICS_SKIN_WIDTH) / cell_size + 0.5f);
+    *out_max_cell = (i32)ceilf((max_position - PHYSICS_SKIN_WIDTH) / cell_size + 0.5f) - 1;
+}
+
+// Whether any cell of the layer at the given cell along an axis, across the
+// cross section of the box, is solid
+
+static bool physics_is_layer_solid(World* world, u32 axis, i32 layer, const i32* min_cell, const i32* max_cell)
+{
+    const u32 u_axis = (axis + 1) % 3;
+    const u32 v_axis = (axis + 2) % 3;
+
+    GridCoordinate grid_coordinate;
+    grid_coordinate[axis] = layer;
+
+    for (i32 v = min_cell[v_axis]; v <= max_cell[v_axis]; ++v)
+    {
+        grid_coordinate[v_axis] = v;
+
+        for (i32 u = min_cell[u_axis]; u <= max_cell[u_axis]; ++u)
+        {
+            grid_coordinate[u_axis] = u;
+
+            if (physics_is_cell_solid(world, grid_coordinate))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Returns how far the box can move along one axis, up to the given
+// distance, walking the layers of cells ahead of its leading face
+
+static f32 physics_sweep_axis(World* world, const Aabb* aabb, u32 axis, f32 distance)
+{
+    const f32 cell_size = get_cell_size();
+
+    i32 min_cell[3];
+    i32 max_cell[3];
+
+    for (u32 cross_axis = 0; cross_axis < 3; ++cross_axis)
+    {
+        physics_get_cell_range(aabb->min[cross_axis], aabb->max[cross_axis], &min_cell[cross_axis], &max_cell[cross_axis]);
+    }
+
+    if (distance > 0.0f)
+    {
+        // From the first cell starting at or past the leading face to the
+        // last cell starting before its end position
+
+        const i32 first_layer = (i32)ceilf((aabb->max[axis] - PHYSICS_SKIN_WIDTH) / cell_size + 0.5f);
+        const i32 last_layer = (i32)ceilf((aabb->max[axis] + distance) / cell_size + 0.5f) - 1;
+
+        for (i32 layer = first_layer; layer <= last_layer; ++layer)
+        {
+            if (physics_is_layer_solid(world, axis, layer, min_cell, max_cell))
+            {
+                const f32 blocked_distance = ((f32)layer - 0.5f) * cell_size - aabb->max[axis] - PHYSICS_SKIN_WIDTH;
+
+                return blocked_distance > 0.0f ? blocked_distance : 0.0f;
+            }
+        }
+    }
+    else if (distance < 0.0f)
+    {
+        const i32 first_layer = (i32)floorf((aabb->min[axis] + PHYSICS_SKIN_WIDTH) / cell_size - 0.5f);
+        const i32 last_layer = (i32)floorf((aabb->min[axis] + distance) / cell_size - 0.5f) + 1;
+
+        for (i32 layer = first_layer; layer >= last_layer; --layer)
+        {
+            if (physics_is_layer_solid(world, axis, layer, min_cell, max_cell))
+            {
+                const f32 blocked_distance = ((f32)layer + 0.5f) * cell_size - aabb->min[axis] + PHYSICS_SKIN_WIDTH;
+
+                return blocked_distance < 0.0f ? blocked_distance : 0.0f;
+            }
+        }
+    }
+
+    return distance;
+}
+
+bool physics_is_cell_solid(World* world, GridCoordinate grid_coordinate)
+{
+    if (!grid_coordinate_is_valid(grid_coordinate, world->window_sector_coordinate))
+    {
+        return true;
+    }
+
+    const SectorIndex sector_index = grid_coordinate_to_sector_index(grid_coordinate);
+
+    if (!world_sector_is_loaded(world, sector_index))
+    {
+        return true;
+    }
+
+    Sector* sector = world->sector_array[sector_index];
+
+    return sector && sector_get_cell(sector, grid_coordinate_to_cell_index(grid_coordinate)) != CELL_TYPE_AIR;
+}
+
+bool physics_aabb_overlaps_solid(World* world, const Aabb* aabb)
+{
+    i32 min_cell[3];
+    i32 max_cell[3];
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        physics_get_cell_range(aabb->min[axis], aabb->max[axis], &min_cell[axis], &max_cell[axis]);
+    }
+
+    for (i32 z = min_cell[2]; z <= max_cell[2]; ++z)
+    {
+        if (physics_is_layer_solid(world, 2, z, min_cell, max_cell))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void physics_move_aabb(World* world, Aabb* aabb, const vec3 displacement, PhysicsMove* out_move)
+{
+    glm_vec3_zero(out_move->displacement);
+    out_move->blocked_direction_mask = 0;
+
+    for (u32 axis_index = 0; axis_index < 3; ++axis_index)
+    {
+        const u32 axis = physics_axis_order_array[axis_index];
+
+        if (displacement[axis] == 0.0f)
+        {
+            continue;
+        }
+
+        const f32 distance = physics_sweep_axis(world, aabb, axis, displacement[axis]);
+
+        if (distance != displacement[axis])
+        {
+            out_move->blocked_direction_mask |= 1u << (2 * axis + (displacement[axis] < 0.0f ? 1 : 0));
+        }
+
+        aabb->min[axis] += distance;
+        aabb->max[axis] += distance;
+
+        out_move->displacement[axis] = distance;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H 1
+
+#include <cglm/cglm.h>
+
+#include "core/types.h"
+#include "app/world/grid.h"
+
+// Axis-aligned boxes collide with solid cells. A move sweeps the box along
+// one axis at a time, vertical first, and stops it in front of the first
+// layer of cells ahead of its leading face that holds a solid cell. Layers
+// are visited in order up to the end of the move, so no displacement
+// tunnels through a cell, and only the cells the swept box overlaps are
+// read. Cells the box already overlaps never block it, so a box caught
+// inside a cell can move out.
+//
+// Cells outside the window or in sectors that are not loaded yet block
+// movement. Queries allocate nothing and only read the world.
+
+// Gap left between a stopped box and the cell that stopped it, so the box
+// does not count as overlapping the cell on the next move
+
+#define PHYSICS_SKIN_WIDTH 1e-3f
+
+typedef struct World World;
+
+typedef struct Aabb
+{
+    vec3 min;
+    vec3 max;
+}
+Aabb;
+
+// The displacement actually applied, and one bit per GridDirection the box
+// was stopped in
+
+typedef struct PhysicsMove
+{
+    vec3 displacement;
+    u32 blocked_direction_mask;
+}
+PhysicsMove;
+
+static inline void aabb_from_center(const vec3 center, const vec3 half_extent, Aabb* out_aabb)
+{
+    glm_vec3_sub((f32*)center, (f32*)half_extent, out_aabb->min);
+    glm_vec3_add((f32*)center, (f32*)half_extent, out_aabb->max);
+}
+
+bool physics_is_cell_solid(World* world, GridCoordinate grid_coordinate);
+bool physics_aabb_overlaps_solid(World* world, const Aabb* aabb);
+
+void physics_move_aabb(World* world, Aabb* aabb, const vec3 displacement, PhysicsMove* out_move);
+
+#endif
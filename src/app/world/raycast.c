@@ -0,0 +1,436 @@
+#include "app/world/raycast.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/log/log.h"
+#include "app/world/world.h"
+
+// Traversal runs in cell space, where cell g spans [g, g + 1) on every axis
+
+typedef struct RaycastState
+{
+    vec3 origin;
+    vec3 direction;
+
+    GridCoordinate grid_coordinate;
+
+    i32 step_array[3];
+    f32 t_max_array[3];
+    f32 t_delta_array[3];
+
+    f32 t;
+    i32 normal_axis;
+}
+RaycastState;
+
+static void raycast_reset_t_max(RaycastState* state)
+{
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        if (state->step_array[axis] > 0)
+        {
+            state->t_max_array[axis] = ((f32)(state->grid_coordinate[axis] + 1) - state->origin[axis]) / state->direction[axis];
+        }
+        else if (state->step_array[axis] < 0)
+        {
+            state->t_max_array[axis] = ((f32)state->grid_coordinate[axis] - state->origin[axis]) / state->direction[axis];
+        }
+        else
+        {
+            state->t_max_array[axis] = FLT_MAX;
+        }
+    }
+}
+
+static inline i32 raycast_clamp(i32 value, i32 min_value, i32 max_value)
+{
+    return value < min_value ? min_value : value > max_value ? max_value : value;
+}
+
+// Moves the ray onto the first cell past the sector spanning the given cells.
+// Returns false when the ray ends before leaving the sector.
+
+static bool raycast_skip_sector(RaycastState* state, const i32* sector_min_cell, const i32* sector_max_cell, f32 t_end)
+{
+    i32 exit_axis = -1;
+    f32 t_exit = FLT_MAX;
+
+    for (i32 axis = 0; axis < 3; ++axis)
+    {
+        if (state->step_array[axis] == 0)
+        {
+            continue;
+        }
+
+        const i32 boundary = state->step_array[axis] > 0 ? sector_max_cell[axis] + 1 : sector_min_cell[axis];
+        const f32 t_axis = ((f32)boundary - state->origin[axis]) / state->direction[axis];
+
+        if (t_axis < t_exit)
+        {
+            t_exit = t_axis;
+            exit_axis = axis;
+        }
+    }
+
+    if (exit_axis < 0 || t_exit > t_end)
+    {
+        return false;
+    }
+
+    // The exit axis crosses exactly one boundary, the others are recovered
+    // from the exit point and kept inside the sector against rounding
+
+    for (i32 axis = 0; axis < 3; ++axis)
+    {
+        if (axis == exit_axis)
+        {
+            state->grid_coordinate[axis] = state->step_array[axis] > 0 ? sector_max_cell[axis] + 1 : sector_min_cell[axis] - 1;
+        }
+        else
+        {
+            state->grid_coordinate[axis] = raycast_clamp(
+                (i32)floorf(state->origin[axis] + state->direction[axis] * t_exit),
+                sector_min_cell[axis],
+                sector_max_cell[axis]
+            );
+        }
+    }
+
+    state->t = t_exit > state->t ? t_exit : state->t;
+    state->normal_axis = exit_axis;
+
+    raycast_reset_t_max(state);
+
+    return true;
+}
+
+static void raycast_set_hit(const RaycastState* state, CellType cell_type, RaycastHit* out_hit)
+{
+    out_hit->is_hit = true;
+    out_hit->cell_type = cell_type;
+    out_hit->distance = state->t;
+
+    glm_ivec3_copy((i32*)state->grid_coordinate, out_hit->grid_coordinate);
+
+    if (state->normal_axis < 0)
+    {
+        out_hit->normal_direction = GRID_DIRECTION_COUNT;
+    }
+    else
+    {
+        out_hit->normal_direction = (GridDirection)(2 * state->normal_axis + (state->step_array[state->normal_axis] > 0));
+    }
+}
+
+bool raycast_trace(World* world, const Ray* ray, RaycastHit* out_hit)
+{
+    out_hit->is_hit = false;
+    out_hit->cell_type = CELL_TYPE_AIR;
+    out_hit->normal_direction = GRID_DIRECTION_COUNT;
+    out_hit->distance = ray->max_distance;
+
+    RaycastState state;
+
+    const f32 inverse_cell_size = 1.0f / get_cell_size();
+
+    const i32 window_min_cell = -WORLD_RADIUS_IN_SECTORS * SECTOR_SIZE_IN_CELLS + SECTOR_MIN_CELL;
+    const i32 window_max_cell = WORLD_RADIUS_IN_SECTORS * SECTOR_SIZE_IN_CELLS + SECTOR_MAX_CELL;
+
+    f32 t_start = 0.0f;
+    f32 t_end = ray->max_distance;
+
+    state.normal_axis = -1;
+
+    // Clips the ray against the window's slabs
+
+    for (i32 axis = 0; axis < 3; ++axis)
+    {
+        state.origin[axis] = ray->origin[axis] * inverse_cell_size + 0.5f;
+        state.direction[axis] = ray->direction[axis] * inverse_cell_size;
+
+        const i32 window_offset = world->window_sector_coordinate[axis] * SECTOR_SIZE_IN_CELLS;
+
+        const f32 slab_min = (f32)(window_offset + window_min_cell);
+        const f32 slab_max = (f32)(window_offset + window_max_cell + 1);
+
+        if (state.direction[axis] == 0.0f)
+        {
+            if (state.origin[axis] < slab_min || state.origin[axis] >= slab_max)
+            {
+                return false;
+            }
+
+            state.step_array[axis] = 0;
+            state.t_delta_array[axis] = FLT_MAX;
+
+            continue;
+        }
+
+        f32 t_slab_near = (slab_min - state.origin[axis]) / state.direction[axis];
+        f32 t_slab_far = (slab_max - state.origin[axis]) / state.direction[axis];
+
+        if (t_slab_near > t_slab_far)
+        {
+            const f32 t_swap = t_slab_near;
+
+            t_slab_near = t_slab_far;
+            t_slab_far = t_swap;
+        }
+
+        if (t_slab_near > t_start)
+        {
+            t_start = t_slab_near;
+            state.normal_axis = axis;
+        }
+
+        t_end = t_slab_far < t_end ? t_slab_far : t_end;
+
+        state.step_array[axis] = state.direction[axis] > 0.0f ? 1 : -1;
+        state.t_delta_array[axis] = fabsf(1.0f / state.direction[axis]);
+    }
+
+    if (t_start > t_end)
+    {
+        return false;
+    }
+
+    for (i32 axis = 0; axis < 3; ++axis)
+    {
+        const i32 window_offset = world->window_sector_coordinate[axis] * SECTOR_SIZE_IN_CELLS;
+
+        state.grid_coordinate[axis] = raycast_clamp(
+            (i32)floorf(state.origin[axis] + state.direction[axis] * t_start),
+            window_offset + window_min_cell,
+            window_offset + window_max_cell
+        );
+    }
+
+    state.t = t_start;
+
+    raycast_reset_t_max(&state);
+
+    while (true)
+    {
+        SectorCoordinate sector_coordinate;
+        grid_coordinate_to_sector_coordinate(state.grid_coordinate, sector_coordinate);
+
+        if (!sector_coordinate_is_valid(sector_coordinate, world->window_sector_coordinate))
+        {
+            return false;
+        }
+
+        Sector* sector = world->sector_array[sector_coordinate_to_sector_index(sector_coordinate)];
+
+        GridCoordinate sector_grid_coordinate;
+        sector_coordinate_to_grid_coordinate(sector_coordinate, sector_grid_coordinate);
+
+        const i32 sector_min_cell[3] =
+        {
+            sector_grid_coordinate[0] + SECTOR_MIN_CELL,
+            sector_grid_coordinate[1] + SECTOR_MIN_CELL,
+            sector_grid_coordinate[2] + SECTOR_MIN_CELL,
+        };
+
+        const i32 sector_max_cell[3] =
+        {
+            sector_grid_coordinate[0] + SECTOR_MAX_CELL,
+            sector_grid_coordinate[1] + SECTOR_MAX_CELL,
+            sector_grid_coordinate[2] + SECTOR_MAX_CELL,
+        };
+
+        // Sectors that are all air, or not loaded yet, are crossed at once
+
+        if (!sector)
+        {
+            if (!raycast_skip_sector(&state, sector_min_cell, sector_max_cell, t_end))
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        CellCoordinate cell_coordinate;
+        glm_ivec3_sub(state.grid_coordinate, sector_grid_coordinate, cell_coordinate);
+
+        while (cell_coordinate_is_valid(cell_coordinate))
+        {
+            if (state.t > t_end)
+            {
+                return false;
+            }
+
+            const CellType cell_type = sector_get_cell(sector, cell_coordinate_to_cell_index(cell_coordinate));
+
+            if (cell_type != CELL_TYPE_AIR)
+            {
+                raycast_set_hit(&state, cell_type, out_hit);
+
+                return true;
+            }
+
+            i32 axis = state.t_max_array[0] < state.t_max_array[1] ? 0 : 1;
+            axis = state.t_max_array[2] < state.t_max_array[axis] ? 2 : axis;
+
+            state.t = state.t_max_array[axis];
+            state.t_max_array[axis] += state.t_delta_array[axis];
+
+            state.grid_coordinate[axis] += state.step_array[axis];
+            cell_coordinate[axis] += state.step_array[axis];
+
+            state.normal_axis = axis;
+        }
+    }
+}
+
+RaycastBatch* raycast_batch_create(u32 ray_capacity)
+{
+    RaycastBatch* raycast_batch = malloc(sizeof(*raycast_batch));
+
+    if (!raycast_batch)
+    {
+        LOG_FATAL("Failed to allocate raycast batch");
+    }
+
+    raycast_batch->ray_capacity = ray_capacity;
+    raycast_batch->ray_bucket_array = malloc(sizeof(u32) * ray_capacity);
+    raycast_batch->ray_index_array = malloc(sizeof(u32) * ray_capacity);
+
+    raycast_batch->bucket_count = 8 * get_world_volume_in_sectors();
+    raycast_batch->bucket_offset_array = malloc(sizeof(u32) * (raycast_batch->bucket_count + 1));
+
+    raycast_batch->job_capacity = (ray_capacity + RAYCAST_RAYS_PER_JOB - 1) / RAYCAST_RAYS_PER_JOB;
+    raycast_batch->job_array = malloc(sizeof(Job) * raycast_batch->job_capacity);
+    raycast_batch->raycast_job_array = malloc(sizeof(RaycastJob) * raycast_batch->job_capacity);
+
+    if (
+        !raycast_batch->ray_bucket_array ||
+        !raycast_batch->ray_index_array ||
+        !raycast_batch->bucket_offset_array ||
+        !raycast_batch->job_array ||
+        !raycast_batch->raycast_job_array
+    ) {
+        LOG_FATAL("Failed to allocate raycast batch");
+    }
+
+    atomic_init(&raycast_batch->job_counter.value, 0);
+
+    return raycast_batch;
+}
+
+void raycast_batch_destroy(RaycastBatch* raycast_batch)
+{
+    free(raycast_batch->raycast_job_array);
+    free(raycast_batch->job_array);
+    free(raycast_batch->bucket_offset_array);
+    free(raycast_batch->ray_index_array);
+    free(raycast_batch->ray_bucket_array);
+    free(raycast_batch);
+}
+
+static u32 raycast_get_bucket(const Ray* ray)
+{
+    const u32 octant =
+        (ray->direction[0] < 0.0f) |
+        (ray->direction[1] < 0.0f) << 1 |
+        (ray->direction[2] < 0.0f) << 2;
+
+    GridCoordinate grid_coordinate;
+    world_position_to_grid_coordinate((f32*)ray->origin, grid_coordinate);
+
+    return octant * get_world_volume_in_sectors() + grid_coordinate_to_sector_index(grid_coordinate);
+}
+
+static void raycast_run_job(void* data)
+{
+    RaycastJob* raycast_job = data;
+
+    for (u32 job_ray_index = 0; job_ray_index < raycast_job->ray_count; ++job_ray_index)
+    {
+        const u32 ray_index = raycast_job->ray_index_array[job_ray_index];
+
+        raycast_trace(raycast_job->world, &raycast_job->ray_array[ray_index], &raycast_job->hit_array[ray_index]);
+    }
+}
+
+// Traces up to the batch capacity at a time. Hits are written in the order
+// of the rays.
+
+void raycast_trace_batch(
+    RaycastBatch* raycast_batch,
+    World* world,
+    const Ray* ray_array,
+    u32 ray_count,
+    RaycastHit* out_hit_array
+) {
+    for (u32 first_ray_index = 0; first_ray_index < ray_count; first_ray_index += raycast_batch->ray_capacity)
+    {
+        const u32 remaining_ray_count = ray_count - first_ray_index;
+        const u32 batch_ray_count = remaining_ray_count < raycast_batch->ray_capacity ? remaining_ray_count : raycast_batch->ray_capacity;
+
+        const Ray* batch_ray_array = ray_array + first_ray_index;
+
+        // Counting sort of the rays by bucket
+
+        u32* bucket_offset_array = raycast_batch->bucket_offset_array;
+
+        memset(bucket_offset_array, 0, sizeof(u32) * (raycast_batch->bucket_count + 1));
+
+        for (u32 ray_index = 0; ray_index < batch_ray_count; ++ray_index)
+        {
+            const u32 bucket_index = raycast_get_bucket(&batch_ray_array[ray_index]);
+
+            raycast_batch->ray_bucket_array[ray_index] = bucket_index;
+            bucket_offset_array[bucket_index + 1]++;
+        }
+
+        for (u32 bucket_index = 0; bucket_index < raycast_batch->bucket_count; ++bucket_index)
+        {
+            bucket_offset_array[bucket_index + 1] += bucket_offset_array[bucket_index];
+        }
+
+        for (u32 ray_index = 0; ray_index < batch_ray_count; ++ray_index)
+        {
+            const u32 bucket_index = raycast_batch->ray_bucket_array[ray_index];
+
+            raycast_batch->ray_index_array[bucket_offset_array[bucket_index]++] = ray_index;
+        }
+
+        const u32 job_count = (batch_ray_count + RAYCAST_RAYS_PER_JOB - 1) / RAYCAST_RAYS_PER_JOB;
+
+        for (u32 job_index = 0; job_index < job_count; ++job_index)
+        {
+            RaycastJob* raycast_job = &raycast_batch->raycast_job_array[job_index];
+
+            const u32 job_first_ray_index = job_index * RAYCAST_RAYS_PER_JOB;
+
+            raycast_job->world = world;
+            raycast_job->ray_array = batch_ray_array;
+            raycast_job->ray_index_array = raycast_batch->ray_index_array + job_first_ray_index;
+            raycast_job->ray_count =
+                batch_ray_count - job_first_ray_index < RAYCAST_RAYS_PER_JOB
+                    ? batch_ray_count - job_first_ray_index
+                    : RAYCAST_RAYS_PER_JOB;
+            raycast_job->hit_array = out_hit_array + first_ray_index;
+
+            raycast_batch->job_array[job_index].function = raycast_run_job;
+            raycast_batch->job_array[job_index].data = raycast_job;
+        }
+
+        if (job_count == 1 || !world->job_system)
+        {
+            for (u32 job_index = 0; job_index < job_count; ++job_index)
+            {
+                raycast_run_job(&raycast_batch->raycast_job_array[job_index]);
+            }
+        }
+        else
+        {
+            job_system_submit(world->job_system, raycast_batch->job_array, job_count, &raycast_batch->job_counter);
+            job_system_wait(world->job_system, &raycast_batch->job_counter);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H 1
+
+#include <cglm/cglm.h>
+
+#include "core/types.h"
+#include "core/job/job.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+
+// Rays walk the grid cell by cell with an Amanatides-Woo DDA and cross
+// sectors without solid cells in a single step. Rays are clipped to the
+// window, since sectors outside it are not resident.
+//
+// Distances are measured along the ray direction in multiples of its length,
+// so a normalized direction gives distances in world units.
+
+#define RAYCAST_RAYS_PER_JOB 256
+
+typedef struct World World;
+
+typedef struct Ray
+{
+    vec3 origin;
+    vec3 direction;
+
+    f32 max_distance;
+}
+Ray;
+
+// The normal is the face the ray entered the hit cell through, or
+// GRID_DIRECTION_COUNT when the ray starts inside a solid cell
+
+typedef struct RaycastHit
+{
+    bool is_hit;
+
+    CellType cell_type;
+    GridCoordinate grid_coordinate;
+    GridDirection normal_direction;
+
+    f32 distance;
+}
+RaycastHit;
+
+typedef struct RaycastJob
+{
+    World* world;
+
+    const Ray* ray_array;
+    const u32* ray_index_array;
+    u32 ray_count;
+
+    RaycastHit* hit_array;
+}
+RaycastJob;
+
+// Batches reorder their rays by direction octant and origin sector before
+// tracing, so rays that walk the same sectors in the same order run
+// together, and split them into jobs of RAYCAST_RAYS_PER_JOB rays
+
+typedef struct RaycastBatch
+{
+    u32 ray_capacity;
+    u32* ray_bucket_array;
+    u32* ray_index_array;
+
+    u32 bucket_count;
+    u32* bucket_offset_array;
+
+    u32 job_capacity;
+    Job* job_array;
+    RaycastJob* raycast_job_array;
+
+    JobCounter job_counter;
+}
+RaycastBatch;
+
+bool raycast_trace(World* world, const Ray* ray, RaycastHit* out_hit);
+
+RaycastBatch* raycast_batch_create(u32 ray_capacity);
+void raycast_batch_destroy(RaycastBatch* raycast_batch);
+
+void raycast_trace_batch(
+    RaycastBatch* raycast_batch,
+    World* world,
+    const Ray* ray_array,
+    u32 ray_count,
+    RaycastHit* out_hit_array
+);
+
+#endif
@@ -0,0 +1,429 @@
+#include "app/world/region.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/log/log.h"
+
+static u32 region_get_cell_layout(void)
+{
+#if defined(GRID_CELL_LAYOUT_MORTON)
+    return REGION_CELL_LAYOUT_MORTON;
+#else
+    return REGION_CELL_LAYOUT_LINEAR;
+#endif
+}
+
+static const RegionHeader* region_get_header(Region* region)
+{
+    return (const RegionHeader*)region->mapped_data;
+}
+
+static bool region_header_is_valid(const RegionHeader* header, RegionCoordinate region_coordinate)
+{
+    return
+        header->magic == REGION_MAGIC &&
+        header->version == REGION_VERSION &&
+        header->sector_size_in_cells == get_sector_size_in_cells() &&
+        header->cell_layout == region_get_cell_layout() &&
+        header->coordinate[0] == region_coordinate[0] &&
+        header->coordinate[1] == region_coordinate[1] &&
+        header->coordinate[2] == region_coordinate[2];
+}
+
+static void region_unmap(Region* region)
+{
+    if (region->mapped_data)
+    {
+        munmap((void*)region->mapped_data, region->mapped_size);
+    }
+
+    region->mapped_data = NULL;
+    region->mapped_size = 0;
+}
+
+static bool region_map(Region* region)
+{
+    region_unmap(region);
+
+    void* mapped_data = mmap(NULL, region->file_size, PROT_READ, MAP_SHARED, region->file_descriptor, 0);
+
+    if (mapped_data == MAP_FAILED)
+    {
+        LOG_ERROR("Failed to map region: %s", region->path);
+
+        return false;
+    }
+
+    region->mapped_data = mapped_data;
+    region->mapped_size = region->file_size;
+
+    return true;
+}
+
+static void region_close_file(Region* region)
+{
+    region_unmap(region);
+
+    if (region->file_descriptor >= 0)
+    {
+        close(region->file_descriptor);
+    }
+
+    region->file_descriptor = -1;
+    region->file_size = 0;
+}
+
+// Replaces whatever is at the region path with an empty region
+
+static bool region_create_file(Region* region)
+{
+    region->file_descriptor = open(region->path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (region->file_descriptor < 0)
+    {
+        LOG_ERROR("Failed to create region: %s", region->path);
+
+        return false;
+    }
+
+    RegionHeader header;
+    memset(&header, 0, sizeof(header));
+
+    header.magic = REGION_MAGIC;
+    header.version = REGION_VERSION;
+    header.sector_size_in_cells = get_sector_size_in_cells();
+    header.cell_layout = region_get_cell_layout();
+    glm_ivec3_copy(region->coordinate, header.coordinate);
+
+    if (pwrite(region->file_descriptor, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+    {
+        LOG_ERROR("Failed to write region header: %s", region->path);
+
+        region_close_file(region);
+
+        return false;
+    }
+
+    region->file_size = sizeof(header);
+
+    if (!region_map(region))
+    {
+        region_close_file(region);
+
+        return false;
+    }
+
+    return true;
+}
+
+Region* region_open(const char* directory, RegionCoordinate region_coordinate)
+{
+    Region* region = malloc(sizeof(*region));
+
+    if (!region)
+    {
+        LOG_FATAL("Failed to allocate region");
+    }
+
+    glm_ivec3_copy(region_coordinate, region->coordinate);
+
+    snprintf(
+        region->path,
+        sizeof(region->path),
+        "%s/%d.%d.%d.region",
+        directory,
+        region_coordinate[0],
+        region_coordinate[1],
+        region_coordinate[2]
+    );
+
+    region->file_descriptor = -1;
+    region->file_size = 0;
+    region->mapped_size = 0;
+    region->mapped_data = NULL;
+
+    const int file_descriptor = open(region->path, O_RDWR);
+
+    if (file_descriptor < 0)
+    {
+        if (errno != ENOENT)
+        {
+            LOG_WARN("Failed to open region: %s", region->path);
+        }
+
+        return region;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(file_descriptor, &file_stat) != 0 || (size_t)file_stat.st_size < sizeof(RegionHeader))
+    {
+        LOG_WARN("Ignoring truncated region: %s", region->path);
+
+        close(file_descriptor);
+
+        return region;
+    }
+
+    region->file_descriptor = file_descriptor;
+    region->file_size = (size_t)file_stat.st_size;
+
+    if (!region_map(region))
+    {
+        region_close_file(region);
+
+        return region;
+    }
+
+    // A region written with another grid configuration is treated as absent
+    // and replaced by the next save
+
+    if (!region_header_is_valid(region_get_header(region), region_coordinate))
+    {
+        LOG_WARN("Ignoring incompatible region: %s", region->path);
+
+        region_close_file(region);
+    }
+
+    return region;
+}
+
+void region_close(Region* region)
+{
+    region_close_file(region);
+
+    free(region);
+}
+
+static const RegionEntry* region_get_entry(Region* region, SectorCoordinate sector_coordinate)
+{
+    if (!region->mapped_data)
+    {
+        return NULL;
+    }
+
+    const RegionEntry* entry = &region_get_header(region)->entry_array[sector_coordinate_to_region_entry_index(sector_coordinate)];
+
+    if (entry->length == 0)
+    {
+        return NULL;
+    }
+
+    return entry;
+}
+
+bool region_has_sector(Region* region, SectorCoordinate sector_coordinate)
+{
+    return region_get_entry(region, sector_coordinate) != NULL;
+}
+
+// Sectors are only created once a solid cell is decoded
+
+static void region_set_cell_run(
+    Sector** sector,
+    SectorCoordinate sector_coordinate,
+    CellIndex first_cell_index,
+    u32 cell_count,
+    CellType cell_type
+) {
+    if (!*sector)
+    {
+        *sector = sector_create(sector_coordinate);
+    }
+
+    sector_set_cell_run(*sector, first_cell_index, cell_count, cell_type);
+}
+
+// Decodes a saved sector straight from the mapping. Returns false when the
+// sector was never saved, and stores NULL when all of its cells are air.
+
+bool region_load_sector(Region* region, SectorCoordinate sector_coordinate, Sector** out_sector)
+{
+    *out_sector = NULL;
+
+    const RegionEntry* entry = region_get_entry(region, sector_coordinate);
+
+    if (!entry)
+    {
+        return false;
+    }
+
+    if ((size_t)entry->offset + entry->length > region->mapped_size)
+    {
+        LOG_WARN("Ignoring sector past the end of region: %s", region->path);
+
+        return false;
+    }
+
+    const u8* entry_data = region->mapped_data + entry->offset;
+
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+
+    Sector* sector = NULL;
+
+    if (entry->encoding == REGION_ENCODING_RAW && entry->length == sizeof(CellType) * sector_volume_in_cells)
+    {
+        sector = sector_create(sector_coordinate);
+
+        sector_set_cell_array(sector, (const CellType*)entry_data);
+
+        if (sector_is_empty(sector))
+        {
+            sector_destroy(sector);
+
+            sector = NULL;
+        }
+    }
+    else if (entry->encoding == REGION_ENCODING_RLE && entry->length % sizeof(RegionCellRun) == 0)
+    {
+        const RegionCellRun* cell_run_array = (const RegionCellRun*)entry_data;
+        const u32 cell_run_count = entry->length / sizeof(RegionCellRun);
+
+        CellIndex cell_index = 0;
+
+        for (u32 cell_run_index = 0; cell_run_index < cell_run_count; ++cell_run_index)
+        {
+            const RegionCellRun* cell_run = &cell_run_array[cell_run_index];
+
+            if (cell_index + cell_run->run_length > sector_volume_in_cells)
+            {
+                break;
+            }
+
+            if (cell_run->cell_type != CELL_TYPE_AIR)
+            {
+                region_set_cell_run(&sector, sector_coordinate, cell_index, cell_run->run_length, cell_run->cell_type);
+            }
+
+            cell_index += cell_run->run_length;
+        }
+
+        if (cell_index != sector_volume_in_cells)
+        {
+            LOG_WARN("Ignoring corrupt sector in region: %s", region->path);
+
+            if (sector)
+            {
+                sector_destroy(sector);
+            }
+
+            return false;
+        }
+    }
+    else
+    {
+        LOG_WARN("Ignoring sector with unknown encoding in region: %s", region->path);
+
+        return false;
+    }
+
+    *out_sector = sector;
+
+    return true;
+}
+
+// Saves the cells of a sector, or an all air sector when sector is NULL. The
+// sector is run-length encoded unless the raw cells are smaller.
+
+void region_save_sector(Region* region, SectorCoordinate sector_coordinate, Sector* sector)
+{
+    if (region->file_descriptor < 0 && !region_create_file(region))
+    {
+        return;
+    }
+
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+
+    RegionCellRun cell_run_array[REGION_MAX_CELL_COUNT];
+    u32 cell_run_count = 0;
+
+    for (CellIndex cell_index = 0; cell_index < sector_volume_in_cells; ++cell_index)
+    {
+        const CellType cell_type = sector ? sector_get_cell(sector, cell_index) : CELL_TYPE_AIR;
+
+        if (cell_run_count > 0 && cell_run_array[cell_run_count - 1].cell_type == cell_type)
+        {
+            cell_run_array[cell_run_count - 1].run_length++;
+        }
+        else
+        {
+            cell_run_array[cell_run_count].cell_type = cell_type;
+            cell_run_array[cell_run_count].run_length = 1;
+
+            cell_run_count++;
+        }
+    }
+
+    RegionEntry entry;
+
+    const void* entry_data = cell_run_array;
+
+    entry.encoding = REGION_ENCODING_RLE;
+    entry.length = sizeof(RegionCellRun) * cell_run_count;
+
+    CellType cell_type_array[REGION_MAX_CELL_COUNT];
+
+    if (entry.length > sizeof(CellType) * sector_volume_in_cells)
+    {
+        for (CellIndex cell_index = 0; cell_index < sector_volume_in_cells; ++cell_index)
+        {
+            cell_type_array[cell_index] = sector_get_cell(sector, cell_index);
+        }
+
+        entry_data = cell_type_array;
+
+        entry.encoding = REGION_ENCODING_RAW;
+        entry.length = sizeof(CellType) * sector_volume_in_cells;
+    }
+
+    // The sector reuses its previous slot when it fits the slot's capacity,
+    // so a sector saved over and over does not grow the file
+
+    const u32 entry_index = sector_coordinate_to_region_entry_index(sector_coordinate);
+    const RegionEntry* previous_entry = region->mapped_data ? &region_get_header(region)->entry_array[entry_index] : NULL;
+
+    if (previous_entry && previous_entry->length > 0 && entry.length <= previous_entry->capacity)
+    {
+        entry.offset = previous_entry->offset;
+        entry.capacity = previous_entry->capacity;
+    }
+    else
+    {
+        entry.offset = (u32)((region->file_size + 3) & ~(size_t)3);
+        entry.capacity = entry.length;
+    }
+
+    if (pwrite(region->file_descriptor, entry_data, entry.length, entry.offset) != (ssize_t)entry.length)
+    {
+        LOG_ERROR("Failed to write sector to region: %s", region->path);
+
+        return;
+    }
+
+    // The entry is written last, so a failed write into a new slot leaves
+    // the previous cells of the sector in place. A failed write into the
+    // previous slot leaves them partly overwritten.
+
+    const off_t entry_offset = (off_t)(offsetof(RegionHeader, entry_array) + sizeof(RegionEntry) * entry_index);
+
+    if (pwrite(region->file_descriptor, &entry, sizeof(entry), entry_offset) != (ssize_t)sizeof(entry))
+    {
+        LOG_ERROR("Failed to write region entry: %s", region->path);
+
+        return;
+    }
+
+    if ((size_t)entry.offset + entry.length > region->file_size)
+    {
+        region->file_size = (size_t)entry.offset + entry.length;
+
+        region_map(region);
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef REGION_H
+#define REGION_H 1
+
+#include <stddef.h>
+
+#include "core/types.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+
+// Sectors are persisted in region files that each hold a cube of
+// REGION_SIZE_IN_SECTORS sectors per axis. A region file starts with a fixed
+// header whose entry table gives the offset, length, slot capacity and
+// encoding of every sector of the region. A saved sector is written in place
+// when it fits the capacity of its previous slot and appended in a new slot
+// otherwise, then its entry is rewritten.
+//
+// Region files are read through a shared mapping, so loading a sector is an
+// entry lookup and a decode straight from the mapped pages.
+
+#define REGION_SIZE_IN_SECTORS_LOG2 3
+#define REGION_SIZE_IN_SECTORS      (1 << REGION_SIZE_IN_SECTORS_LOG2)
+#define REGION_VOLUME_IN_SECTORS    (REGION_SIZE_IN_SECTORS * REGION_SIZE_IN_SECTORS * REGION_SIZE_IN_SECTORS)
+
+#define REGION_MAGIC                0x4e474552u
+#define REGION_VERSION              1
+
+#define REGION_PATH_CAPACITY        256
+
+#define REGION_MAX_CELL_COUNT       (SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS)
+
+typedef ivec3 RegionCoordinate;
+
+// Files are written in native byte order. Cells are stored in cell index
+// order, so the header records the sector size and cell layout the file was
+// written with and a mismatching file is ignored.
+
+typedef enum RegionEncoding
+{
+    REGION_ENCODING_NONE,
+    REGION_ENCODING_RAW,
+    REGION_ENCODING_RLE,
+}
+RegionEncoding;
+
+typedef enum RegionCellLayout
+{
+    REGION_CELL_LAYOUT_LINEAR,
+    REGION_CELL_LAYOUT_MORTON,
+}
+RegionCellLayout;
+
+// An entry with zero length is a sector that was never saved. The capacity
+// is the size of the slot at the offset, which stays the same when a
+// shorter sector is saved into it.
+
+typedef struct RegionEntry
+{
+    u32 offset;
+    u32 length;
+    u32 capacity;
+    u32 encoding;
+}
+RegionEntry;
+
+typedef struct RegionHeader
+{
+    u32 magic;
+    u32 version;
+
+    u32 sector_size_in_cells;
+    u32 cell_layout;
+
+    RegionCoordinate coordinate;
+
+    RegionEntry entry_array[REGION_VOLUME_IN_SECTORS];
+}
+RegionHeader;
+
+// Run-length encoded cells are a sequence of runs covering the sector
+
+typedef struct RegionCellRun
+{
+    CellType cell_type;
+    u16 run_length;
+}
+RegionCellRun;
+
+_Static_assert(REGION_MAX_CELL_COUNT <= 0xffff, "Sector volume exceeds the cell run length range");
+
+// A region without a file on disk has no descriptor and no mapping until its
+// first sector is saved
+
+typedef struct Region
+{
+    RegionCoordinate coordinate;
+
+    char path[REGION_PATH_CAPACITY];
+
+    int file_descriptor;
+
+    size_t file_size;
+
+    size_t mapped_size;
+    const u8* mapped_data;
+}
+Region;
+
+Region* region_open(const char* directory, RegionCoordinate region_coordinate);
+void region_close(Region* region);
+
+bool region_has_sector(Region* region, SectorCoordinate sector_coordinate);
+
+bool region_load_sector(Region* region, SectorCoordinate sector_coordinate, Sector** out_sector);
+void region_save_sector(Region* region, SectorCoordinate sector_coordinate, Sector* sector);
+
+static inline void sector_coordinate_to_region_coordinate(SectorCoordinate sector_coordinate, RegionCoordinate out_region_coordinate)
+{
+    out_region_coordinate[0] = sector_coordinate[0] >> REGION_SIZE_IN_SECTORS_LOG2;
+    out_region_coordinate[1] = sector_coordinate[1] >> REGION_SIZE_IN_SECTORS_LOG2;
+    out_region_coordinate[2] = sector_coordinate[2] >> REGION_SIZE_IN_SECTORS_LOG2;
+}
+
+static inline u32 sector_coordinate_to_region_entry_index(SectorCoordinate sector_coordinate)
+{
+    const i32 region_mask = REGION_SIZE_IN_SECTORS - 1;
+
+    return
+        (u32)(sector_coordinate[0] & region_mask) +
+        (u32)(sector_coordinate[1] & region_mask) * REGION_SIZE_IN_SECTORS +
+        (u32)(sector_coordinate[2] & region_mask) * REGION_SIZE_IN_SECTORS * REGION_SIZE_IN_SECTORS;
+}
+
+#endif
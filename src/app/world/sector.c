@@ -0,0 +1,420 @@
+#include "app/world/sector.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/log/log.h"
+
+_Static_assert(
+    SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS < (1 << SECTOR_MAX_BITS_PER_CELL),
+    "Sector volume exceeds the widest palette"
+);
+
+static u32 sector_get_bits_for_palette_count(u32 palette_count)
+{
+    u32 bits_per_cell = SECTOR_MIN_BITS_PER_CELL;
+
+    while ((1u << bits_per_cell) < palette_count)
+    {
+        bits_per_cell *= 2;
+    }
+
+    return bits_per_cell;
+}
+
+static u32 sector_get_word_count(u32 bits_per_cell)
+{
+    const u32 cells_per_word = 64 / bits_per_cell;
+
+    return (get_sector_volume_in_cells() + cells_per_word - 1) / cells_per_word;
+}
+
+static inline u32 sector_read_palette_index(const u64* word_array, u32 bits_per_cell, CellIndex cell_index)
+{
+    const u32 bits_per_cell_log2 = (u32)__builtin_ctz(bits_per_cell);
+    const u32 cells_per_word_log2 = 6 - bits_per_cell_log2;
+
+    const u32 word_index = cell_index >> cells_per_word_log2;
+    const u32 shift = (cell_index & ((1u << cells_per_word_log2) - 1)) << bits_per_cell_log2;
+
+    const u64 mask = (1ull << bits_per_cell) - 1;
+
+    return (u32)((word_array[word_index] >> shift) & mask);
+}
+
+static inline void sector_write_palette_index(u64* word_array, u32 bits_per_cell, CellIndex cell_index, u32 palette_index)
+{
+    const u32 bits_per_cell_log2 = (u32)__builtin_ctz(bits_per_cell);
+    const u32 cells_per_word_log2 = 6 - bits_per_cell_log2;
+
+    const u32 word_index = cell_index >> cells_per_word_log2;
+    const u32 shift = (cell_index & ((1u << cells_per_word_log2) - 1)) << bits_per_cell_log2;
+
+    const u64 mask = (1ull << bits_per_cell) - 1;
+
+    word_array[word_index] = (word_array[word_index] & ~(mask << shift)) | ((u64)palette_index << shift);
+}
+
+static void sector_resize_palette(Sector* sector, u32 palette_capacity)
+{
+    sector->palette_array = realloc(sector->palette_array, sizeof(CellType) * palette_capacity);
+    sector->palette_reference_count_array = realloc(sector->palette_reference_count_array, sizeof(u32) * palette_capacity);
+
+    if (!sector->palette_array || !sector->palette_reference_count_array)
+    {
+        LOG_FATAL("Failed to allocate sector palette");
+    }
+
+    sector->palette_capacity = palette_capacity;
+}
+
+static void sector_repack(Sector* sector, u32 bits_per_cell, const u32* palette_remap_array)
+{
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+    const u32 word_count = sector_get_word_count(bits_per_cell);
+
+    u64* word_array = calloc(word_count, sizeof(u64));
+
+    if (!word_array)
+    {
+        LOG_FATAL("Failed to allocate sector cells");
+    }
+
+    for (CellIndex cell_index = 0; cell_index < sector_volume_in_cells; ++cell_index)
+    {
+        u32 palette_index = sector_read_palette_index(sector->word_array, sector->bits_per_cell, cell_index);
+
+        if (palette_remap_array)
+        {
+            palette_index = palette_remap_array[palette_index];
+        }
+
+        sector_write_palette_index(word_array, bits_per_cell, cell_index, palette_index);
+    }
+
+    free(sector->word_array);
+
+    sector->word_array = word_array;
+    sector->word_count = word_count;
+    sector->bits_per_cell = bits_per_cell;
+}
+
+static u32 sector_acquire_palette_index(Sector* sector, CellType cell_type)
+{
+    u32 free_palette_index = UINT32_MAX;
+
+    for (u32 palette_index = 0; palette_index < sector->palette_count; ++palette_index)
+    {
+        if (sector->palette_reference_count_array[palette_index] == 0)
+        {
+            if (free_palette_index == UINT32_MAX)
+            {
+                free_palette_index = palette_index;
+            }
+        }
+        else if (sector->palette_array[palette_index] == cell_type)
+        {
+            return palette_index;
+        }
+    }
+
+    if (free_palette_index == UINT32_MAX)
+    {
+        free_palette_index = sector->palette_count;
+
+        sector->palette_count++;
+
+        if (sector->palette_count > sector->palette_capacity)
+        {
+            sector_resize_palette(sector, 2 * sector->palette_capacity);
+        }
+
+        if (sector->palette_count > (1u << sector->bits_per_cell))
+        {
+            sector_repack(sector, 2 * sector->bits_per_cell, NULL);
+        }
+    }
+
+    sector->palette_array[free_palette_index] = cell_type;
+    sector->palette_reference_count_array[free_palette_index] = 0;
+    sector->palette_live_count++;
+
+    return free_palette_index;
+}
+
+static void sector_compact_palette(Sector* sector)
+{
+    u32* palette_remap_array = malloc(sizeof(u32) * sector->palette_count);
+
+    if (!palette_remap_array)
+    {
+        LOG_FATAL("Failed to allocate sector palette remap");
+    }
+
+    u32 palette_count = 0;
+
+    for (u32 palette_index = 0; palette_index < sector->palette_count; ++palette_index)
+    {
+        if (sector->palette_reference_count_array[palette_index] == 0)
+        {
+            continue;
+        }
+
+        sector->palette_array[palette_count] = sector->palette_array[palette_index];
+        sector->palette_reference_count_array[palette_count] = sector->palette_reference_count_array[palette_index];
+
+        palette_remap_array[palette_index] = palette_count;
+        palette_count++;
+    }
+
+    const u32 bits_per_cell = sector_get_bits_for_palette_count(palette_count);
+
+    sector_repack(sector, bits_per_cell, palette_remap_array);
+    sector_resize_palette(sector, palette_count > 2 ? palette_count : 2);
+
+    sector->palette_count = palette_count;
+
+    free(palette_remap_array);
+}
+
+Sector* sector_create(SectorCoordinate sector_coordinate)
+{
+    Sector* sector = malloc(sizeof(*sector));
+
+    if (!sector)
+    {
+        LOG_FATAL("Failed to allocate sector");
+    }
+
+    glm_ivec3_copy(sector_coordinate, sector->coordinate);
+
+    sector->solid_cell_count = 0;
+
+    sector->bits_per_cell = SECTOR_MIN_BITS_PER_CELL;
+
+    sector->palette_array = NULL;
+    sector->palette_reference_count_array = NULL;
+
+    sector_resize_palette(sector, 1u << SECTOR_MIN_BITS_PER_CELL);
+
+    sector->palette_count = 1;
+    sector->palette_live_count = 1;
+
+    sector->palette_array[0] = CELL_TYPE_AIR;
+    sector->palette_reference_count_array[0] = get_sector_volume_in_cells();
+
+    sector->word_count = sector_get_word_count(SECTOR_MIN_BITS_PER_CELL);
+    sector->word_array = calloc(sector->word_count, sizeof(u64));
+
+    if (!sector->word_array)
+    {
+        LOG_FATAL("Failed to allocate sector cells");
+    }
+
+    return sector;
+}
+
+void sector_destroy(Sector* sector)
+{
+    free(sector->word_array);
+    free(sector->palette_reference_count_array);
+    free(sector->palette_array);
+    free(sector);
+}
+
+bool sector_is_empty(Sector* sector)
+{
+    return sector->solid_cell_count == 0;
+}
+
+bool sector_is_full(Sector* sector)
+{
+    return sector->solid_cell_count == get_sector_volume_in_cells();
+}
+
+u32 sector_get_solid_face_mask(Sector* sector)
+{
+    if (sector_is_full(sector))
+    {
+        return (1u << GRID_DIRECTION_COUNT) - 1;
+    }
+
+    if (sector->solid_cell_count < get_sector_area_in_cells())
+    {
+        return 0;
+    }
+
+    u32 solid_face_mask = 0;
+
+    for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+    {
+        const u32 axis = direction / 2;
+        const u32 u_axis = (axis + 1) % 3;
+        const u32 v_axis = (axis + 2) % 3;
+
+        CellCoordinate cell_coordinate;
+        cell_coordinate[axis] = direction & 1 ? SECTOR_MIN_CELL : SECTOR_MAX_CELL;
+
+        bool is_solid = true;
+
+        for (i32 v = SECTOR_MIN_CELL; v <= SECTOR_MAX_CELL && is_solid; ++v)
+        {
+            cell_coordinate[v_axis] = v;
+
+            for (i32 u = SECTOR_MIN_CELL; u <= SECTOR_MAX_CELL; ++u)
+            {
+                cell_coordinate[u_axis] = u;
+
+                if (sector_get_cell(sector, cell_coordinate_to_cell_index(cell_coordinate)) == CELL_TYPE_AIR)
+                {
+                    is_solid = false;
+
+                    break;
+                }
+            }
+        }
+
+        if (is_solid)
+        {
+            solid_face_mask |= 1u << direction;
+        }
+    }
+
+    return solid_face_mask;
+}
+
+CellType sector_get_cell(Sector* sector, CellIndex cell_index)
+{
+    const u32 palette_index = sector_read_palette_index(sector->word_array, sector->bits_per_cell, cell_index);
+
+    return sector->palette_array[palette_index];
+}
+
+void sector_set_cell(Sector* sector, CellIndex cell_index, CellType cell_type)
+{
+    const u32 previous_palette_index = sector_read_palette_index(sector->word_array, sector->bits_per_cell, cell_index);
+    const CellType previous_cell_type = sector->palette_array[previous_palette_index];
+
+    if (previous_cell_type == cell_type)
+    {
+        return;
+    }
+
+    if (previous_cell_type == CELL_TYPE_AIR)
+    {
+        sector->solid_cell_count++;
+    }
+    else if (cell_type == CELL_TYPE_AIR)
+    {
+        sector->solid_cell_count--;
+    }
+
+    const u32 palette_index = sector_acquire_palette_index(sector, cell_type);
+
+    sector_write_palette_index(sector->word_array, sector->bits_per_cell, cell_index, palette_index);
+
+    sector->palette_reference_count_array[palette_index]++;
+    sector->palette_reference_count_array[previous_palette_index]--;
+
+    if (sector->palette_reference_count_array[previous_palette_index] == 0)
+    {
+        sector->palette_live_count--;
+
+        // Narrowing waits until the live entries fit in a quarter of the
+        // width, so a type added and removed again across a width boundary
+        // does not repack every cell twice
+
+        if (
+            sector->bits_per_cell > SECTOR_MIN_BITS_PER_CELL &&
+            sector->palette_live_count <= (1u << (sector->bits_per_cell / 4))
+        ) {
+            sector_compact_palette(sector);
+        }
+    }
+}
+
+// Sets cell_count consecutive cells to one cell type. The palette entry is
+// looked up once and the palette is only compacted after the whole run.
+
+void sector_set_cell_run(Sector* sector, CellIndex first_cell_index, u32 cell_count, CellType cell_type)
+{
+    if (cell_count == 0)
+    {
+        return;
+    }
+
+    const u32 palette_index = sector_acquire_palette_index(sector, cell_type);
+
+    bool is_palette_entry_released = false;
+
+    for (CellIndex cell_index = first_cell_index; cell_index < first_cell_index + cell_count; ++cell_index)
+    {
+        const u32 previous_palette_index = sector_read_palette_index(sector->word_array, sector->bits_per_cell, cell_index);
+
+        if (previous_palette_index == palette_index)
+        {
+            continue;
+        }
+
+        if (sector->palette_array[previous_palette_index] == CELL_TYPE_AIR)
+        {
+            sector->solid_cell_count++;
+        }
+        else if (cell_type == CELL_TYPE_AIR)
+        {
+            sector->solid_cell_count--;
+        }
+
+        sector_write_palette_index(sector->word_array, sector->bits_per_cell, cell_index, palette_index);
+
+        sector->palette_reference_count_array[palette_index]++;
+        sector->palette_reference_count_array[previous_palette_index]--;
+
+        if (sector->palette_reference_count_array[previous_palette_index] == 0)
+        {
+            sector->palette_live_count--;
+
+            is_palette_entry_released = true;
+        }
+    }
+
+    // Narrows at the same quarter-width threshold as sector_set_cell
+
+    if (
+        is_palette_entry_released &&
+        sector->bits_per_cell > SECTOR_MIN_BITS_PER_CELL &&
+        sector->palette_live_count <= (1u << (sector->bits_per_cell / 4))
+    ) {
+        sector_compact_palette(sector);
+    }
+}
+
+// Sets every cell from an array in cell index order, one run of equal cells
+// at a time
+
+void sector_set_cell_array(Sector* sector, const CellType* cell_type_array)
+{
+    const u32 sector_volume_in_cells = get_sector_volume_in_cells();
+
+    CellIndex run_start_cell_index = 0;
+
+    for (CellIndex cell_index = 1; cell_index <= sector_volume_in_cells; ++cell_index)
+    {
+        if (cell_index < sector_volume_in_cells && cell_type_array[cell_index] == cell_type_array[run_start_cell_index])
+        {
+            continue;
+        }
+
+        sector_set_cell_run(sector, run_start_cell_index, cell_index - run_start_cell_index, cell_type_array[run_start_cell_index]);
+
+        run_start_cell_index = cell_index;
+    }
+}
+
+size_t sector_get_memory_size(Sector* sector)
+{
+    return
+        sizeof(*sector) +
+        sector->palette_capacity * (sizeof(CellType) + sizeof(u32)) +
+        sector->word_count * sizeof(u64);
+}
@@ -0,0 +1,59 @@
+#ifndef SECTOR_H
+#define SECTOR_H 1
+
+#include "core/types.h"
+#include "app/world/grid.h"
+
+typedef u16 CellType;
+
+#define CELL_TYPE_AIR 0
+#define CELL_TYPE_STONE 1
+#define CELL_TYPE_GRASS 2
+#define CELL_TYPE_TORCH 3
+
+// Cells are stored as indices into a per-sector palette of cell types. The
+// indices are bit-packed into 64-bit words at 1, 2, 4, 8 or 16 bits per cell,
+// widened when the palette outgrows them and narrowed again once the
+// referenced entries fit in a quarter of the width.
+
+#define SECTOR_MIN_BITS_PER_CELL 1
+#define SECTOR_MAX_BITS_PER_CELL 16
+
+typedef struct Sector
+{
+    SectorCoordinate coordinate;
+
+    u32 solid_cell_count;
+
+    u32 bits_per_cell;
+
+    u32 palette_count;
+    u32 palette_capacity;
+    u32 palette_live_count;
+
+    CellType* palette_array;
+    u32* palette_reference_count_array;
+
+    u32 word_count;
+    u64* word_array;
+}
+Sector;
+
+Sector* sector_create(SectorCoordinate sector_coordinate);
+void sector_destroy(Sector* sector);
+
+bool sector_is_empty(Sector* sector);
+bool sector_is_full(Sector* sector);
+
+// A bit per GridDirection whose boundary layer of cells is all solid
+
+u32 sector_get_solid_face_mask(Sector* sector);
+
+CellType sector_get_cell(Sector* sector, CellIndex cell_index);
+void sector_set_cell(Sector* sector, CellIndex cell_index, CellType cell_type);
+void sector_set_cell_run(Sector* sector, CellIndex first_cell_index, u32 cell_count, CellType cell_type);
+void sector_set_cell_array(Sector* sector, const CellType* cell_type_array);
+
+size_t sector_get_memory_size(Sector* sector);
+
+#endif
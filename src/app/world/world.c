@@ -1,26 +1,433 @@
 #include "app/world/world.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "app/camera.h"
+#include "core/core.h"
 #include "core/log/log.h"
 #include "platform/platform.h"
 
-World* world_create(void)
+static u32 world_get_sector_mask_count(void)
+{
+    return (get_world_volume_in_sectors() + 63) / 64;
+}
+
+static inline bool world_sector_mask_get(const u64* sector_mask_array, SectorIndex sector_index)
+{
+    return (sector_mask_array[sector_index / 64] >> (sector_index % 64)) & 1;
+}
+
+static inline void world_sector_mask_set(u64* sector_mask_array, SectorIndex sector_index, bool value)
+{
+    const u64 sector_bit = 1ull << (sector_index % 64);
+
+    if (value)
+    {
+        sector_mask_array[sector_index / 64] |= sector_bit;
+    }
+    else
+    {
+        sector_mask_array[sector_index / 64] &= ~sector_bit;
+    }
+}
+
+// Returns the region holding the sector, opening it in place of the oldest
+// cached region when it is not cached yet
+
+static Region* world_get_region(World* world, SectorCoordinate sector_coordinate)
+{
+    RegionCoordinate region_coordinate;
+    sector_coordinate_to_region_coordinate(sector_coordinate, region_coordinate);
+
+    for (u32 region_cache_index = 0; region_cache_index < WORLD_REGION_CACHE_SIZE; ++region_cache_index)
+    {
+        Region* region = world->region_cache_array[region_cache_index];
+
+        if (
+            region &&
+            region->coordinate[0] == region_coordinate[0] &&
+            region->coordinate[1] == region_coordinate[1] &&
+            region->coordinate[2] == region_coordinate[2]
+        ) {
+            return region;
+        }
+    }
+
+    Region** region_slot = &world->region_cache_array[world->region_cache_index];
+
+    world->region_cache_index = (world->region_cache_index + 1) % WORLD_REGION_CACHE_SIZE;
+
+    if (*region_slot)
+    {
+        region_close(*region_slot);
+    }
+
+    *region_slot = region_open(world->region_directory, region_coordinate);
+
+    return *region_slot;
+}
+
+// Writes a sector edited since it was loaded back to its region, unless the
+// world is not saved
+
+static void world_save_sector(World* world, SectorIndex sector_index)
+{
+    if (!world->region_directory || !world_sector_mask_get(world->modified_sector_mask_array, sector_index))
+    {
+        return;
+    }
+
+    SectorCoordinate sector_coordinate;
+    sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+    region_save_sector(world_get_region(world, sector_coordinate), sector_coordinate, world->sector_array[sector_index]);
+
+    world_sector_mask_set(world->modified_sector_mask_array, sector_index, false);
+}
+
+// The faces, corner occlusion and light of the loaded neighbors of a sector
+// along their shared boundary change whenever the sector is loaded or
+// unloaded
+
+static void world_mark_neighbor_sectors_dirty(World* world, SectorIndex sector_index)
+{
+    SectorCoordinate sector_coordinate;
+    sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+    for (u32 neighborhood_index = 0; neighborhood_index < GRID_NEIGHBORHOOD_COUNT; ++neighborhood_index)
+    {
+        if (neighborhood_index == GRID_NEIGHBORHOOD_CENTER)
+        {
+            continue;
+        }
+
+        i32 offset[3];
+        grid_neighborhood_index_to_offset(neighborhood_index, offset);
+
+        SectorCoordinate neighbor_sector_coordinate;
+        glm_ivec3_add(sector_coordinate, offset, neighbor_sector_coordinate);
+
+        if (!sector_coordinate_is_valid(neighbor_sector_coordinate, world->window_sector_coordinate))
+        {
+            continue;
+        }
+
+        const SectorIndex neighbor_sector_index = sector_coordinate_to_sector_index(neighbor_sector_coordinate);
+
+        if (world_sector_is_loaded(world, neighbor_sector_index))
+        {
+            world_mark_sector_dirty(world, neighbor_sector_index);
+        }
+    }
+}
+
+// Runs before the window moves, so neighbors are those of the window the
+// sector leaves
+
+static void world_unload_sector(World* world, SectorIndex sector_index)
+{
+    world_save_sector(world, sector_index);
+
+    Sector* sector = world->sector_array[sector_index];
+
+    if (sector)
+    {
+        sector_destroy(sector);
+
+        world->sector_array[sector_index] = NULL;
+        world->sector_count--;
+    }
+
+    if (world_sector_mask_get(world->loaded_sector_mask_array, sector_index))
+    {
+        world_sector_mask_set(world->loaded_sector_mask_array, sector_index, false);
+        world_mark_sector_dirty(world, sector_index);
+
+        world_mark_neighbor_sectors_dirty(world, sector_index);
+
+        light_clear_sector(world->light, sector_index);
+    }
+}
+
+// Installs a loaded sector, which may be NULL when all of its cells are air,
+// and floods it with light
+
+static void world_install_sector(World* world, SectorIndex sector_index, Sector* sector)
+{
+    if (sector)
+    {
+        world->sector_array[sector_index] = sector;
+        world->sector_count++;
+    }
+
+    world_sector_mask_set(world->loaded_sector_mask_array, sector_index, true);
+    world_mark_sector_dirty(world, sector_index);
+
+    world_mark_neighbor_sectors_dirty(world, sector_index);
+
+    light_install_sector(world, sector_index);
+}
+
+// Loads up to max_load_count queued sectors. Saved sectors are decoded from
+// their regions in queue order, the others are generated in parallel on the
+// job system and installed afterwards. Returns the number of sectors loaded
+// from regions.
+
+static u32 world_load_queued_sectors(World* world, u32 max_load_count)
+{
+    const u32 first_load_request_index = world->load_request_index;
+
+    u32 saved_sector_count = 0;
+    u32 generator_job_count = 0;
+
+    while (
+        world->load_request_index < world->load_request_count &&
+        world->load_request_index - first_load_request_index < max_load_count
+    ) {
+        const SectorIndex sector_index = world->load_request_array[world->load_request_index++].sector_index;
+
+        SectorCoordinate sector_coordinate;
+        sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+        Sector* sector;
+
+        if (
+            world->region_directory &&
+            region_load_sector(world_get_region(world, sector_coordinate), sector_coordinate, &sector)
+        ) {
+            world_install_sector(world, sector_index, sector);
+
+            saved_sector_count++;
+
+            continue;
+        }
+
+        GeneratorJob* generator_job = &world->generator_job_array[generator_job_count];
+
+        generator_job->generator = &world->generator;
+        glm_ivec3_copy(sector_coordinate, generator_job->sector_coordinate);
+        generator_job->sector = NULL;
+
+        Job* job = &world->job_array[generator_job_count];
+
+        job->function = generator_run_job;
+        job->data = generator_job;
+
+        generator_job_count++;
+    }
+
+    // A single sector is cheaper to generate in place than to hand to a
+    // worker
+
+    if (generator_job_count == 1)
+    {
+        generator_run_job(world->job_array[0].data);
+    }
+    else if (generator_job_count > 1)
+    {
+        job_system_submit(world->job_system, world->job_array, generator_job_count, &world->job_counter);
+        job_system_wait(world->job_system, &world->job_counter);
+    }
+
+    u32 generator_job_index = 0;
+
+    for (u32 load_request_index = first_load_request_index; load_request_index < world->load_request_index; ++load_request_index)
+    {
+        const SectorIndex sector_index = world->load_request_array[load_request_index].sector_index;
+
+        if (world_sector_is_loaded(world, sector_index))
+        {
+            continue;
+        }
+
+        world_install_sector(world, sector_index, world->generator_job_array[generator_job_index++].sector);
+    }
+
+    return saved_sector_count;
+}
+
+static int world_compare_load_requests(const void* a, const void* b)
+{
+    const WorldLoadRequest* load_request_a = a;
+    const WorldLoadRequest* load_request_b = b;
+
+    return (load_request_a->distance_squared > load_request_b->distance_squared) - (load_request_a->distance_squared < load_request_b->distance_squared);
+}
+
+// Queues every unloaded sector of the window, nearest to the camera first
+
+static void world_queue_load_requests(World* world)
+{
+    const u32 world_volume_in_sectors = get_world_volume_in_sectors();
+
+    world->load_request_count = 0;
+    world->load_request_index = 0;
+
+    for (SectorIndex sector_index = 0; sector_index < world_volume_in_sectors; ++sector_index)
+    {
+        if (world_sector_is_loaded(world, sector_index))
+        {
+            continue;
+        }
+
+        SectorCoordinate sector_coordinate;
+        sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+        SectorCoordinate sector_offset;
+        glm_ivec3_sub(sector_coordinate, world->window_sector_coordinate, sector_offset);
+
+        WorldLoadRequest* load_request = &world->load_request_array[world->load_request_count++];
+
+        load_request->distance_squared = (u32)(
+            sector_offset[0] * sector_offset[0] +
+            sector_offset[1] * sector_offset[1] +
+            sector_offset[2] * sector_offset[2]
+        );
+        load_request->sector_index = sector_index;
+    }
+
+    qsort(world->load_request_array, world->load_request_count, sizeof(WorldLoadRequest), world_compare_load_requests);
+}
+
+World* world_create(const char* region_directory)
 {
     World* world = malloc(sizeof(*world));
 
+    if (!world)
+    {
+        LOG_FATAL("Failed to allocate world");
+    }
+
+    world->region_directory = region_directory;
+
+    generator_init(&world->generator, WORLD_GENERATOR_SEED);
+
+    world->job_system = NULL;
+
+    memset(&world->camera_hit, 0, sizeof(world->camera_hit));
+
+    glm_ivec3_zero(world->window_sector_coordinate);
+
+    world->sector_count = 0;
+    world->sector_array = calloc(get_world_volume_in_sectors(), sizeof(Sector*));
+
+    world->loaded_sector_mask_array = calloc(world_get_sector_mask_count(), sizeof(u64));
+
+    world->light = light_create();
+
+    world->modified_sector_mask_array = calloc(world_get_sector_mask_count(), sizeof(u64));
+
+    world->region_cache_index = 0;
+    memset(world->region_cache_array, 0, sizeof(world->region_cache_array));
+
+    world->load_request_count = 0;
+    world->load_request_index = 0;
+    world->load_request_array = malloc(sizeof(WorldLoadRequest) * get_world_volume_in_sectors());
+
+    atomic_init(&world->job_counter.value, 0);
+
+    world->job_array = malloc(sizeof(Job) * get_world_volume_in_sectors());
+    world->generator_job_array = malloc(sizeof(GeneratorJob) * get_world_volume_in_sectors());
+
+    world->dirty_sector_mask_array = calloc(world_get_sector_mask_count(), sizeof(u64));
+
+    world->dirty_sector_count = 0;
+    world->dirty_sector_index_array = malloc(sizeof(SectorIndex) * get_world_volume_in_sectors());
+
+    if (
+        !world->sector_array ||
+        !world->loaded_sector_mask_array ||
+        !world->modified_sector_mask_array ||
+        !world->load_request_array ||
+        !world->job_array ||
+        !world->generator_job_array ||
+        !world->dirty_sector_mask_array ||
+        !world->dirty_sector_index_array
+    ) {
+        LOG_FATAL("Failed to allocate world");
+    }
+
+    // Without a save directory regions fail to open and every sector is
+    // generated
+
+    if (region_directory)
+    {
+        create_directory(region_directory);
+    }
+
     return world;
 }
 
 void world_destroy(World* world)
 {
+    const u32 world_volume_in_sectors = get_world_volume_in_sectors();
+
+    for (SectorIndex sector_index = 0; sector_index < world_volume_in_sectors; ++sector_index)
+    {
+        world_save_sector(world, sector_index);
+
+        if (world->sector_array[sector_index])
+        {
+            sector_destroy(world->sector_array[sector_index]);
+        }
+    }
+
+    for (u32 region_cache_index = 0; region_cache_index < WORLD_REGION_CACHE_SIZE; ++region_cache_index)
+    {
+        if (world->region_cache_array[region_cache_index])
+        {
+            region_close(world->region_cache_array[region_cache_index]);
+        }
+    }
+
+    free(world->dirty_sector_index_array);
+    free(world->dirty_sector_mask_array);
+
+    free(world->generator_job_array);
+    free(world->job_array);
+
+    free(world->load_request_array);
+    free(world->modified_sector_mask_array);
+
+    light_destroy(world->light);
+
+    free(world->loaded_sector_mask_array);
+
+    free(world->sector_array);
     free(world);
 }
 
-void world_init(World* world)
+static void world_get_camera_sector_coordinate(World* world, SectorCoordinate out_sector_coordinate)
 {
+    GridCoordinate camera_grid_coordinate;
+    world_position_to_grid_coordinate(world->camera.position, camera_grid_coordinate);
 
+    grid_coordinate_to_sector_coordinate(camera_grid_coordinate, out_sector_coordinate);
+}
+
+// Centers the window on the camera and loads the whole window up front
+
+void world_init(World* world, JobSystem* job_system)
+{
+    world->job_system = job_system;
+
+    camera_init(&world->camera);
+
+    world_get_camera_sector_coordinate(world, world->window_sector_coordinate);
+    world_queue_load_requests(world);
+
+    const f64 load_start_time = glfwGetTime();
+
+    const u32 saved_sector_count = world_load_queued_sectors(world, world->load_request_count);
+
+    LOG_INFO(
+        "World Loaded: %u sectors, %u from regions, in %.3f ms",
+        world->load_request_count,
+        saved_sector_count,
+        (glfwGetTime() - load_start_time) * 1e3
+    );
 }
 
 void world_update(World* world, Platform* platform, f64 delta_time)
@@ -82,7 +489,15 @@ void world_update(World* world, Platform* platform, f64 delta_time)
     glm_vec3_scale(up, input_value[2] * camera_speed * delta_time, velocity_up);
     glm_vec3_add(camera_position_delta, velocity_up, camera_position_delta);
 
-    glm_vec3_add(world->camera.position, camera_position_delta, world->camera.position);
+    const vec3 camera_half_extent = {WORLD_CAMERA_HALF_EXTENT, WORLD_CAMERA_HALF_EXTENT, WORLD_CAMERA_HALF_EXTENT};
+
+    Aabb camera_aabb;
+    aabb_from_center(world->camera.position, camera_half_extent, &camera_aabb);
+
+    PhysicsMove camera_move;
+    physics_move_aabb(world, &camera_aabb, camera_position_delta, &camera_move);
+
+    glm_vec3_add(world->camera.position, camera_move.displacement, world->camera.position);
 
     const f32 sensitivity = 12.0f;
 
@@ -104,4 +519,336 @@ void world_update(World* world, Platform* platform, f64 delta_time)
             world->camera.rotation_angles[1] - mouse_delta_y * sensitivity * delta_time
         );
     }
+
+    world_update_window(world);
+
+    world_load_queued_sectors(world, WORLD_MAX_SECTOR_LOADS_PER_FRAME);
+
+    // The left button removes the cell under the crosshair, the right button
+    // places stone and the middle button a torch against the face it points at
+
+    Ray camera_ray;
+    glm_vec3_copy(world->camera.position, camera_ray.origin);
+    camera_get_forward(&world->camera, camera_ray.direction);
+    camera_ray.max_distance = WORLD_PICK_DISTANCE;
+
+    raycast_trace(world, &camera_ray, &world->camera_hit);
+
+    if (world->camera_hit.is_hit)
+    {
+        if (platform_is_mouse_pressed(&platform->platform_input, GLFW_MOUSE_BUTTON_LEFT))
+        {
+            world_set_cell(world, world->camera_hit.grid_coordinate, CELL_TYPE_AIR);
+        }
+        else if (world->camera_hit.normal_direction != GRID_DIRECTION_COUNT)
+        {
+            GridCoordinate place_grid_coordinate;
+            glm_ivec3_add(
+                world->camera_hit.grid_coordinate,
+                (i32*)grid_direction_offset_array[world->camera_hit.normal_direction],
+                place_grid_coordinate
+            );
+
+            if (platform_is_mouse_pressed(&platform->platform_input, GLFW_MOUSE_BUTTON_RIGHT))
+            {
+                world_set_cell(world, place_grid_coordinate, CELL_TYPE_STONE);
+            }
+            else if (platform_is_mouse_pressed(&platform->platform_input, GLFW_MOUSE_BUTTON_MIDDLE))
+            {
+                world_set_cell(world, place_grid_coordinate, CELL_TYPE_TORCH);
+            }
+        }
+    }
+}
+
+// Moves the window onto the sector holding the camera. Sectors that leave the
+// window are evicted at once, which frees their index for the sector entering
+// on the opposite side, and the sectors left to load are queued again.
+
+void world_update_window(World* world)
+{
+    SectorCoordinate camera_sector_coordinate;
+    world_get_camera_sector_coordinate(world, camera_sector_coordinate);
+
+    if (
+        camera_sector_coordinate[0] == world->window_sector_coordinate[0] &&
+        camera_sector_coordinate[1] == world->window_sector_coordinate[1] &&
+        camera_sector_coordinate[2] == world->window_sector_coordinate[2]
+    ) {
+        return;
+    }
+
+    const u32 world_volume_in_sectors = get_world_volume_in_sectors();
+
+    for (SectorIndex sector_index = 0; sector_index < world_volume_in_sectors; ++sector_index)
+    {
+        SectorCoordinate sector_coordinate;
+        sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+        if (!sector_coordinate_is_valid(sector_coordinate, camera_sector_coordinate))
+        {
+            world_unload_sector(world, sector_index);
+        }
+    }
+
+    glm_ivec3_copy(camera_sector_coordinate, world->window_sector_coordinate);
+
+    world_queue_load_requests(world);
+}
+
+bool world_sector_is_loaded(World* world, SectorIndex sector_index)
+{
+    return world_sector_mask_get(world->loaded_sector_mask_array, sector_index);
+}
+
+Sector* world_get_sector(World* world, SectorIndex sector_index)
+{
+    if (!sector_index_is_valid(sector_index))
+    {
+        return NULL;
+    }
+
+    return world->sector_array[sector_index];
+}
+
+void world_get_neighbor_sector_array(World* world, SectorIndex sector_index, Sector** out_neighbor_sector_array)
+{
+    SectorCoordinate sector_coordinate;
+    sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+    for (u32 neighborhood_index = 0; neighborhood_index < GRID_NEIGHBORHOOD_COUNT; ++neighborhood_index)
+    {
+        i32 offset[3];
+        grid_neighborhood_index_to_offset(neighborhood_index, offset);
+
+        SectorCoordinate neighbor_sector_coordinate;
+        glm_ivec3_add(sector_coordinate, offset, neighbor_sector_coordinate);
+
+        if (!sector_coordinate_is_valid(neighbor_sector_coordinate, world->window_sector_coordinate))
+        {
+            out_neighbor_sector_array[neighborhood_index] = NULL;
+
+            continue;
+        }
+
+        out_neighbor_sector_array[neighborhood_index] = world->sector_array[sector_coordinate_to_sector_index(neighbor_sector_coordinate)];
+    }
+}
+
+void world_get_neighbor_light_array(World* world, SectorIndex sector_index, const u8** out_neighbor_light_array)
+{
+    SectorCoordinate sector_coordinate;
+    sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+    for (u32 neighborhood_index = 0; neighborhood_index < GRID_NEIGHBORHOOD_COUNT; ++neighborhood_index)
+    {
+        i32 offset[3];
+        grid_neighborhood_index_to_offset(neighborhood_index, offset);
+
+        SectorCoordinate neighbor_sector_coordinate;
+        glm_ivec3_add(sector_coordinate, offset, neighbor_sector_coordinate);
+
+        if (!sector_coordinate_is_valid(neighbor_sector_coordinate, world->window_sector_coordinate))
+        {
+            out_neighbor_light_array[neighborhood_index] = NULL;
+
+            continue;
+        }
+
+        out_neighbor_light_array[neighborhood_index] = light_get_sector_level_array(
+            world->light,
+            sector_coordinate_to_sector_index(neighbor_sector_coordinate)
+        );
+    }
+}
+
+void world_mark_sector_dirty(World* world, SectorIndex sector_index)
+{
+    u64* dirty_sector_mask = &world->dirty_sector_mask_array[sector_index / 64];
+    const u64 sector_bit = 1ull << (sector_index % 64);
+
+    if (*dirty_sector_mask & sector_bit)
+    {
+        return;
+    }
+
+    *dirty_sector_mask |= sector_bit;
+
+    world->dirty_sector_index_array[world->dirty_sector_count++] = sector_index;
+}
+
+// Marks the sector holding a cell dirty. A cell on the boundary of its sector
+// also changes the faces and corner occlusion of every neighbor it touches,
+// across faces, edges and corners.
+
+static void world_mark_cell_dirty(World* world, GridCoordinate grid_coordinate)
+{
+    world_mark_sector_dirty(world, grid_coordinate_to_sector_index(grid_coordinate));
+
+    CellCoordinate cell_coordinate;
+    grid_coordinate_to_cell_coordinate(grid_coordinate, cell_coordinate);
+
+    if (
+        cell_coordinate[0] > SECTOR_MIN_CELL && cell_coordinate[0] < SECTOR_MAX_CELL &&
+        cell_coordinate[1] > SECTOR_MIN_CELL && cell_coordinate[1] < SECTOR_MAX_CELL &&
+        cell_coordinate[2] > SECTOR_MIN_CELL && cell_coordinate[2] < SECTOR_MAX_CELL
+    ) {
+        return;
+    }
+
+    SectorCoordinate sector_coordinate;
+    grid_coordinate_to_sector_coordinate(grid_coordinate, sector_coordinate);
+
+    for (u32 neighborhood_index = 0; neighborhood_index < GRID_NEIGHBORHOOD_COUNT; ++neighborhood_index)
+    {
+        if (neighborhood_index == GRID_NEIGHBORHOOD_CENTER)
+        {
+            continue;
+        }
+
+        i32 offset[3];
+        grid_neighborhood_index_to_offset(neighborhood_index, offset);
+
+        CellCoordinate neighbor_cell_coordinate;
+        glm_ivec3_add(cell_coordinate, offset, neighbor_cell_coordinate);
+
+        // Every axis the neighbor lies along must leave the sector
+
+        bool is_touching = true;
+
+        for (u32 axis = 0; axis < 3; ++axis)
+        {
+            if (
+                offset[axis] != 0 &&
+                neighbor_cell_coordinate[axis] >= SECTOR_MIN_CELL &&
+                neighbor_cell_coordinate[axis] <= SECTOR_MAX_CELL
+            ) {
+                is_touching = false;
+            }
+        }
+
+        if (!is_touching)
+        {
+            continue;
+        }
+
+        SectorCoordinate neighbor_sector_coordinate;
+        glm_ivec3_add(sector_coordinate, offset, neighbor_sector_coordinate);
+
+        if (!sector_coordinate_is_valid(neighbor_sector_coordinate, world->window_sector_coordinate))
+        {
+            continue;
+        }
+
+        const SectorIndex neighbor_sector_index = sector_coordinate_to_sector_index(neighbor_sector_coordinate);
+
+        if (world_sector_is_loaded(world, neighbor_sector_index))
+        {
+            world_mark_sector_dirty(world, neighbor_sector_index);
+        }
+    }
+}
+
+// Removes up to max_sector_count sectors from the front of the dirty queue
+
+u32 world_take_dirty_sector_array(World* world, SectorIndex* out_sector_index_array, u32 max_sector_count)
+{
+    const u32 sector_count = world->dirty_sector_count < max_sector_count ? world->dirty_sector_count : max_sector_count;
+
+    for (u32 dirty_index = 0; dirty_index < sector_count; ++dirty_index)
+    {
+        const SectorIndex sector_index = world->dirty_sector_index_array[dirty_index];
+
+        world->dirty_sector_mask_array[sector_index / 64] &= ~(1ull << (sector_index % 64));
+
+        out_sector_index_array[dirty_index] = sector_index;
+    }
+
+    world->dirty_sector_count -= sector_count;
+
+    memmove(
+        world->dirty_sector_index_array,
+        world->dirty_sector_index_array + sector_count,
+        sizeof(SectorIndex) * world->dirty_sector_count
+    );
+
+    return sector_count;
+}
+
+void world_clear_dirty_sectors(World* world)
+{
+    memset(world->dirty_sector_mask_array, 0, sizeof(u64) * world_get_sector_mask_count());
+
+    world->dirty_sector_count = 0;
+}
+
+CellType world_get_cell(World* world, GridCoordinate grid_coordinate)
+{
+    if (!grid_coordinate_is_valid(grid_coordinate, world->window_sector_coordinate))
+    {
+        return CELL_TYPE_AIR;
+    }
+
+    Sector* sector = world->sector_array[grid_coordinate_to_sector_index(grid_coordinate)];
+
+    if (!sector)
+    {
+        return CELL_TYPE_AIR;
+    }
+
+    return sector_get_cell(sector, grid_coordinate_to_cell_index(grid_coordinate));
+}
+
+// Edits are only kept in loaded sectors, and are saved to the sector's region
+// once it leaves the window
+
+void world_set_cell(World* world, GridCoordinate grid_coordinate, CellType cell_type)
+{
+    if (!grid_coordinate_is_valid(grid_coordinate, world->window_sector_coordinate))
+    {
+        return;
+    }
+
+    const SectorIndex sector_index = grid_coordinate_to_sector_index(grid_coordinate);
+    const CellIndex cell_index = grid_coordinate_to_cell_index(grid_coordinate);
+
+    if (!world_sector_is_loaded(world, sector_index))
+    {
+        return;
+    }
+
+    Sector* sector = world->sector_array[sector_index];
+
+    const CellType old_cell_type = sector ? sector_get_cell(sector, cell_index) : CELL_TYPE_AIR;
+
+    if (old_cell_type == cell_type)
+    {
+        return;
+    }
+
+    if (!sector)
+    {
+        SectorCoordinate sector_coordinate;
+        grid_coordinate_to_sector_coordinate(grid_coordinate, sector_coordinate);
+
+        sector = sector_create(sector_coordinate);
+
+        world->sector_array[sector_index] = sector;
+        world->sector_count++;
+    }
+
+    sector_set_cell(sector, cell_index, cell_type);
+
+    if (sector_is_empty(sector))
+    {
+        sector_destroy(sector);
+
+        world->sector_array[sector_index] = NULL;
+        world->sector_count--;
+    }
+
+    world_sector_mask_set(world->modified_sector_mask_array, sector_index, true);
+    world_mark_cell_dirty(world, grid_coordinate);
+
+    light_update_cell(world, grid_coordinate, old_cell_type, cell_type);
 }
\ No newline at end of file
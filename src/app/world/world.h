@@ -3,19 +3,127 @@
 
 #include "platform/platform.h"
 #include "app/camera.h"
+#include "core/job/job.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+#include "app/world/region.h"
+#include "app/world/generator.h"
+#include "app/world/raycast.h"
+#include "app/world/light.h"
+#include "app/world/physics.h"
+
+// Enough to load a whole face of the window in one frame once the camera
+// crosses into the next sector
+
+#define WORLD_MAX_SECTOR_LOADS_PER_FRAME 32
+
+#define WORLD_GENERATOR_SEED 1337
+
+#define WORLD_PICK_DISTANCE 16.0f
+
+// Half the size of the box the camera collides with, wide enough to keep the
+// corners of the near plane out of the cells
+
+#define WORLD_CAMERA_HALF_EXTENT 0.25f
+
+#define WORLD_REGION_DIRECTORY "save/regions"
+#define WORLD_REGION_CACHE_SIZE 8
 
 typedef struct Platform Platform;
 
+// A window sector waiting to be loaded, ordered by its squared distance in
+// sectors to the camera
+
+typedef struct WorldLoadRequest
+{
+    u32 distance_squared;
+    SectorIndex sector_index;
+}
+WorldLoadRequest;
+
 typedef struct World
 {
     Camera camera;
+
+    // The cell under the crosshair, updated every frame
+
+    RaycastHit camera_hit;
+
+    Generator generator;
+
+    JobSystem* job_system;
+
+    SectorCoordinate window_sector_coordinate;
+
+    // Sectors are indexed toroidally within the window. A loaded sector may
+    // still be NULL when all of its cells are air.
+
+    u32 sector_count;
+    Sector** sector_array;
+
+    u64* loaded_sector_mask_array;
+
+    Light* light;
+
+    // Sectors edited since they were loaded, saved to their region when they
+    // leave the window and when the world is destroyed
+
+    u64* modified_sector_mask_array;
+
+    // Regions are opened on demand and replaced round robin. The window
+    // spans at most two regions per axis, so the cache holds all of them.
+    // A world without a region directory generates every sector and saves
+    // none.
+
+    const char* region_directory;
+
+    u32 region_cache_index;
+    Region* region_cache_array[WORLD_REGION_CACHE_SIZE];
+
+    u32 load_request_count;
+    u32 load_request_index;
+    WorldLoadRequest* load_request_array;
+
+    // Sectors missing from their region are generated in parallel, one job
+    // per sector
+
+    JobCounter job_counter;
+    Job* job_array;
+    GeneratorJob* generator_job_array;
+
+    // Sectors whose mesh is out of date. The mask collapses repeated edits
+    // of a sector into one entry of the queue.
+
+    u64* dirty_sector_mask_array;
+
+    u32 dirty_sector_count;
+    SectorIndex* dirty_sector_index_array;
 }
 World;
 
-World* world_create(void);
+World* world_create(const char* region_directory);
 void world_destroy(World* world);
 
-void world_init(World* world);
+void world_init(World* world, JobSystem* job_system);
 void world_update(World* world, Platform* platform, f64 delta_time);
 
+void world_update_window(World* world);
+
+bool world_sector_is_loaded(World* world, SectorIndex sector_index);
+
+Sector* world_get_sector(World* world, SectorIndex sector_index);
+
+// Fills the GRID_NEIGHBORHOOD_COUNT sectors around a sector, including the
+// sector itself, with NULL for sectors outside the window
+
+void world_get_neighbor_sector_array(World* world, SectorIndex sector_index, Sector** out_neighbor_sector_array);
+void world_get_neighbor_light_array(World* world, SectorIndex sector_index, const u8** out_neighbor_light_array);
+
+void world_mark_sector_dirty(World* world, SectorIndex sector_index);
+u32 world_take_dirty_sector_array(World* world, SectorIndex* out_sector_index_array, u32 max_sector_count);
+void world_clear_dirty_sectors(World* world);
+
+CellType world_get_cell(World* world, GridCoordinate grid_coordinate);
+void world_set_cell(World* world, GridCoordinate grid_coordinate, CellType cell_type);
+
 #endif
\ No newline at end of file
@@ -1,8 +1,10 @@
 #ifndef CORE_H
 #define CORE_H 1
 
+#include <stdbool.h>
 #include <stddef.h>
 
 size_t read_file_binary(const char* filename, char** out_buffer);
+bool create_directory(const char* path);
 
 #endif
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "core/core.h"
 #include "core/log/log.h"
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 
 size_t read_file_binary(const char* filename, char** out_buffer)
 {
@@ -33,3 +36,43 @@ size_t read_file_binary(const char* filename, char** out_buffer)
 
     return file_size;
 }
+
+// Creates the directory and any missing parents, succeeding when it already
+// exists
+
+bool create_directory(const char* path)
+{
+    char partial_path[256];
+
+    const size_t path_length = strlen(path);
+
+    if (path_length >= sizeof(partial_path))
+    {
+        LOG_ERROR("Directory path too long: %s", path);
+
+        return false;
+    }
+
+    memcpy(partial_path, path, path_length + 1);
+
+    for (size_t path_index = 1; path_index <= path_length; ++path_index)
+    {
+        if (partial_path[path_index] != '/' && partial_path[path_index] != '\0')
+        {
+            continue;
+        }
+
+        partial_path[path_index] = '\0';
+
+        if (mkdir(partial_path, 0755) != 0 && errno != EEXIST)
+        {
+            LOG_ERROR("Failed to create directory: %s", partial_path);
+
+            return false;
+        }
+
+        partial_path[path_index] = path[path_index];
+    }
+
+    return true;
+}
\ No newline at end of file
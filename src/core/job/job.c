@@ -0,0 +1,301 @@
+#include "core/job/job.h"
+
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "core/log/log.h"
+
+#define JOB_DEQUE_MASK (JOB_DEQUE_CAPACITY - 1)
+
+static _Thread_local u32 job_worker_index = 0;
+
+// Only the owning worker pushes and pops. Returns false when the deque is full.
+
+static bool job_deque_push(JobDeque* deque, Job* job)
+{
+    const i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    const i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    if (bottom - top >= JOB_DEQUE_CAPACITY)
+    {
+        return false;
+    }
+
+    atomic_store_explicit(&deque->job_array[bottom & JOB_DEQUE_MASK], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+
+    return true;
+}
+
+static Job* job_deque_pop(JobDeque* deque)
+{
+    const i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    i64 top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+
+        return NULL;
+    }
+
+    Job* job = atomic_load_explicit(&deque->job_array[bottom & JOB_DEQUE_MASK], memory_order_relaxed);
+
+    // The last job may be contended by a thief, whoever advances top wins it
+
+    if (top == bottom)
+    {
+        if (
+            !atomic_compare_exchange_strong_explicit(
+                &deque->top,
+                &top,
+                top + 1,
+                memory_order_seq_cst,
+                memory_order_relaxed
+            )
+        ) {
+            job = NULL;
+        }
+
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+
+    return job;
+}
+
+static Job* job_deque_steal(JobDeque* deque)
+{
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom)
+    {
+        return NULL;
+    }
+
+    Job* job = atomic_load_explicit(&deque->job_array[top & JOB_DEQUE_MASK], memory_order_relaxed);
+
+    if (
+        !atomic_compare_exchange_strong_explicit(
+            &deque->top,
+            &top,
+            top + 1,
+            memory_order_seq_cst,
+            memory_order_relaxed
+        )
+    ) {
+        return NULL;
+    }
+
+    return job;
+}
+
+static void job_run(Job* job)
+{
+    job->function(job->data);
+
+    atomic_fetch_sub_explicit(&job->counter->value, 1, memory_order_release);
+}
+
+// Takes a job from the worker's own deque, or steals one from the others
+// starting with the next worker
+
+static Job* job_system_take_job(JobSystem* job_system, u32 worker_index)
+{
+    Job* job = job_deque_pop(&job_system->worker_array[worker_index].deque);
+
+    for (u32 offset = 1; !job && offset < job_system->worker_count; ++offset)
+    {
+        const u32 victim_index = (worker_index + offset) % job_system->worker_count;
+
+        job = job_deque_steal(&job_system->worker_array[victim_index].deque);
+    }
+
+    if (job)
+    {
+        atomic_fetch_sub_explicit(&job_system->pending_job_count, 1, memory_order_relaxed);
+    }
+
+    return job;
+}
+
+static void* job_worker_main(void* argument)
+{
+    JobWorker* worker = argument;
+    JobSystem* job_system = worker->job_system;
+
+    job_worker_index = worker->worker_index;
+
+    while (atomic_load_explicit(&job_system->is_running, memory_order_acquire))
+    {
+        Job* job = job_system_take_job(job_system, worker->worker_index);
+
+        if (job)
+        {
+            job_run(job);
+
+            continue;
+        }
+
+        pthread_mutex_lock(&job_system->mutex);
+
+        while (
+            atomic_load_explicit(&job_system->pending_job_count, memory_order_relaxed) == 0 &&
+            atomic_load_explicit(&job_system->is_running, memory_order_relaxed)
+        ) {
+            pthread_cond_wait(&job_system->condition, &job_system->mutex);
+        }
+
+        pthread_mutex_unlock(&job_system->mutex);
+    }
+
+    return NULL;
+}
+
+u32 job_get_core_count(void)
+{
+    const long core_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return core_count > 0 ? (u32)core_count : 1;
+}
+
+JobSystem* job_system_create(u32 worker_count)
+{
+    JobSystem* job_system = malloc(sizeof(*job_system));
+
+    if (!job_system)
+    {
+        LOG_FATAL("Failed to allocate job system");
+    }
+
+    if (worker_count == 0)
+    {
+        worker_count = job_get_core_count();
+    }
+
+    atomic_init(&job_system->is_running, true);
+    atomic_init(&job_system->pending_job_count, 0);
+
+    pthread_mutex_init(&job_system->mutex, NULL);
+    pthread_cond_init(&job_system->condition, NULL);
+
+    job_system->worker_count = worker_count;
+    job_system->worker_array = malloc(sizeof(JobWorker) * worker_count);
+
+    if (!job_system->worker_array)
+    {
+        LOG_FATAL("Failed to allocate job workers");
+    }
+
+    for (u32 worker_index = 0; worker_index < worker_count; ++worker_index)
+    {
+        JobWorker* worker = &job_system->worker_array[worker_index];
+
+        worker->worker_index = worker_index;
+        worker->job_system = job_system;
+
+        atomic_init(&worker->deque.top, 0);
+        atomic_init(&worker->deque.bottom, 0);
+    }
+
+    job_worker_index = 0;
+
+    for (u32 worker_index = 1; worker_index < worker_count; ++worker_index)
+    {
+        JobWorker* worker = &job_system->worker_array[worker_index];
+
+        if (pthread_create(&worker->thread, NULL, job_worker_main, worker) != 0)
+        {
+            LOG_FATAL("Failed to create job worker thread");
+        }
+    }
+
+    LOG_INFO("Job System Initialized: %u workers", worker_count);
+
+    return job_system;
+}
+
+void job_system_destroy(JobSystem* job_system)
+{
+    pthread_mutex_lock(&job_system->mutex);
+
+    atomic_store_explicit(&job_system->is_running, false, memory_order_release);
+    pthread_cond_broadcast(&job_system->condition);
+
+    pthread_mutex_unlock(&job_system->mutex);
+
+    for (u32 worker_index = 1; worker_index < job_system->worker_count; ++worker_index)
+    {
+        pthread_join(job_system->worker_array[worker_index].thread, NULL);
+    }
+
+    pthread_cond_destroy(&job_system->condition);
+    pthread_mutex_destroy(&job_system->mutex);
+
+    free(job_system->worker_array);
+    free(job_system);
+}
+
+void job_system_submit(JobSystem* job_system, Job* job_array, u32 job_count, JobCounter* counter)
+{
+    if (job_count == 0)
+    {
+        atomic_store_explicit(&counter->value, 0, memory_order_release);
+
+        return;
+    }
+
+    atomic_store_explicit(&counter->value, job_count, memory_order_relaxed);
+
+    // Jobs are counted as pending before they become visible so a thief
+    // never takes a job that is not yet counted
+
+    atomic_fetch_add_explicit(&job_system->pending_job_count, job_count, memory_order_relaxed);
+
+    JobDeque* deque = &job_system->worker_array[job_worker_index].deque;
+
+    for (u32 job_index = 0; job_index < job_count; ++job_index)
+    {
+        Job* job = &job_array[job_index];
+        job->counter = counter;
+
+        // A full deque runs the job in place rather than dropping it
+
+        if (!job_deque_push(deque, job))
+        {
+            atomic_fetch_sub_explicit(&job_system->pending_job_count, 1, memory_order_relaxed);
+
+            job_run(job);
+        }
+    }
+
+    pthread_mutex_lock(&job_system->mutex);
+    pthread_cond_broadcast(&job_system->condition);
+    pthread_mutex_unlock(&job_system->mutex);
+}
+
+// Runs jobs on the calling worker until every job of the counter is done
+
+void job_system_wait(JobSystem* job_system, JobCounter* counter)
+{
+    while (!job_counter_is_done(counter))
+    {
+        Job* job = job_system_take_job(job_system, job_worker_index);
+
+        if (job)
+        {
+            job_run(job);
+
+            continue;
+        }
+
+        sched_yield();
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef JOB_H
+#define JOB_H 1
+
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "core/types.h"
+
+// The job system runs one worker per core. Every worker owns a Chase-Lev
+// deque: it pushes and pops jobs at the bottom while idle workers steal from
+// the top of the others. The thread that creates the job system is worker 0
+// and only runs jobs while it waits on a counter.
+
+#define JOB_DEQUE_CAPACITY 4096
+
+_Static_assert((JOB_DEQUE_CAPACITY & (JOB_DEQUE_CAPACITY - 1)) == 0, "Job deque capacity must be a power of two");
+
+typedef struct Job Job;
+
+typedef void (*JobFunction)(void* data);
+
+// A counter holds the number of unfinished jobs of one submission
+
+typedef struct JobCounter
+{
+    atomic_uint value;
+}
+JobCounter;
+
+// Jobs are owned by the submitter and must stay alive until their counter
+// reaches zero
+
+typedef struct Job
+{
+    JobFunction function;
+    void* data;
+
+    JobCounter* counter;
+}
+Job;
+
+typedef struct JobDeque
+{
+    atomic_llong top;
+    atomic_llong bottom;
+
+    _Atomic(Job*) job_array[JOB_DEQUE_CAPACITY];
+}
+JobDeque;
+
+typedef struct JobSystem JobSystem;
+
+typedef struct JobWorker
+{
+    u32 worker_index;
+
+    pthread_t thread;
+
+    JobSystem* job_system;
+    JobDeque deque;
+}
+JobWorker;
+
+typedef struct JobSystem
+{
+    atomic_bool is_running;
+    atomic_uint pending_job_count;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+
+    u32 worker_count;
+    JobWorker* worker_array;
+}
+JobSystem;
+
+u32 job_get_core_count(void);
+
+JobSystem* job_system_create(u32 worker_count);
+void job_system_destroy(JobSystem* job_system);
+
+void job_system_submit(JobSystem* job_system, Job* job_array, u32 job_count, JobCounter* counter);
+void job_system_wait(JobSystem* job_system, JobCounter* counter);
+
+static inline bool job_counter_is_done(JobCounter* counter)
+{
+    return atomic_load_explicit(&counter->value, memory_order_acquire) == 0;
+}
+
+#endif
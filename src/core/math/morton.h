@@ -0,0 +1,168 @@
+#ifndef MORTON_H
+#define MORTON_H 1
+
+#include "core/types.h"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// 3D Morton (Z-order) codes interleave x, y and z bit by bit with x in the
+// lowest position. Each axis holds up to 10 bits so a code fits in 30 bits.
+
+#define MORTON_AXIS_BITS    10
+
+#define MORTON_MASK_X       0x09249249u
+#define MORTON_MASK_Y       0x12492492u
+#define MORTON_MASK_Z       0x24924924u
+
+#define MORTON_SPREAD(n) ( \
+    (((n) & 0x01u)      ) | \
+    (((n) & 0x02u) <<  2) | \
+    (((n) & 0x04u) <<  4) | \
+    (((n) & 0x08u) <<  6) | \
+    (((n) & 0x10u) <<  8) | \
+    (((n) & 0x20u) << 10) | \
+    (((n) & 0x40u) << 12) | \
+    (((n) & 0x80u) << 14))
+
+#define MORTON_SPREAD_4(n)      MORTON_SPREAD(n), MORTON_SPREAD((n) + 1), MORTON_SPREAD((n) + 2), MORTON_SPREAD((n) + 3)
+#define MORTON_SPREAD_16(n)     MORTON_SPREAD_4(n), MORTON_SPREAD_4((n) + 4), MORTON_SPREAD_4((n) + 8), MORTON_SPREAD_4((n) + 12)
+#define MORTON_SPREAD_64(n)     MORTON_SPREAD_16(n), MORTON_SPREAD_16((n) + 16), MORTON_SPREAD_16((n) + 32), MORTON_SPREAD_16((n) + 48)
+
+#define MORTON_COMPACT(n) ( \
+    (((n) & 0x001u)      ) | \
+    (((n) & 0x008u) >>  2) | \
+    (((n) & 0x040u) >>  4) | \
+    (((n) & 0x002u) <<  2) | \
+    (((n) & 0x010u)      ) | \
+    (((n) & 0x080u) >>  2) | \
+    (((n) & 0x004u) <<  4) | \
+    (((n) & 0x020u) <<  2) | \
+    (((n) & 0x100u)      ))
+
+#define MORTON_COMPACT_4(n)     MORTON_COMPACT(n), MORTON_COMPACT((n) + 1), MORTON_COMPACT((n) + 2), MORTON_COMPACT((n) + 3)
+#define MORTON_COMPACT_16(n)    MORTON_COMPACT_4(n), MORTON_COMPACT_4((n) + 4), MORTON_COMPACT_4((n) + 8), MORTON_COMPACT_4((n) + 12)
+#define MORTON_COMPACT_64(n)    MORTON_COMPACT_16(n), MORTON_COMPACT_16((n) + 16), MORTON_COMPACT_16((n) + 32), MORTON_COMPACT_16((n) + 48)
+
+// Spreads the 8 bits of a byte so that bit i lands on bit 3 * i
+
+static const u32 morton_spread_table[256] =
+{
+    MORTON_SPREAD_64(0),
+    MORTON_SPREAD_64(64),
+    MORTON_SPREAD_64(128),
+    MORTON_SPREAD_64(192),
+};
+
+// Maps 9 consecutive code bits (3 per axis) to x | y << 3 | z << 6
+
+static const u16 morton_compact_table[512] =
+{
+    MORTON_COMPACT_64(0),
+    MORTON_COMPACT_64(64),
+    MORTON_COMPACT_64(128),
+    MORTON_COMPACT_64(192),
+    MORTON_COMPACT_64(256),
+    MORTON_COMPACT_64(320),
+    MORTON_COMPACT_64(384),
+    MORTON_COMPACT_64(448),
+};
+
+static inline u32 morton_spread_table_lookup(u32 value)
+{
+    return morton_spread_table[value & 0xFF] | morton_spread_table[(value >> 8) & 0x03] << 24;
+}
+
+static inline u32 morton_encode_3d_table(u32 x, u32 y, u32 z)
+{
+    return
+        morton_spread_table_lookup(x) |
+        morton_spread_table_lookup(y) << 1 |
+        morton_spread_table_lookup(z) << 2;
+}
+
+static inline void morton_decode_3d_table(u32 code, u32* out_x, u32* out_y, u32* out_z)
+{
+    u32 x = 0;
+    u32 y = 0;
+    u32 z = 0;
+
+    for (u32 chunk_index = 0; chunk_index < 4; ++chunk_index)
+    {
+        const u32 compact = morton_compact_table[(code >> (9 * chunk_index)) & 0x1FF];
+
+        x |= (compact & 0x7) << (3 * chunk_index);
+        y |= ((compact >> 3) & 0x7) << (3 * chunk_index);
+        z |= ((compact >> 6) & 0x7) << (3 * chunk_index);
+    }
+
+    *out_x = x;
+    *out_y = y;
+    *out_z = z;
+}
+
+#if defined(__BMI2__)
+
+static inline u32 morton_encode_3d_bmi2(u32 x, u32 y, u32 z)
+{
+    return
+        _pdep_u32(x, MORTON_MASK_X) |
+        _pdep_u32(y, MORTON_MASK_Y) |
+        _pdep_u32(z, MORTON_MASK_Z);
+}
+
+static inline void morton_decode_3d_bmi2(u32 code, u32* out_x, u32* out_y, u32* out_z)
+{
+    *out_x = _pext_u32(code, MORTON_MASK_X);
+    *out_y = _pext_u32(code, MORTON_MASK_Y);
+    *out_z = _pext_u32(code, MORTON_MASK_Z);
+}
+
+#endif
+
+static inline u32 morton_encode_3d(u32 x, u32 y, u32 z)
+{
+#if defined(__BMI2__)
+    return morton_encode_3d_bmi2(x, y, z);
+#else
+    return morton_encode_3d_table(x, y, z);
+#endif
+}
+
+static inline void morton_decode_3d(u32 code, u32* out_x, u32* out_y, u32* out_z)
+{
+#if defined(__BMI2__)
+    morton_decode_3d_bmi2(code, out_x, out_y, out_z);
+#else
+    morton_decode_3d_table(code, out_x, out_y, out_z);
+#endif
+}
+
+static inline void morton_encode_3d_batch(
+    const u32* x_array,
+    const u32* y_array,
+    const u32* z_array,
+    u32* out_code_array,
+    u32 count
+) {
+    for (u32 index = 0; index < count; ++index)
+    {
+        out_code_array[index] = morton_encode_3d(x_array[index], y_array[index], z_array[index]);
+    }
+}
+
+static inline void morton_decode_3d_batch(
+    const u32* code_array,
+    u32* out_x_array,
+    u32* out_y_array,
+    u32* out_z_array,
+    u32 count
+) {
+    for (u32 index = 0; index < count; ++index)
+    {
+        morton_decode_3d(code_array[index], &out_x_array[index], &out_y_array[index], &out_z_array[index]);
+    }
+}
+
+#endif
@@ -0,0 +1,396 @@
+#include "render/cull.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <float.h>
+#include <stdlib.h>
+
+#include "core/log/log.h"
+
+#if defined(__AVX__)
+#define CULL_LANE_COUNT 8
+#elif defined(__SSE2__)
+#define CULL_LANE_COUNT 4
+#else
+#define CULL_LANE_COUNT 1
+#endif
+
+#define CULL_LANE_MASK ((1u << CULL_LANE_COUNT) - 1)
+
+// Clip space spans [-w, w] along x and y and [0, w] along z, so every plane
+// is the last row of the matrix plus or minus another row, except the near
+// plane which is the depth row alone
+
+void frustum_from_projection_view_matrix(mat4 projection_view_matrix, Frustum* out_frustum)
+{
+    vec4 row_array[4];
+
+    for (u32 row = 0; row < 4; ++row)
+    {
+        for (u32 column = 0; column < 4; ++column)
+        {
+            row_array[row][column] = projection_view_matrix[column][row];
+        }
+    }
+
+    glm_vec4_add(row_array[3], row_array[0], out_frustum->plane_array[0]);
+    glm_vec4_sub(row_array[3], row_array[0], out_frustum->plane_array[1]);
+    glm_vec4_add(row_array[3], row_array[1], out_frustum->plane_array[2]);
+    glm_vec4_sub(row_array[3], row_array[1], out_frustum->plane_array[3]);
+    glm_vec4_copy(row_array[2], out_frustum->plane_array[4]);
+    glm_vec4_sub(row_array[3], row_array[2], out_frustum->plane_array[5]);
+}
+
+static void cull_create_bounds_array(CullBoundsArray* bounds_array, u32 count)
+{
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        bounds_array->min_array[axis] = calloc(count, sizeof(f32));
+        bounds_array->max_array[axis] = calloc(count, sizeof(f32));
+
+        if (!bounds_array->min_array[axis] || !bounds_array->max_array[axis])
+        {
+            LOG_FATAL("Failed to allocate cull bounds");
+        }
+    }
+}
+
+static void cull_destroy_bounds_array(CullBoundsArray* bounds_array)
+{
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        free(bounds_array->min_array[axis]);
+        free(bounds_array->max_array[axis]);
+    }
+}
+
+Cull* cull_create(u32 box_capacity)
+{
+    Cull* cull = malloc(sizeof(*cull));
+
+    if (!cull)
+    {
+        LOG_FATAL("Failed to allocate cull");
+    }
+
+    const u32 group_count = (box_capacity + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+
+    cull->group_count = (group_count + CULL_GROUP_ALIGNMENT - 1) / CULL_GROUP_ALIGNMENT * CULL_GROUP_ALIGNMENT;
+    cull->box_capacity = cull->group_count * CULL_GROUP_SIZE;
+
+    cull_create_bounds_array(&cull->box_bounds_array, cull->box_capacity);
+    cull_create_bounds_array(&cull->group_bounds_array, cull->group_count);
+
+    cull->box_id_array = calloc(cull->box_capacity, sizeof(u32));
+    cull->visible_id_array = malloc(sizeof(u32) * cull->box_capacity);
+
+    cull->group_occupancy_mask_array = calloc(cull->group_count, sizeof(u8));
+    cull->is_group_dirty_array = calloc(cull->group_count, sizeof(bool));
+
+    if (
+        !cull->box_id_array ||
+        !cull->visible_id_array ||
+        !cull->group_occupancy_mask_array ||
+        !cull->is_group_dirty_array
+    ) {
+        LOG_FATAL("Failed to allocate cull");
+    }
+
+    cull->visible_count = 0;
+    cull->tested_group_count = 0;
+    cull->tested_box_count = 0;
+
+    return cull;
+}
+
+void cull_destroy(Cull* cull)
+{
+    cull_destroy_bounds_array(&cull->box_bounds_array);
+    cull_destroy_bounds_array(&cull->group_bounds_array);
+
+    free(cull->is_group_dirty_array);
+    free(cull->group_occupancy_mask_array);
+    free(cull->visible_id_array);
+    free(cull->box_id_array);
+    free(cull);
+}
+
+void cull_set_box(Cull* cull, u32 box_index, u32 id, const vec3 min, const vec3 max)
+{
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        cull->box_bounds_array.min_array[axis][box_index] = min[axis];
+        cull->box_bounds_array.max_array[axis][box_index] = max[axis];
+    }
+
+    cull->box_id_array[box_index] = id;
+
+    const u32 group_index = box_index / CULL_GROUP_SIZE;
+
+    cull->group_occupancy_mask_array[group_index] |= 1u << (box_index % CULL_GROUP_SIZE);
+    cull->is_group_dirty_array[group_index] = true;
+}
+
+void cull_clear_box(Cull* cull, u32 box_index)
+{
+    const u32 group_index = box_index / CULL_GROUP_SIZE;
+
+    cull->group_occupancy_mask_array[group_index] &= ~(1u << (box_index % CULL_GROUP_SIZE));
+    cull->is_group_dirty_array[group_index] = true;
+}
+
+// Fits the bounds of a group around its members. Empty groups keep stale
+// bounds, which their occupancy masks out.
+
+static void cull_fit_group(Cull* cull, u32 group_index)
+{
+    const u32 occupancy_mask = cull->group_occupancy_mask_array[group_index];
+
+    if (occupancy_mask == 0)
+    {
+        return;
+    }
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        const f32* box_min_array = &cull->box_bounds_array.min_array[axis][group_index * CULL_GROUP_SIZE];
+        const f32* box_max_array = &cull->box_bounds_array.max_array[axis][group_index * CULL_GROUP_SIZE];
+
+        f32 group_min = FLT_MAX;
+        f32 group_max = -FLT_MAX;
+
+        for (u32 member = 0; member < CULL_GROUP_SIZE; ++member)
+        {
+            if (!(occupancy_mask >> member & 1))
+            {
+                continue;
+            }
+
+            group_min = box_min_array[member] < group_min ? box_min_array[member] : group_min;
+            group_max = box_max_array[member] > group_max ? box_max_array[member] : group_max;
+        }
+
+        cull->group_bounds_array.min_array[axis][group_index] = group_min;
+        cull->group_bounds_array.max_array[axis][group_index] = group_max;
+    }
+}
+
+// Tests CULL_LANE_COUNT boxes starting at the given index. Returns a bit per
+// box not outside any plane, and sets a bit per box inside every plane. The
+// corner of a box furthest along a plane normal decides whether it is
+// outside, and the nearest corner whether it is inside.
+
+#if defined(__AVX__)
+
+static inline __m256 cull_plane_extent_avx(__m256 normal, __m256 min, __m256 max, __m256* out_near_extent)
+{
+    const __m256 min_product = _mm256_mul_ps(normal, min);
+    const __m256 max_product = _mm256_mul_ps(normal, max);
+
+    *out_near_extent = _mm256_min_ps(min_product, max_product);
+
+    return _mm256_max_ps(min_product, max_product);
+}
+
+static u32 cull_test_bounds(const Frustum* frustum, const CullBoundsArray* bounds_array, u32 first_index, u32* out_inside_mask)
+{
+    __m256 min_array[3];
+    __m256 max_array[3];
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        min_array[axis] = _mm256_loadu_ps(&bounds_array->min_array[axis][first_index]);
+        max_array[axis] = _mm256_loadu_ps(&bounds_array->max_array[axis][first_index]);
+    }
+
+    __m256 outside = _mm256_setzero_ps();
+    __m256 crossing = _mm256_setzero_ps();
+
+    for (u32 plane_index = 0; plane_index < CULL_PLANE_COUNT; ++plane_index)
+    {
+        const f32* plane = frustum->plane_array[plane_index];
+
+        __m256 far_distance = _mm256_set1_ps(plane[3]);
+        __m256 near_distance = far_distance;
+
+        for (u32 axis = 0; axis < 3; ++axis)
+        {
+            __m256 near_extent;
+            const __m256 far_extent = cull_plane_extent_avx(_mm256_set1_ps(plane[axis]), min_array[axis], max_array[axis], &near_extent);
+
+            far_distance = _mm256_add_ps(far_distance, far_extent);
+            near_distance = _mm256_add_ps(near_distance, near_extent);
+        }
+
+        outside = _mm256_or_ps(outside, _mm256_cmp_ps(far_distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+        crossing = _mm256_or_ps(crossing, _mm256_cmp_ps(near_distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+    }
+
+    *out_inside_mask = ~(u32)_mm256_movemask_ps(crossing) & CULL_LANE_MASK;
+
+    return ~(u32)_mm256_movemask_ps(outside) & CULL_LANE_MASK;
+}
+
+#elif defined(__SSE2__)
+
+static inline __m128 cull_plane_extent_sse2(__m128 normal, __m128 min, __m128 max, __m128* out_near_extent)
+{
+    const __m128 min_product = _mm_mul_ps(normal, min);
+    const __m128 max_product = _mm_mul_ps(normal, max);
+
+    *out_near_extent = _mm_min_ps(min_product, max_product);
+
+    return _mm_max_ps(min_product, max_product);
+}
+
+static u32 cull_test_bounds(const Frustum* frustum, const CullBoundsArray* bounds_array, u32 first_index, u32* out_inside_mask)
+{
+    __m128 min_array[3];
+    __m128 max_array[3];
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        min_array[axis] = _mm_loadu_ps(&bounds_array->min_array[axis][first_index]);
+        max_array[axis] = _mm_loadu_ps(&bounds_array->max_array[axis][first_index]);
+    }
+
+    __m128 outside = _mm_setzero_ps();
+    __m128 crossing = _mm_setzero_ps();
+
+    for (u32 plane_index = 0; plane_index < CULL_PLANE_COUNT; ++plane_index)
+    {
+        const f32* plane = frustum->plane_array[plane_index];
+
+        __m128 far_distance = _mm_set1_ps(plane[3]);
+        __m128 near_distance = far_distance;
+
+        for (u32 axis = 0; axis < 3; ++axis)
+        {
+            __m128 near_extent;
+            const __m128 far_extent = cull_plane_extent_sse2(_mm_set1_ps(plane[axis]), min_array[axis], max_array[axis], &near_extent);
+
+            far_distance = _mm_add_ps(far_distance, far_extent);
+            near_distance = _mm_add_ps(near_distance, near_extent);
+        }
+
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(far_distance, _mm_setzero_ps()));
+        crossing = _mm_or_ps(crossing, _mm_cmplt_ps(near_distance, _mm_setzero_ps()));
+    }
+
+    *out_inside_mask = ~(u32)_mm_movemask_ps(crossing) & CULL_LANE_MASK;
+
+    return ~(u32)_mm_movemask_ps(outside) & CULL_LANE_MASK;
+}
+
+#else
+
+static u32 cull_test_bounds(const Frustum* frustum, const CullBoundsArray* bounds_array, u32 first_index, u32* out_inside_mask)
+{
+    bool is_outside = false;
+    bool is_crossing = false;
+
+    for (u32 plane_index = 0; plane_index < CULL_PLANE_COUNT; ++plane_index)
+    {
+        const f32* plane = frustum->plane_array[plane_index];
+
+        f32 far_distance = plane[3];
+        f32 near_distance = plane[3];
+
+        for (u32 axis = 0; axis < 3; ++axis)
+        {
+            const f32 min_product = plane[axis] * bounds_array->min_array[axis][first_index];
+            const f32 max_product = plane[axis] * bounds_array->max_array[axis][first_index];
+
+            far_distance += min_product > max_product ? min_product : max_product;
+            near_distance += min_product < max_product ? min_product : max_product;
+        }
+
+        is_outside = is_outside || far_distance < 0.0f;
+        is_crossing = is_crossing || near_distance < 0.0f;
+    }
+
+    *out_inside_mask = !is_crossing;
+
+    return !is_outside;
+}
+
+#endif
+
+static inline void cull_append_group_members(Cull* cull, u32 group_index, u32 member_mask)
+{
+    const u32* box_id_array = &cull->box_id_array[group_index * CULL_GROUP_SIZE];
+
+    for (u32 member = 0; member < CULL_GROUP_SIZE; ++member)
+    {
+        if (member_mask >> member & 1)
+        {
+            cull->visible_id_array[cull->visible_count++] = box_id_array[member];
+        }
+    }
+}
+
+// Collects the ids of every box not outside the frustum into the visible id
+// array and returns their count
+
+u32 cull_frustum(Cull* cull, const Frustum* frustum)
+{
+    cull->visible_count = 0;
+    cull->tested_group_count = cull->group_count;
+    cull->tested_box_count = 0;
+
+    for (u32 group_index = 0; group_index < cull->group_count; ++group_index)
+    {
+        if (cull->is_group_dirty_array[group_index])
+        {
+            cull_fit_group(cull, group_index);
+
+            cull->is_group_dirty_array[group_index] = false;
+        }
+    }
+
+    for (u32 first_group_index = 0; first_group_index < cull->group_count; first_group_index += CULL_LANE_COUNT)
+    {
+        u32 group_inside_mask;
+        const u32 group_visible_mask = cull_test_bounds(frustum, &cull->group_bounds_array, first_group_index, &group_inside_mask);
+
+        for (u32 lane = 0; lane < CULL_LANE_COUNT; ++lane)
+        {
+            const u32 group_index = first_group_index + lane;
+            const u32 occupancy_mask = cull->group_occupancy_mask_array[group_index];
+
+            if (occupancy_mask == 0 || !(group_visible_mask >> lane & 1))
+            {
+                continue;
+            }
+
+            if (group_inside_mask >> lane & 1)
+            {
+                cull_append_group_members(cull, group_index, occupancy_mask);
+
+                continue;
+            }
+
+            u32 member_visible_mask = 0;
+
+            for (u32 member = 0; member < CULL_GROUP_SIZE; member += CULL_LANE_COUNT)
+            {
+                u32 member_inside_mask;
+
+                member_visible_mask |= cull_test_bounds(
+                    frustum,
+                    &cull->box_bounds_array,
+                    group_index * CULL_GROUP_SIZE + member,
+                    &member_inside_mask
+                ) << member;
+            }
+
+            cull->tested_box_count += CULL_GROUP_SIZE;
+
+            cull_append_group_members(cull, group_index, member_visible_mask & occupancy_mask);
+        }
+    }
+
+    return cull->visible_count;
+}
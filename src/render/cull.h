@@ -0,0 +1,79 @@
+#ifndef CULL_H
+#define CULL_H 1
+
+#include <cglm/cglm.h>
+
+#include "core/types.h"
+
+// Boxes are culled against the six planes of the view frustum. Bounds are
+// stored as one array per axis and side, so one step tests 8 boxes with AVX,
+// 4 with SSE2 and one at a time otherwise.
+//
+// Boxes are culled in groups of CULL_GROUP_SIZE, each bounded by the box
+// around its members. Groups are tested first: a group outside the frustum
+// skips all its members, a group inside accepts them all, and only the
+// members of groups crossing a plane are tested on their own. Callers place
+// boxes that are close together in the same group.
+
+#define CULL_PLANE_COUNT 6
+#define CULL_GROUP_SIZE 8
+
+// Groups are padded to whole SIMD steps of the widest path
+
+#define CULL_GROUP_ALIGNMENT 8
+
+// Planes face into the frustum and are not normalized, which keeps the sign
+// of the distance
+
+typedef struct Frustum
+{
+    vec4 plane_array[CULL_PLANE_COUNT];
+}
+Frustum;
+
+typedef struct CullBoundsArray
+{
+    f32* min_array[3];
+    f32* max_array[3];
+}
+CullBoundsArray;
+
+typedef struct Cull
+{
+    u32 group_count;
+    u32 box_capacity;
+
+    CullBoundsArray box_bounds_array;
+    CullBoundsArray group_bounds_array;
+
+    // Caller id of every box, reported when it is visible
+
+    u32* box_id_array;
+
+    // A bit per member of a group holding a box, and whether the group
+    // bounds need to be refit before the next cull
+
+    u8* group_occupancy_mask_array;
+    bool* is_group_dirty_array;
+
+    // Results of the most recent cull
+
+    u32 visible_count;
+    u32* visible_id_array;
+
+    u32 tested_group_count;
+    u32 tested_box_count;
+}
+Cull;
+
+void frustum_from_projection_view_matrix(mat4 projection_view_matrix, Frustum* out_frustum);
+
+Cull* cull_create(u32 box_capacity);
+void cull_destroy(Cull* cull);
+
+void cull_set_box(Cull* cull, u32 box_index, u32 id, const vec3 min, const vec3 max);
+void cull_clear_box(Cull* cull, u32 box_index);
+
+u32 cull_frustum(Cull* cull, const Frustum* frustum);
+
+#endif
@@ -1,2 +1,1114 @@
-#include "render/render.h"
+#include "render/mesh.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/log/log.h"
+
+_Static_assert(MESH_PADDED_SIZE_IN_CELLS <= 64, "Padded sector rows must fit in a 64-bit mask");
+
+#define MESH_INITIAL_VERTEX_CAPACITY 1024
+#define MESH_INITIAL_FACE_CAPACITY 256
+
+// Corners are listed counter-clockwise around the outward normal, as signs
+// of the cell radius along each axis
+
+static const f32 mesh_face_corner_array[GRID_DIRECTION_COUNT][4][3] =
+{
+    {{ +1, -1, -1 }, { +1, +1, -1 }, { +1, +1, +1 }, { +1, -1, +1 }},
+    {{ -1, -1, -1 }, { -1, -1, +1 }, { -1, +1, +1 }, { -1, +1, -1 }},
+    {{ -1, +1, -1 }, { -1, +1, +1 }, { +1, +1, +1 }, { +1, +1, -1 }},
+    {{ -1, -1, -1 }, { +1, -1, -1 }, { +1, -1, +1 }, { -1, -1, +1 }},
+    {{ -1, -1, +1 }, { +1, -1, +1 }, { +1, +1, +1 }, { -1, +1, +1 }},
+    {{ -1, -1, -1 }, { -1, +1, -1 }, { +1, +1, -1 }, { +1, -1, -1 }},
+};
+
+// Axes spanned by each face, mapped to the texture u and v coordinates
+
+static const u32 mesh_face_tangent_axis_array[GRID_DIRECTION_COUNT][2] =
+{
+    { 1, 2 },
+    { 1, 2 },
+    { 0, 2 },
+    { 0, 2 },
+    { 0, 1 },
+    { 0, 1 },
+};
+
+// Quads split along the diagonal through corners 0 and 2, or through corners
+// 1 and 3 when those are less occluded, so occlusion interpolates the same
+// way whichever corner of the face is darkened
+
+static const u32 mesh_face_corner_index_array[2][MESH_VERTICES_PER_FACE] =
+{
+    { 0, 1, 2, 0, 2, 3 },
+    { 1, 2, 3, 1, 3, 0 },
+};
+
+// Cell types and visible faces of one sector, indexed by local coordinates
+// in [0, size). Face masks hold one bit per cell along x. Light covers the
+// padded sector, indexed by padded coordinates. Downsampled volumes use the
+// same layout with fewer, larger cells.
+
+typedef struct MeshVolume
+{
+    u32 size_in_cells;
+    u32 scale;
+
+    CellType cell_type_array[SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS];
+
+    u64 row_mask_array[MESH_PADDED_SIZE_IN_CELLS * MESH_PADDED_SIZE_IN_CELLS];
+    u64 face_mask_array[GRID_DIRECTION_COUNT][SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS];
+
+    u8 light_array[MESH_PADDED_SIZE_IN_CELLS * MESH_PADDED_SIZE_IN_CELLS * MESH_PADDED_SIZE_IN_CELLS];
+}
+MeshVolume;
+
+static inline u32 mesh_get_row_index(u32 padded_y, u32 padded_z)
+{
+    return padded_y + padded_z * MESH_PADDED_SIZE_IN_CELLS;
+}
+
+static inline u32 mesh_get_padded_index(u32 padded_x, u32 padded_y, u32 padded_z)
+{
+    return padded_x + mesh_get_row_index(padded_y, padded_z) * MESH_PADDED_SIZE_IN_CELLS;
+}
+
+static inline u32 mesh_get_local_index(const u32* local_coordinate)
+{
+    return
+        local_coordinate[0] +
+        local_coordinate[1] * SECTOR_SIZE_IN_CELLS +
+        local_coordinate[2] * SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS;
+}
+
+static inline bool mesh_is_padded_cell_solid(const MeshVolume* mesh_volume, const i32* padded_coordinate)
+{
+    const u64 row_mask = mesh_volume->row_mask_array[mesh_get_row_index((u32)padded_coordinate[1], (u32)padded_coordinate[2])];
+
+    return (row_mask >> padded_coordinate[0]) & 1;
+}
+
+static inline u32 mesh_get_corner_shade(u64 face_shade, u32 corner_index)
+{
+    return (u32)(face_shade >> (corner_index * MESH_CORNER_SHADE_BITS)) & MESH_CORNER_SHADE_MASK;
+}
+
+static inline u32 mesh_get_corner_ambient_occlusion(u64 face_shade, u32 corner_index)
+{
+    return mesh_get_corner_shade(face_shade, corner_index) & MESH_AMBIENT_OCCLUSION_MAX;
+}
+
+// Whether the padding at a neighborhood offset lies across a skirted face,
+// along any of the axes it leaves the sector on
+
+static inline bool mesh_is_skirted(const i32* offset, u32 skirt_direction_mask)
+{
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        if (offset[axis] == 0)
+        {
+            continue;
+        }
+
+        const u32 direction = 2 * axis + (offset[axis] < 0 ? 1 : 0);
+
+        if ((skirt_direction_mask >> direction) & 1)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void mesh_reserve(Mesh* mesh, u32 vertex_count)
+{
+    if (vertex_count <= mesh->vertex_capacity)
+    {
+        return;
+    }
+
+    u32 vertex_capacity = mesh->vertex_capacity ? mesh->vertex_capacity : MESH_INITIAL_VERTEX_CAPACITY;
+
+    while (vertex_capacity < vertex_count)
+    {
+        vertex_capacity *= 2;
+    }
+
+    mesh->vertex_array = realloc(mesh->vertex_array, sizeof(VoxelVertex) * vertex_capacity);
+
+    if (!mesh->vertex_array)
+    {
+        LOG_FATAL("Failed to allocate mesh vertices");
+    }
+
+    mesh->vertex_capacity = vertex_capacity;
+}
+
+static void mesh_reserve_faces(Mesh* mesh, u32 face_count)
+{
+    if (face_count <= mesh->face_capacity)
+    {
+        return;
+    }
+
+    u32 face_capacity = mesh->face_capacity ? mesh->face_capacity : MESH_INITIAL_FACE_CAPACITY;
+
+    while (face_capacity < face_count)
+    {
+        face_capacity *= 2;
+    }
+
+    mesh->face_array = realloc(mesh->face_array, sizeof(VoxelFace) * face_capacity);
+
+    if (!mesh->face_array)
+    {
+        LOG_FATAL("Failed to allocate mesh faces");
+    }
+
+    mesh->face_capacity = face_capacity;
+}
+
+static void mesh_fill_volume(
+    MeshVolume* mesh_volume,
+    u32 skirt_direction_mask,
+    Sector* sector,
+    Sector* const* neighbor_sector_array,
+    const u8* const* neighbor_light_array
+) {
+    const u32 sector_size_in_cells = get_sector_size_in_cells();
+
+    mesh_volume->size_in_cells = sector_size_in_cells;
+    mesh_volume->scale = 1;
+
+    GridCoordinate sector_grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector->coordinate, sector_grid_coordinate);
+
+    memset(mesh_volume->row_mask_array, 0, sizeof(mesh_volume->row_mask_array));
+    memset(mesh_volume->light_array, 0, sizeof(mesh_volume->light_array));
+
+    const u8* light_array = neighbor_light_array[GRID_NEIGHBORHOOD_CENTER];
+
+    for (u32 z = 0; z < sector_size_in_cells; ++z)
+    {
+        for (u32 y = 0; y < sector_size_in_cells; ++y)
+        {
+            u64 row_mask = 0;
+
+            for (u32 x = 0; x < sector_size_in_cells; ++x)
+            {
+                CellCoordinate cell_coordinate =
+                {
+                    (i32)x + SECTOR_MIN_CELL,
+                    (i32)y + SECTOR_MIN_CELL,
+                    (i32)z + SECTOR_MIN_CELL,
+                };
+
+                const u32 local_coordinate[3] = { x, y, z };
+
+                const CellIndex cell_index = cell_coordinate_to_cell_index(cell_coordinate);
+                const CellType cell_type = sector_get_cell(sector, cell_index);
+
+                mesh_volume->cell_type_array[mesh_get_local_index(local_coordinate)] = cell_type;
+
+                if (light_array)
+                {
+                    mesh_volume->light_array[mesh_get_padded_index(x + 1, y + 1, z + 1)] = light_array[cell_index];
+                }
+
+                row_mask |= (u64)(cell_type != CELL_TYPE_AIR) << (x + 1);
+            }
+
+            mesh_volume->row_mask_array[mesh_get_row_index(y + 1, z + 1)] = row_mask;
+        }
+    }
+
+    // Each neighbor contributes the cells of the padding it covers: a layer
+    // across a face, a row along an edge or a single cell at a corner
+
+    for (u32 neighborhood_index = 0; neighborhood_index < GRID_NEIGHBORHOOD_COUNT; ++neighborhood_index)
+    {
+        Sector* neighbor_sector = neighbor_sector_array[neighborhood_index];
+        const u8* neighbor_light = neighbor_light_array[neighborhood_index];
+
+        if (neighborhood_index == GRID_NEIGHBORHOOD_CENTER || (!neighbor_sector && !neighbor_light))
+        {
+            continue;
+        }
+
+        i32 offset[3];
+        grid_neighborhood_index_to_offset(neighborhood_index, offset);
+
+        if (mesh_is_skirted(offset, skirt_direction_mask))
+        {
+            neighbor_sector = NULL;
+        }
+
+        u32 min_padded_coordinate[3];
+        u32 max_padded_coordinate[3];
+
+        for (u32 axis = 0; axis < 3; ++axis)
+        {
+            if (offset[axis] == 0)
+            {
+                min_padded_coordinate[axis] = 1;
+                max_padded_coordinate[axis] = sector_size_in_cells;
+            }
+            else
+            {
+                min_padded_coordinate[axis] = offset[axis] > 0 ? MESH_PADDED_SIZE_IN_CELLS - 1 : 0;
+                max_padded_coordinate[axis] = min_padded_coordinate[axis];
+            }
+        }
+
+        for (u32 padded_z = min_padded_coordinate[2]; padded_z <= max_padded_coordinate[2]; ++padded_z)
+        {
+            for (u32 padded_y = min_padded_coordinate[1]; padded_y <= max_padded_coordinate[1]; ++padded_y)
+            {
+                u64 row_mask = 0;
+
+                for (u32 padded_x = min_padded_coordinate[0]; padded_x <= max_padded_coordinate[0]; ++padded_x)
+                {
+                    GridCoordinate grid_coordinate =
+                    {
+                        sector_grid_coordinate[0] + SECTOR_MIN_CELL + (i32)padded_x - 1,
+                        sector_grid_coordinate[1] + SECTOR_MIN_CELL + (i32)padded_y - 1,
+                        sector_grid_coordinate[2] + SECTOR_MIN_CELL + (i32)padded_z - 1,
+                    };
+
+                    const CellIndex cell_index = grid_coordinate_to_cell_index(grid_coordinate);
+
+                    if (neighbor_sector)
+                    {
+                        row_mask |= (u64)(sector_get_cell(neighbor_sector, cell_index) != CELL_TYPE_AIR) << padded_x;
+                    }
+
+                    if (neighbor_light)
+                    {
+                        mesh_volume->light_array[mesh_get_padded_index(padded_x, padded_y, padded_z)] = neighbor_light[cell_index];
+                    }
+                }
+
+                mesh_volume->row_mask_array[mesh_get_row_index(padded_y, padded_z)] |= row_mask;
+            }
+        }
+    }
+}
+
+// Downsamples a box of cells of one sector, given by its inclusive bounds,
+// into the type of a coarse cell and its brightest light. Without light to
+// gather, counting stops as soon as either solid or air cells hold the
+// majority.
+
+static CellType mesh_downsample_cell(
+    Sector* sector,
+    const u8* light_array,
+    const i32* min_cell_coordinate,
+    const i32* max_cell_coordinate,
+    u8* out_light
+) {
+    if (!sector && !light_array)
+    {
+        return CELL_TYPE_AIR;
+    }
+
+    u32 cell_count = 1;
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        cell_count *= (u32)(max_cell_coordinate[axis] - min_cell_coordinate[axis] + 1);
+    }
+
+    u32 solid_count = 0;
+    u32 air_count = 0;
+    u32 max_sky = 0;
+    u32 max_block = 0;
+
+    CellType top_cell_type = CELL_TYPE_AIR;
+
+    // Top down, so the first solid cell is the topmost one
+
+    for (i32 z = max_cell_coordinate[2]; z >= min_cell_coordinate[2]; --z)
+    {
+        for (i32 y = min_cell_coordinate[1]; y <= max_cell_coordinate[1]; ++y)
+        {
+            for (i32 x = min_cell_coordinate[0]; x <= max_cell_coordinate[0]; ++x)
+            {
+                CellCoordinate cell_coordinate = { x, y, z };
+
+                const CellIndex cell_index = cell_coordinate_to_cell_index(cell_coordinate);
+                const CellType cell_type = sector ? sector_get_cell(sector, cell_index) : CELL_TYPE_AIR;
+
+                if (cell_type != CELL_TYPE_AIR)
+                {
+                    top_cell_type = solid_count == 0 ? cell_type : top_cell_type;
+                    solid_count++;
+                }
+                else
+                {
+                    air_count++;
+                }
+
+                if (light_array)
+                {
+                    const u32 sky = light_get_sky(light_array[cell_index]);
+                    const u32 block = light_get_block(light_array[cell_index]);
+
+                    max_sky = sky > max_sky ? sky : max_sky;
+                    max_block = block > max_block ? block : max_block;
+                }
+                else if (2 * solid_count >= cell_count || 2 * air_count > cell_count)
+                {
+                    return 2 * solid_count >= cell_count ? top_cell_type : CELL_TYPE_AIR;
+                }
+            }
+        }
+    }
+
+    *out_light = light_pack(max_sky, max_block);
+
+    return 2 * solid_count >= cell_count ? top_cell_type : CELL_TYPE_AIR;
+}
+
+// Fills a volume of coarse cells, each covering scale cells along every axis
+// of the sector and its neighbors. Padding cells downsample the neighbors the
+// same way, so neighbors at the same level agree on their shared boundary,
+// and light keeps the brightest level of each coarse cell.
+
+static void mesh_fill_volume_downsampled(
+    MeshVolume* mesh_volume,
+    u32 lod,
+    u32 skirt_direction_mask,
+    Sector* sector,
+    Sector* const* neighbor_sector_array,
+    const u8* const* neighbor_light_array
+) {
+    const i32 sector_size_in_cells = (i32)get_sector_size_in_cells();
+    const i32 scale = 1 << lod;
+    const u32 size_in_cells = (u32)((sector_size_in_cells + scale - 1) / scale);
+
+    // Padding reaches at most one sector into each neighbor
+
+    const i32 coarse_extent = scale < sector_size_in_cells ? scale : sector_size_in_cells;
+
+    mesh_volume->size_in_cells = size_in_cells;
+    mesh_volume->scale = (u32)scale;
+
+    memset(mesh_volume->row_mask_array, 0, sizeof(mesh_volume->row_mask_array));
+    memset(mesh_volume->light_array, 0, sizeof(mesh_volume->light_array));
+
+    for (u32 padded_z = 0; padded_z <= size_in_cells + 1; ++padded_z)
+    {
+        for (u32 padded_y = 0; padded_y <= size_in_cells + 1; ++padded_y)
+        {
+            u64 row_mask = 0;
+
+            for (u32 padded_x = 0; padded_x <= size_in_cells + 1; ++padded_x)
+            {
+                const u32 padded_coordinate[3] = { padded_x, padded_y, padded_z };
+
+                // Range of sector-local cells covered by the coarse cell,
+                // clipped to the neighborhood
+
+                i32 offset[3];
+                i32 min_local_coordinate[3];
+                i32 max_local_coordinate[3];
+
+                for (u32 axis = 0; axis < 3; ++axis)
+                {
+                    const i32 coarse_coordinate = (i32)padded_coordinate[axis] - 1;
+
+                    offset[axis] = coarse_coordinate < 0 ? -1 : coarse_coordinate >= (i32)size_in_cells ? 1 : 0;
+
+                    if (offset[axis] < 0)
+                    {
+                        min_local_coordinate[axis] = -coarse_extent;
+                        max_local_coordinate[axis] = -1;
+                    }
+                    else if (offset[axis] > 0)
+                    {
+                        min_local_coordinate[axis] = sector_size_in_cells;
+                        max_local_coordinate[axis] = sector_size_in_cells + coarse_extent - 1;
+                    }
+                    else
+                    {
+                        const i32 max_coordinate = (coarse_coordinate + 1) * scale - 1;
+
+                        min_local_coordinate[axis] = coarse_coordinate * scale;
+                        max_local_coordinate[axis] = max_coordinate < sector_size_in_cells ? max_coordinate : sector_size_in_cells - 1;
+                    }
+                }
+
+                const u32 neighborhood_index = grid_offset_to_neighborhood_index(offset);
+
+                Sector* neighbor_sector = neighborhood_index == GRID_NEIGHBORHOOD_CENTER ? sector : neighbor_sector_array[neighborhood_index];
+
+                if (mesh_is_skirted(offset, skirt_direction_mask))
+                {
+                    neighbor_sector = NULL;
+                }
+
+                // The cells of a coarse cell all lie in the same sector
+
+                CellCoordinate min_cell_coordinate;
+                CellCoordinate max_cell_coordinate;
+
+                for (u32 axis = 0; axis < 3; ++axis)
+                {
+                    min_cell_coordinate[axis] = min_local_coordinate[axis] - offset[axis] * sector_size_in_cells + SECTOR_MIN_CELL;
+                    max_cell_coordinate[axis] = max_local_coordinate[axis] - offset[axis] * sector_size_in_cells + SECTOR_MIN_CELL;
+                }
+
+                u8 light = 0;
+
+                const CellType cell_type = mesh_downsample_cell(
+                    neighbor_sector,
+                    neighbor_light_array[neighborhood_index],
+                    min_cell_coordinate,
+                    max_cell_coordinate,
+                    &light
+                );
+
+                const bool is_solid = cell_type != CELL_TYPE_AIR;
+
+                row_mask |= (u64)is_solid << padded_x;
+
+                if (offset[0] == 0 && offset[1] == 0 && offset[2] == 0)
+                {
+                    const u32 local_coordinate[3] = { padded_x - 1, padded_y - 1, padded_z - 1 };
+
+                    mesh_volume->cell_type_array[mesh_get_local_index(local_coordinate)] = cell_type;
+                }
+
+                mesh_volume->light_array[mesh_get_padded_index(padded_x, padded_y, padded_z)] = light;
+            }
+
+            mesh_volume->row_mask_array[mesh_get_row_index(padded_y, padded_z)] = row_mask;
+        }
+    }
+}
+
+static bool mesh_fill_face_masks(MeshVolume* mesh_volume)
+{
+    const u32 sector_size_in_cells = mesh_volume->size_in_cells;
+    const u64 interior_mask = ((1ull << sector_size_in_cells) - 1) << 1;
+
+    const u64* row_mask_array = mesh_volume->row_mask_array;
+
+    u64 any_face_mask = 0;
+
+    for (u32 padded_z = 1; padded_z <= sector_size_in_cells; ++padded_z)
+    {
+        for (u32 padded_y = 1; padded_y <= sector_size_in_cells; ++padded_y)
+        {
+            const u64 row_mask = row_mask_array[mesh_get_row_index(padded_y, padded_z)];
+            const u64 solid_mask = row_mask & interior_mask;
+
+            // Bit x of a face mask is set where a solid cell of this sector
+            // meets air in that direction
+
+            u64 face_mask_array[GRID_DIRECTION_COUNT];
+            face_mask_array[GRID_DIRECTION_POSITIVE_X] = solid_mask & ~(row_mask >> 1);
+            face_mask_array[GRID_DIRECTION_NEGATIVE_X] = solid_mask & ~(row_mask << 1);
+            face_mask_array[GRID_DIRECTION_POSITIVE_Y] = solid_mask & ~row_mask_array[mesh_get_row_index(padded_y + 1, padded_z)];
+            face_mask_array[GRID_DIRECTION_NEGATIVE_Y] = solid_mask & ~row_mask_array[mesh_get_row_index(padded_y - 1, padded_z)];
+            face_mask_array[GRID_DIRECTION_POSITIVE_Z] = solid_mask & ~row_mask_array[mesh_get_row_index(padded_y, padded_z + 1)];
+            face_mask_array[GRID_DIRECTION_NEGATIVE_Z] = solid_mask & ~row_mask_array[mesh_get_row_index(padded_y, padded_z - 1)];
+
+            const u32 row_index = (padded_y - 1) + (padded_z - 1) * sector_size_in_cells;
+
+            for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+            {
+                mesh_volume->face_mask_array[direction][row_index] = face_mask_array[direction] >> 1;
+
+                any_face_mask |= face_mask_array[direction];
+            }
+        }
+    }
+
+    return any_face_mask != 0;
+}
+
+// Packs the shade of the four corners of a face, in corner order, from the
+// cells in front of the face that share each corner: their occlusion and the
+// average light of those that let light through
+
+static u64 mesh_get_face_shade(const MeshVolume* mesh_volume, u32 direction, const u32* local_coordinate)
+{
+    const u32 u_axis = mesh_face_tangent_axis_array[direction][0];
+    const u32 v_axis = mesh_face_tangent_axis_array[direction][1];
+
+    i32 front_padded_coordinate[3];
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        front_padded_coordinate[axis] = (i32)local_coordinate[axis] + 1 + grid_direction_offset_array[direction][axis];
+    }
+
+    // Gathers the 3 x 3 cells in front of the face, bit (u + 1) + 3 (v + 1)
+    // for tangent offsets u and v. When u runs along x, three cells come out
+    // of one row mask.
+
+    u32 front_mask = 0;
+
+    for (i32 v_offset = -1; v_offset <= 1; ++v_offset)
+    {
+        i32 padded_coordinate[3];
+        memcpy(padded_coordinate, front_padded_coordinate, sizeof(padded_coordinate));
+
+        padded_coordinate[v_axis] += v_offset;
+
+        u32 row_bits = 0;
+
+        if (u_axis == 0)
+        {
+            const u64 row_mask = mesh_volume->row_mask_array[mesh_get_row_index((u32)padded_coordinate[1], (u32)padded_coordinate[2])];
+
+            row_bits = (u32)(row_mask >> (padded_coordinate[0] - 1)) & 7;
+        }
+        else
+        {
+            for (i32 u_offset = -1; u_offset <= 1; ++u_offset)
+            {
+                padded_coordinate[u_axis] = front_padded_coordinate[u_axis] + u_offset;
+
+                row_bits |= (u32)mesh_is_padded_cell_solid(mesh_volume, padded_coordinate) << (u_offset + 1);
+            }
+        }
+
+        front_mask |= row_bits << (3 * (v_offset + 1));
+    }
+
+    const u32 front_padded_index = mesh_get_padded_index(
+        (u32)front_padded_coordinate[0],
+        (u32)front_padded_coordinate[1],
+        (u32)front_padded_coordinate[2]
+    );
+
+    const u32 padded_stride_array[3] =
+    {
+        1,
+        MESH_PADDED_SIZE_IN_CELLS,
+        MESH_PADDED_SIZE_IN_CELLS * MESH_PADDED_SIZE_IN_CELLS,
+    };
+
+    u64 face_shade = 0;
+
+    for (u32 corner_index = 0; corner_index < MESH_CORNERS_PER_FACE; ++corner_index)
+    {
+        const f32* corner = mesh_face_corner_array[direction][corner_index];
+
+        const u32 u_bit = corner[u_axis] > 0.0f ? 2 : 0;
+        const u32 v_bit = corner[v_axis] > 0.0f ? 6 : 0;
+
+        const u32 u_side_solid = (front_mask >> (u_bit + 3)) & 1;
+        const u32 v_side_solid = (front_mask >> (1 + v_bit)) & 1;
+        const u32 corner_solid = (front_mask >> (u_bit + v_bit)) & 1;
+
+        const u32 ambient_occlusion =
+            u_side_solid && v_side_solid ? 0 : MESH_AMBIENT_OCCLUSION_MAX - (u_side_solid + v_side_solid + corner_solid);
+
+        // The corner cell is hidden behind two solid sides
+
+        const i32 u_stride = corner[u_axis] > 0.0f ? (i32)padded_stride_array[u_axis] : -(i32)padded_stride_array[u_axis];
+        const i32 v_stride = corner[v_axis] > 0.0f ? (i32)padded_stride_array[v_axis] : -(i32)padded_stride_array[v_axis];
+
+        u32 sky_sum = 0;
+        u32 block_sum = 0;
+        u32 light_count = 0;
+
+        const bool is_lit_array[4] =
+        {
+            true,
+            !u_side_solid,
+            !v_side_solid,
+            ambient_occlusion > 0 && !corner_solid,
+        };
+
+        const i32 offset_array[4] = { 0, u_stride, v_stride, u_stride + v_stride };
+
+        for (u32 sample_index = 0; sample_index < 4; ++sample_index)
+        {
+            if (!is_lit_array[sample_index])
+            {
+                continue;
+            }
+
+            const u8 light = mesh_volume->light_array[(i32)front_padded_index + offset_array[sample_index]];
+
+            sky_sum += light_get_sky(light);
+            block_sum += light_get_block(light);
+            light_count++;
+        }
+
+        const u32 sky = (sky_sum + light_count / 2) / light_count;
+        const u32 block = (block_sum + light_count / 2) / light_count;
+
+        const u32 corner_shade = ambient_occlusion | (u32)light_pack(sky, block) << MESH_AMBIENT_OCCLUSION_BITS;
+
+        face_shade |= (u64)corner_shade << (corner_index * MESH_CORNER_SHADE_BITS);
+    }
+
+    return face_shade;
+}
+
+// Whether a face has the same shade at both ends of a tangent axis, so that
+// it can merge with its neighbors along that axis without changing how it
+// is shaded
+
+static bool mesh_face_shade_is_uniform(u32 direction, u64 face_shade, u32 tangent_axis)
+{
+    // Consecutive corners around a face differ along exactly one axis
+
+    for (u32 corner_index = 0; corner_index < MESH_CORNERS_PER_FACE; ++corner_index)
+    {
+        const u32 next_corner_index = (corner_index + 1) % MESH_CORNERS_PER_FACE;
+
+        if (mesh_face_corner_array[direction][corner_index][tangent_axis] == mesh_face_corner_array[direction][next_corner_index][tangent_axis])
+        {
+            continue;
+        }
+
+        if (mesh_get_corner_shade(face_shade, corner_index) != mesh_get_corner_shade(face_shade, next_corner_index))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Emits the face of a box of cells given by its inclusive local bounds.
+// Texture coordinates count sector cells so that the texture repeats per
+// cell at every level.
+
+static void mesh_emit_quad(
+    Mesh* mesh,
+    const MeshVolume* mesh_volume,
+    u32 direction,
+    u64 face_shade,
+    const u32* min_local_coordinate,
+    const u32* max_local_coordinate
+) {
+    mesh_reserve(mesh, mesh->vertex_count + MESH_VERTICES_PER_FACE);
+
+    const u32 sector_size_in_cells = get_sector_size_in_cells();
+
+    const u32 u_axis = mesh_face_tangent_axis_array[direction][0];
+    const u32 v_axis = mesh_face_tangent_axis_array[direction][1];
+
+    // Corners are counted in sector cells from the minimum corner of the
+    // sector, so the far side of a cell is one past its local coordinate
+
+    u32 min_corner_coordinate[3];
+    u32 max_corner_coordinate[3];
+
+    for (u32 axis = 0; axis < 3; ++axis)
+    {
+        const u32 max_corner = (max_local_coordinate[axis] + 1) * mesh_volume->scale;
+
+        min_corner_coordinate[axis] = min_local_coordinate[axis] * mesh_volume->scale;
+        max_corner_coordinate[axis] = max_corner < sector_size_in_cells ? max_corner : sector_size_in_cells;
+    }
+
+    const u32 u_extent = max_corner_coordinate[u_axis] - min_corner_coordinate[u_axis];
+    const u32 v_extent = max_corner_coordinate[v_axis] - min_corner_coordinate[v_axis];
+
+    const bool is_flipped =
+        mesh_get_corner_ambient_occlusion(face_shade, 1) + mesh_get_corner_ambient_occlusion(face_shade, 3) >
+        mesh_get_corner_ambient_occlusion(face_shade, 0) + mesh_get_corner_ambient_occlusion(face_shade, 2);
+
+    for (u32 vertex_index = 0; vertex_index < MESH_VERTICES_PER_FACE; ++vertex_index)
+    {
+        const u32 corner_index = mesh_face_corner_index_array[is_flipped][vertex_index];
+        const f32* corner = mesh_face_corner_array[direction][corner_index];
+
+        u32 corner_local_coordinate[3];
+
+        for (u32 axis = 0; axis < 3; ++axis)
+        {
+            corner_local_coordinate[axis] = corner[axis] > 0.0f ? max_corner_coordinate[axis] : min_corner_coordinate[axis];
+        }
+
+        mesh->vertex_array[mesh->vertex_count++] = voxel_vertex_pack(
+            corner_local_coordinate,
+            direction,
+            corner[u_axis] > 0.0f ? u_extent : 0,
+            corner[v_axis] > 0.0f ? v_extent : 0,
+            mesh_get_corner_ambient_occlusion(face_shade, corner_index),
+            mesh_get_corner_shade(face_shade, corner_index) >> MESH_AMBIENT_OCCLUSION_BITS
+        );
+    }
+}
+
+static void mesh_build_culled(Mesh* mesh, const MeshVolume* mesh_volume)
+{
+    const u32 sector_size_in_cells = mesh_volume->size_in_cells;
+
+    for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+    {
+        for (u32 z = 0; z < sector_size_in_cells; ++z)
+        {
+            for (u32 y = 0; y < sector_size_in_cells; ++y)
+            {
+                u64 face_mask = mesh_volume->face_mask_array[direction][y + z * sector_size_in_cells];
+
+                while (face_mask)
+                {
+                    const u32 local_coordinate[3] = { (u32)__builtin_ctzll(face_mask), y, z };
+
+                    face_mask &= face_mask - 1;
+
+                    const u64 face_shade = mesh_get_face_shade(mesh_volume, direction, local_coordinate);
+
+                    mesh_emit_quad(mesh, mesh_volume, direction, face_shade, local_coordinate, local_coordinate);
+                }
+            }
+        }
+    }
+}
+
+// Emits one packed face per visible cell face. The level of detail is
+// recovered from the volume scale, which doubles with each level.
+
+static void mesh_build_instanced(Mesh* mesh, const MeshVolume* mesh_volume)
+{
+    const u32 sector_size_in_cells = mesh_volume->size_in_cells;
+    const u32 lod = (u32)__builtin_ctz(mesh_volume->scale);
+
+    for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+    {
+        for (u32 z = 0; z < sector_size_in_cells; ++z)
+        {
+            for (u32 y = 0; y < sector_size_in_cells; ++y)
+            {
+                u64 face_mask = mesh_volume->face_mask_array[direction][y + z * sector_size_in_cells];
+
+                mesh_reserve_faces(mesh, mesh->face_count + (u32)__builtin_popcountll(face_mask));
+
+                while (face_mask)
+                {
+                    const u32 local_coordinate[3] = { (u32)__builtin_ctzll(face_mask), y, z };
+
+                    face_mask &= face_mask - 1;
+
+                    const u64 face_shade = mesh_get_face_shade(mesh_volume, direction, local_coordinate);
+
+                    u32 ambient_occlusion_mask = 0;
+                    u32 light_sum = 0;
+
+                    for (u32 corner_index = 0; corner_index < MESH_CORNERS_PER_FACE; ++corner_index)
+                    {
+                        const u8 light = (u8)(mesh_get_corner_shade(face_shade, corner_index) >> MESH_AMBIENT_OCCLUSION_BITS);
+
+                        const u32 sky = light_get_sky(light);
+                        const u32 block = light_get_block(light);
+
+                        ambient_occlusion_mask |= mesh_get_corner_ambient_occlusion(face_shade, corner_index) << (corner_index * MESH_AMBIENT_OCCLUSION_BITS);
+                        light_sum += sky > block ? sky : block;
+                    }
+
+                    mesh->face_array[mesh->face_count++] = voxel_face_pack(
+                        local_coordinate,
+                        direction,
+                        lod,
+                        ambient_occlusion_mask,
+                        (light_sum + MESH_CORNERS_PER_FACE / 2) / MESH_CORNERS_PER_FACE
+                    );
+                }
+            }
+        }
+    }
+}
+
+// Gathers the faces of one slice into rows along v with one bit per u
+
+static void mesh_fill_slice_mask_array(
+    u64* slice_mask_array,
+    const MeshVolume* mesh_volume,
+    u32 direction,
+    u32 slice
+) {
+    const u32 sector_size_in_cells = mesh_volume->size_in_cells;
+
+    const u64* face_mask_array = mesh_volume->face_mask_array[direction];
+
+    switch (direction / 2)
+    {
+        case 0:
+        {
+            for (u32 z = 0; z < sector_size_in_cells; ++z)
+            {
+                u64 slice_mask = 0;
+
+                for (u32 y = 0; y < sector_size_in_cells; ++y)
+                {
+                    slice_mask |= ((face_mask_array[y + z * sector_size_in_cells] >> slice) & 1) << y;
+                }
+
+                slice_mask_array[z] = slice_mask;
+            }
+
+            break;
+        }
+
+        case 1:
+        {
+            for (u32 z = 0; z < sector_size_in_cells; ++z)
+            {
+                slice_mask_array[z] = face_mask_array[slice + z * sector_size_in_cells];
+            }
+
+            break;
+        }
+
+        default:
+        {
+            for (u32 y = 0; y < sector_size_in_cells; ++y)
+            {
+                slice_mask_array[y] = face_mask_array[y + slice * sector_size_in_cells];
+            }
+
+            break;
+        }
+    }
+}
+
+// Faces merge when their cell type and corner shade match, so both are
+// combined into one key per face of the slice, indexed by u + v * size
+
+#define MESH_SLICE_KEY_CELL_TYPE_SHIFT (MESH_CORNERS_PER_FACE * MESH_CORNER_SHADE_BITS)
+
+static void mesh_fill_slice_key_array(
+    u64* slice_key_array,
+    const u64* slice_mask_array,
+    const MeshVolume* mesh_volume,
+    u32 direction,
+    u32 slice
+) {
+    const u32 sector_size_in_cells = mesh_volume->size_in_cells;
+
+    const u32 axis = direction / 2;
+    const u32 u_axis = mesh_face_tangent_axis_array[direction][0];
+    const u32 v_axis = mesh_face_tangent_axis_array[direction][1];
+
+    for (u32 v = 0; v < sector_size_in_cells; ++v)
+    {
+        u64 slice_mask = slice_mask_array[v];
+
+        while (slice_mask)
+        {
+            const u32 u = (u32)__builtin_ctzll(slice_mask);
+
+            slice_mask &= slice_mask - 1;
+
+            u32 local_coordinate[3];
+            local_coordinate[axis] = slice;
+            local_coordinate[u_axis] = u;
+            local_coordinate[v_axis] = v;
+
+            slice_key_array[u + v * sector_size_in_cells] =
+                mesh_get_face_shade(mesh_volume, direction, local_coordinate) |
+                (u64)mesh_volume->cell_type_array[mesh_get_local_index(local_coordinate)] << MESH_SLICE_KEY_CELL_TYPE_SHIFT;
+        }
+    }
+}
+
+static void mesh_build_greedy(Mesh* mesh, const MeshVolume* mesh_volume)
+{
+    const u32 sector_size_in_cells = mesh_volume->size_in_cells;
+
+    u64 slice_mask_array[SECTOR_SIZE_IN_CELLS];
+    u64 slice_key_array[SECTOR_SIZE_IN_CELLS * SECTOR_SIZE_IN_CELLS];
+
+    for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+    {
+        const u32 axis = direction / 2;
+        const u32 u_axis = mesh_face_tangent_axis_array[direction][0];
+        const u32 v_axis = mesh_face_tangent_axis_array[direction][1];
+
+        for (u32 slice = 0; slice < sector_size_in_cells; ++slice)
+        {
+            mesh_fill_slice_mask_array(slice_mask_array, mesh_volume, direction, slice);
+            mesh_fill_slice_key_array(slice_key_array, slice_mask_array, mesh_volume, direction, slice);
+
+            for (u32 v = 0; v < sector_size_in_cells; ++v)
+            {
+                while (slice_mask_array[v])
+                {
+                    u32 min_local_coordinate[3];
+                    min_local_coordinate[axis] = slice;
+                    min_local_coordinate[u_axis] = (u32)__builtin_ctzll(slice_mask_array[v]);
+                    min_local_coordinate[v_axis] = v;
+
+                    const u64 slice_key = slice_key_array[min_local_coordinate[u_axis] + v * sector_size_in_cells];
+
+                    const u64 face_shade = slice_key & ((1ull << MESH_SLICE_KEY_CELL_TYPE_SHIFT) - 1);
+
+                    const bool is_u_uniform = mesh_face_shade_is_uniform(direction, face_shade, u_axis);
+                    const bool is_v_uniform = mesh_face_shade_is_uniform(direction, face_shade, v_axis);
+
+                    // Grow along u while the faces continue with the same type
+                    // and shade
+
+                    u32 local_coordinate[3];
+                    memcpy(local_coordinate, min_local_coordinate, sizeof(local_coordinate));
+
+                    u64 run_mask = 0;
+
+                    while (
+                        local_coordinate[u_axis] < sector_size_in_cells &&
+                        (slice_mask_array[v] >> local_coordinate[u_axis]) & 1 &&
+                        slice_key_array[local_coordinate[u_axis] + v * sector_size_in_cells] == slice_key
+                    ) {
+                        run_mask |= 1ull << local_coordinate[u_axis];
+                        local_coordinate[u_axis]++;
+
+                        if (!is_u_uniform)
+                        {
+                            break;
+                        }
+                    }
+
+                    u32 max_local_coordinate[3];
+                    memcpy(max_local_coordinate, local_coordinate, sizeof(max_local_coordinate));
+                    max_local_coordinate[u_axis]--;
+
+                    slice_mask_array[v] &= ~run_mask;
+
+                    // Grow along v while the next row holds the whole run
+                    // with the same type and shade
+
+                    const u32 max_v = is_v_uniform ? sector_size_in_cells : v + 1;
+
+                    for (u32 next_v = v + 1; next_v < max_v; ++next_v)
+                    {
+                        if ((slice_mask_array[next_v] & run_mask) != run_mask)
+                        {
+                            break;
+                        }
+
+                        bool is_matching = true;
+
+                        for (u32 u = min_local_coordinate[u_axis]; u <= max_local_coordinate[u_axis]; ++u)
+                        {
+                            if (slice_key_array[u + next_v * sector_size_in_cells] != slice_key)
+                            {
+                                is_matching = false;
+
+                                break;
+                            }
+                        }
+
+                        if (!is_matching)
+                        {
+                            break;
+                        }
+
+                        slice_mask_array[next_v] &= ~run_mask;
+                        max_local_coordinate[v_axis] = next_v;
+                    }
+
+                    mesh_emit_quad(mesh, mesh_volume, direction, face_shade, min_local_coordinate, max_local_coordinate);
+                }
+            }
+        }
+    }
+}
+
+Mesh* mesh_create(void)
+{
+    Mesh* mesh = malloc(sizeof(*mesh));
+
+    if (!mesh)
+    {
+        LOG_FATAL("Failed to allocate mesh");
+    }
+
+    mesh->vertex_count = 0;
+    mesh->vertex_capacity = 0;
+    mesh->vertex_array = NULL;
+
+    mesh->face_count = 0;
+    mesh->face_capacity = 0;
+    mesh->face_array = NULL;
+
+    glm_vec3_zero(mesh->origin_position);
+
+    return mesh;
+}
+
+void mesh_destroy(Mesh* mesh)
+{
+    free(mesh->vertex_array);
+    free(mesh->face_array);
+    free(mesh);
+}
+
+void mesh_clear(Mesh* mesh)
+{
+    mesh->vertex_count = 0;
+    mesh->face_count = 0;
+}
+
+void mesh_build_sector(
+    Mesh* mesh,
+    MeshMode mesh_mode,
+    u32 lod,
+    u32 skirt_direction_mask,
+    Sector* sector,
+    Sector* const* neighbor_sector_array,
+    const u8* const* neighbor_light_array
+) {
+    GridCoordinate sector_grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector->coordinate, sector_grid_coordinate);
+
+    GridCoordinate origin_grid_coordinate;
+    glm_ivec3_adds(sector_grid_coordinate, SECTOR_MIN_CELL, origin_grid_coordinate);
+
+    // The origin is the minimum corner of the sector's first cell
+
+    grid_coordinate_to_world_position(origin_grid_coordinate, mesh->origin_position);
+    glm_vec3_subs(mesh->origin_position, CELL_RADIUS, mesh->origin_position);
+
+    MeshVolume mesh_volume;
+
+    if (lod == 0)
+    {
+        mesh_fill_volume(&mesh_volume, skirt_direction_mask, sector, neighbor_sector_array, neighbor_light_array);
+    }
+    else
+    {
+        mesh_fill_volume_downsampled(&mesh_volume, lod, skirt_direction_mask, sector, neighbor_sector_array, neighbor_light_array);
+    }
+
+    if (!mesh_fill_face_masks(&mesh_volume))
+    {
+        return;
+    }
+
+    switch (mesh_mode)
+    {
+        case MESH_MODE_GREEDY:
+        {
+            mesh_build_greedy(mesh, &mesh_volume);
+
+            break;
+        }
+
+        case MESH_MODE_INSTANCED:
+        {
+            mesh_build_instanced(mesh, &mesh_volume);
+
+            break;
+        }
+
+        default:
+        {
+            mesh_build_culled(mesh, &mesh_volume);
+
+            break;
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#ifndef MESH_H
+#define MESH_H 1
+
+#include <cglm/cglm.h>
+
+#include "core/types.h"
+#include "app/world/grid.h"
+#include "app/world/sector.h"
+#include "app/world/light.h"
+
+// The mesher pads a sector by one cell on every side with the boundary cells
+// of its neighborhood and stores one occupancy bit per cell along x, so a
+// whole padded row is tested against its neighbors with a few word operations.
+// The padding along edges and corners feeds the ambient occlusion of faces on
+// the sector boundary.
+
+#define MESH_PADDED_SIZE_IN_CELLS   (SECTOR_SIZE_IN_CELLS + 2)
+#define MESH_VERTICES_PER_FACE      6
+#define MESH_CORNERS_PER_FACE       4
+
+// Culled meshes emit one quad per visible cell face. Greedy meshes merge
+// coplanar visible faces of the same cell type and corner shade into maximal
+// rectangles, only along axes where the shade does not vary so the merged
+// quad shades exactly like its faces. Instanced meshes emit one packed face
+// per visible cell face and no vertices, and voxel_face.vert expands each
+// into its quad.
+
+typedef enum MeshMode
+{
+    MESH_MODE_CULLED,
+    MESH_MODE_GREEDY,
+    MESH_MODE_INSTANCED,
+    MESH_MODE_COUNT
+}
+MeshMode;
+
+// Distant sectors are meshed from their occupancy downsampled by 1 << lod
+// along each axis. A coarse cell is solid when at least half of its cells
+// are, and takes the type of its topmost solid cell. Coarse cells at the far
+// side of a sector whose size is not a multiple of the scale are clipped to
+// the sector.
+//
+// Sectors meshed at different levels do not meet along their shared face, so
+// each side closes the seam with a skirt: the face padding is treated as air
+// and every solid cell on that boundary emits its face.
+
+#define MESH_LOD_COUNT 4
+
+// Ambient occlusion of a face corner, from the three cells around it in
+// front of the face: 0 when both side cells are solid, otherwise 3 minus the
+// number of solid cells
+
+#define MESH_AMBIENT_OCCLUSION_BITS     2
+#define MESH_AMBIENT_OCCLUSION_MAX      3
+
+// The shade of a face corner packs its occlusion and its smooth light, the
+// average light of the cells around the corner in front of the face
+
+#define MESH_CORNER_SHADE_BITS          (MESH_AMBIENT_OCCLUSION_BITS + 8)
+#define MESH_CORNER_SHADE_MASK          ((1u << MESH_CORNER_SHADE_BITS) - 1)
+
+// A voxel vertex packs its corner position relative to the sector's minimum
+// corner, its face direction, its texture coordinates in cells and its
+// ambient occlusion into one word, and its light packed as in light.h into a
+// second one. voxel.vert mirrors this layout and reads the sector origin from
+// the frame's sector storage buffer at the instance index of the draw.
+
+#define VOXEL_VERTEX_POSITION_BITS      5
+#define VOXEL_VERTEX_DIRECTION_BITS     3
+#define VOXEL_VERTEX_UV_BITS            5
+#define VOXEL_VERTEX_AO_BITS            MESH_AMBIENT_OCCLUSION_BITS
+
+#define VOXEL_VERTEX_X_SHIFT            0
+#define VOXEL_VERTEX_Y_SHIFT            5
+#define VOXEL_VERTEX_Z_SHIFT            10
+#define VOXEL_VERTEX_DIRECTION_SHIFT    15
+#define VOXEL_VERTEX_U_SHIFT            18
+#define VOXEL_VERTEX_V_SHIFT            23
+#define VOXEL_VERTEX_AO_SHIFT           28
+
+_Static_assert(SECTOR_SIZE_IN_CELLS < (1 << VOXEL_VERTEX_POSITION_BITS), "Sector corners must fit in the packed vertex position");
+_Static_assert(SECTOR_SIZE_IN_CELLS < (1 << VOXEL_VERTEX_UV_BITS), "Sector extents must fit in the packed vertex uv");
+_Static_assert(GRID_DIRECTION_COUNT <= (1 << VOXEL_VERTEX_DIRECTION_BITS), "Directions must fit in the packed vertex direction");
+
+typedef struct VoxelVertex
+{
+    u32 data;
+    u32 light;
+}
+VoxelVertex;
+
+// A voxel face packs the minimum corner of its cell relative to the sector's
+// minimum corner, its direction, the level of detail that scales its cell,
+// the ambient occlusion of its four corners and its light into one word.
+// Light is the rounded mean over the corners of the brighter of sky and block
+// light, the same level voxel.vert shades a vertex with. voxel_face.vert
+// mirrors this layout.
+
+#define VOXEL_FACE_POSITION_BITS        4
+#define VOXEL_FACE_DIRECTION_BITS       3
+#define VOXEL_FACE_LOD_BITS             2
+#define VOXEL_FACE_AO_BITS              (MESH_CORNERS_PER_FACE * MESH_AMBIENT_OCCLUSION_BITS)
+#define VOXEL_FACE_LIGHT_BITS           4
+
+#define VOXEL_FACE_X_SHIFT              0
+#define VOXEL_FACE_Y_SHIFT              4
+#define VOXEL_FACE_Z_SHIFT              8
+#define VOXEL_FACE_DIRECTION_SHIFT      12
+#define VOXEL_FACE_LOD_SHIFT            15
+#define VOXEL_FACE_AO_SHIFT             17
+#define VOXEL_FACE_LIGHT_SHIFT          25
+
+_Static_assert(SECTOR_SIZE_IN_CELLS <= (1 << VOXEL_FACE_POSITION_BITS), "Sector cells must fit in the packed face position");
+_Static_assert(MESH_LOD_COUNT <= (1 << VOXEL_FACE_LOD_BITS), "Levels of detail must fit in the packed face");
+_Static_assert(VOXEL_FACE_LIGHT_SHIFT + VOXEL_FACE_LIGHT_BITS <= 32, "Packed face fields must fit in one word");
+
+typedef struct VoxelFace
+{
+    u32 data;
+}
+VoxelFace;
+
+typedef struct Mesh
+{
+    u32 vertex_count;
+    u32 vertex_capacity;
+
+    VoxelVertex* vertex_array;
+
+    u32 face_count;
+    u32 face_capacity;
+
+    VoxelFace* face_array;
+
+    vec3 origin_position;
+}
+Mesh;
+
+static inline VoxelVertex voxel_vertex_pack(
+    const u32* corner,
+    u32 direction,
+    u32 u,
+    u32 v,
+    u32 ambient_occlusion,
+    u32 light
+) {
+    VoxelVertex voxel_vertex =
+    {
+        .data =
+            corner[0] << VOXEL_VERTEX_X_SHIFT |
+            corner[1] << VOXEL_VERTEX_Y_SHIFT |
+            corner[2] << VOXEL_VERTEX_Z_SHIFT |
+            direction << VOXEL_VERTEX_DIRECTION_SHIFT |
+            u << VOXEL_VERTEX_U_SHIFT |
+            v << VOXEL_VERTEX_V_SHIFT |
+            ambient_occlusion << VOXEL_VERTEX_AO_SHIFT,
+        .light = light,
+    };
+
+    return voxel_vertex;
+}
+
+static inline VoxelFace voxel_face_pack(
+    const u32* cell,
+    u32 direction,
+    u32 lod,
+    u32 ambient_occlusion_mask,
+    u32 light
+) {
+    VoxelFace voxel_face =
+    {
+        .data =
+            cell[0] << VOXEL_FACE_X_SHIFT |
+            cell[1] << VOXEL_FACE_Y_SHIFT |
+            cell[2] << VOXEL_FACE_Z_SHIFT |
+            direction << VOXEL_FACE_DIRECTION_SHIFT |
+            lod << VOXEL_FACE_LOD_SHIFT |
+            ambient_occlusion_mask << VOXEL_FACE_AO_SHIFT |
+            light << VOXEL_FACE_LIGHT_SHIFT,
+    };
+
+    return voxel_face;
+}
+
+Mesh* mesh_create(void);
+void mesh_destroy(Mesh* mesh);
+
+void mesh_clear(Mesh* mesh);
+
+// The neighbor arrays hold the GRID_NEIGHBORHOOD_COUNT sectors around the
+// sector, NULL where they are all air or not loaded, and their light levels
+// packed as in light.h, NULL where unlit. The skirt mask holds a bit per
+// direction whose face gets a skirt.
+
+void mesh_build_sector(
+    Mesh* mesh,
+    MeshMode mesh_mode,
+    u32 lod,
+    u32 skirt_direction_mask,
+    Sector* sector,
+    Sector* const* neighbor_sector_array,
+    const u8* const* neighbor_light_array
+);
+
+#endif
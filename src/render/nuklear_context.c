@@ -1,5 +1,6 @@
 #include "render/render.h"
 
+#include <stdio.h>
 #include <string.h>
 
 #include "core/log/log.h"
@@ -33,7 +34,7 @@ void render_nuklear_init(Render *render)
         width,
         height,
         &render->nuklear_context.font_texture.image,
-        &render->nuklear_context.font_texture.image_memory,
+        &render->nuklear_context.font_texture.image_allocation,
         &render->nuklear_context.font_texture.image_view,
         &render->nuklear_context.font_texture.sampler
     );
@@ -83,7 +84,7 @@ void render_nuklear_init(Render *render)
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
         &render->nuklear_context.vertex_buffer,
-        &render->nuklear_context.vertex_buffer_memory
+        &render->nuklear_context.vertex_buffer_allocation
     );
 
     render_vulkan_create_buffer(
@@ -92,26 +93,11 @@ void render_nuklear_init(Render *render)
         VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
         &render->nuklear_context.index_buffer,
-        &render->nuklear_context.index_buffer_memory
+        &render->nuklear_context.index_buffer_allocation
     );
 
-    vkMapMemory(
-        render->vulkan_device_context.device, 
-        render->nuklear_context.vertex_buffer_memory, 
-        0, 
-        VK_WHOLE_SIZE, 
-        0,
-        &render->nuklear_context.vertex_buffer_mapped
-    );
-
-    vkMapMemory(
-        render->vulkan_device_context.device, 
-        render->nuklear_context.index_buffer_memory, 
-        0, 
-        VK_WHOLE_SIZE, 
-        0,
-        &render->nuklear_context.index_buffer_mapped
-    );
+    render->nuklear_context.vertex_buffer_mapped = render->nuklear_context.vertex_buffer_allocation.mapped;
+    render->nuklear_context.index_buffer_mapped = render->nuklear_context.index_buffer_allocation.mapped;
 }
 
 void render_nuklear_convert(Render* render)
@@ -192,6 +178,238 @@ void render_nuklear_upload(Render *render)
         (u32)(index_size / sizeof(u16));
 }
 
+static void render_nuklear_draw_mesh_stats(Render* render)
+{
+    struct nk_context* ctx = &render->nuklear_context.context;
+
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    if (
+        nk_begin(
+            ctx,
+            "Mesh",
+            nk_rect(50, 320, 230, 580),
+            NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_TITLE
+        )
+    ) {
+        nk_layout_row_dynamic(ctx, 25, 3);
+
+        MeshMode mesh_mode = vulkan_mesh_context->mesh_mode;
+
+        if (nk_option_label(ctx, "Culled", mesh_mode == MESH_MODE_CULLED))
+        {
+            mesh_mode = MESH_MODE_CULLED;
+        }
+
+        if (nk_option_label(ctx, "Greedy", mesh_mode == MESH_MODE_GREEDY))
+        {
+            mesh_mode = MESH_MODE_GREEDY;
+        }
+
+        if (nk_option_label(ctx, "Instanced", mesh_mode == MESH_MODE_INSTANCED))
+        {
+            mesh_mode = MESH_MODE_INSTANCED;
+        }
+
+        if (mesh_mode != vulkan_mesh_context->mesh_mode)
+        {
+            vulkan_mesh_context->mesh_mode = mesh_mode;
+            vulkan_mesh_context->is_built = false;
+        }
+
+        nk_layout_row_dynamic(ctx, 20, 1);
+
+        nk_bool is_lod_enabled = vulkan_mesh_context->is_lod_enabled;
+
+        nk_checkbox_label(ctx, "Level of detail", &is_lod_enabled);
+
+        if ((bool)is_lod_enabled != vulkan_mesh_context->is_lod_enabled)
+        {
+            vulkan_mesh_context->is_lod_enabled = is_lod_enabled;
+            vulkan_mesh_context->is_built = false;
+        }
+
+        nk_bool is_culling_enabled = vulkan_mesh_context->is_culling_enabled;
+
+        nk_checkbox_label(ctx, "Frustum culling", &is_culling_enabled);
+
+        vulkan_mesh_context->is_culling_enabled = is_culling_enabled;
+
+        nk_bool is_occlusion_enabled = vulkan_mesh_context->is_occlusion_enabled;
+
+        nk_checkbox_label(ctx, "Occlusion culling", &is_occlusion_enabled);
+
+        vulkan_mesh_context->is_occlusion_enabled = is_occlusion_enabled;
+
+        nk_bool is_gpu_culling_enabled = vulkan_mesh_context->is_gpu_culling_enabled;
+
+        nk_checkbox_label(ctx, "GPU culling", &is_gpu_culling_enabled);
+
+        vulkan_mesh_context->is_gpu_culling_enabled = is_gpu_culling_enabled;
+
+        u32 sector_count = 0;
+        u32 lod_sector_count_array[MESH_LOD_COUNT] = { 0 };
+
+        for (u32 sector_mesh_index = 0; sector_mesh_index < vulkan_mesh_context->sector_mesh_count; ++sector_mesh_index)
+        {
+            VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_mesh_index];
+
+            if (sector_mesh->triangle_count > 0)
+            {
+                sector_count++;
+                lod_sector_count_array[sector_mesh->lod]++;
+            }
+        }
+
+        const f64 triangles_per_sector = sector_count > 0 ? (f64)vulkan_mesh_context->triangle_count / sector_count : 0.0;
+
+        char label[64];
+
+        nk_layout_row_dynamic(ctx, 20, 1);
+
+        snprintf(label, sizeof(label), "Sectors: %u", sector_count);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Triangles: %u", vulkan_mesh_context->triangle_count);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Triangles / sector: %.1f", triangles_per_sector);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(
+            label,
+            sizeof(label),
+            "Sectors by LOD: %u / %u / %u / %u",
+            lod_sector_count_array[0],
+            lod_sector_count_array[1],
+            lod_sector_count_array[2],
+            lod_sector_count_array[3]
+        );
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Sectors in frustum: %u", vulkan_mesh_context->frustum_visible_sector_count);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Visible sectors: %u", vulkan_mesh_context->visible_sector_count);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "GPU visible sectors: %u", vulkan_mesh_context->gpu_visible_sector_count);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Cull time: %.3f ms", vulkan_mesh_context->cull_time * 1e3);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Occlusion time: %.3f ms", vulkan_mesh_context->occlusion_time * 1e3);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        VertexArena* vertex_arena = vulkan_mesh_context->vertex_arena;
+
+        snprintf(
+            label,
+            sizeof(label),
+            "Vertex arena: %.1f%% used, %u free ranges",
+            100.0 * vertex_arena->used_vertex_count / vertex_arena->vertex_capacity,
+            vertex_arena->free_range_count
+        );
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Last remesh: %u sectors", vulkan_mesh_context->remesh_sector_count);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Mesh time: %.3f ms", vulkan_mesh_context->build_time * 1e3);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Max sector: %.3f ms", vulkan_mesh_context->max_sector_build_time * 1e3);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Wall time: %.3f ms", vulkan_mesh_context->wall_time * 1e3);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(label, sizeof(label), "Workers: %u", render->job_system->worker_count);
+        nk_label(ctx, label, NK_TEXT_LEFT);
+    }
+
+    nk_end(ctx);
+}
+
+// Live usage of each memory heap the allocator has touched: suballocated
+// bytes out of the bytes of its blocks, and dedicated allocations
+
+static void render_nuklear_draw_memory_stats(Render* render)
+{
+    struct nk_context* ctx = &render->nuklear_context.context;
+
+    VulkanMemoryContext* vulkan_memory_context = &render->vulkan_memory_context;
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    if (
+        nk_begin(
+            ctx,
+            "Memory",
+            nk_rect(290, 50, 300, 200),
+            NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_TITLE
+        )
+    ) {
+        char label[96];
+
+        nk_layout_row_dynamic(ctx, 20, 1);
+
+        snprintf(
+            label,
+            sizeof(label),
+            "Device allocations: %u / %u",
+            vulkan_memory_context->device_allocation_count,
+            vulkan_memory_context->max_device_allocation_count
+        );
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        snprintf(
+            label,
+            sizeof(label),
+            "Staging: %.1f KB in %u copies, %u early, %u stalls",
+            vulkan_staging_context->flushed_size / 1024.0,
+            vulkan_staging_context->flushed_copy_count,
+            vulkan_staging_context->early_flush_count,
+            vulkan_staging_context->stall_count
+        );
+        nk_label(ctx, label, NK_TEXT_LEFT);
+
+        for (u32 heap_index = 0; heap_index < vulkan_memory_context->memory_properties.memoryHeapCount; ++heap_index)
+        {
+            const VulkanMemoryHeapStats* heap_stats = &vulkan_memory_context->heap_stats_array[heap_index];
+
+            if (heap_stats->block_count == 0 && heap_stats->dedicated_count == 0)
+            {
+                continue;
+            }
+
+            snprintf(
+                label,
+                sizeof(label),
+                "Heap %u: %.1f / %.1f MB in %u blocks, %u allocations",
+                heap_index,
+                heap_stats->used_size / (1024.0 * 1024.0),
+                heap_stats->block_size / (1024.0 * 1024.0),
+                heap_stats->block_count,
+                heap_stats->allocation_count
+            );
+            nk_label(ctx, label, NK_TEXT_LEFT);
+
+            snprintf(
+                label,
+                sizeof(label),
+                "Heap %u: %.1f MB in %u dedicated",
+                heap_index,
+                heap_stats->dedicated_size / (1024.0 * 1024.0),
+                heap_stats->dedicated_count
+            );
+            nk_label(ctx, label, NK_TEXT_LEFT);
+        }
+    }
+
+    nk_end(ctx);
+}
+
 void render_nuklear_draw(Render* render)
 {
     struct nk_context* ctx = &render->nuklear_context.context;
@@ -218,6 +436,9 @@ void render_nuklear_draw(Render* render)
     }
 
     nk_end(ctx);
+
+    render_nuklear_draw_mesh_stats(render);
+    render_nuklear_draw_memory_stats(render);
 }
 
 void render_nuklear_record(Render* render, VkCommandBuffer cmd)
@@ -0,0 +1,458 @@
+#include "render/occlusion.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "core/log/log.h"
+
+// A quad clipped to the near plane gains at most one vertex
+
+#define OCCLUSION_MAX_POLYGON_VERTEX_COUNT 5
+
+// Pixels within this distance of an edge are left uncovered, so rounding
+// never covers a pixel outside the polygon
+
+#define OCCLUSION_SPAN_EPSILON 1e-3f
+
+// Projects a point to screen pixels and depth. Returns false when the point
+// lies in front of the near plane, where its projection is not usable.
+
+static inline bool occlusion_project(Occlusion* occlusion, const vec3 position, vec3 out_screen)
+{
+    vec4 clip_position = { position[0], position[1], position[2], 1.0f };
+    glm_mat4_mulv(occlusion->projection_view_matrix, clip_position, clip_position);
+
+    if (clip_position[3] <= 0.0f || clip_position[2] < 0.0f)
+    {
+        return false;
+    }
+
+    const f32 inverse_w = 1.0f / clip_position[3];
+
+    out_screen[0] = (clip_position[0] * inverse_w * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+    out_screen[1] = (clip_position[1] * inverse_w * 0.5f + 0.5f) * OCCLUSION_HEIGHT;
+    out_screen[2] = clip_position[2] * inverse_w;
+
+    return true;
+}
+
+Occlusion* occlusion_create(void)
+{
+    Occlusion* occlusion = malloc(sizeof(*occlusion));
+
+    if (!occlusion)
+    {
+        LOG_FATAL("Failed to allocate occlusion");
+    }
+
+    u32 depth_count = 0;
+
+    for (u32 level = 0; level < OCCLUSION_LEVEL_COUNT; ++level)
+    {
+        const u32 width = OCCLUSION_WIDTH >> level;
+        const u32 height = OCCLUSION_HEIGHT >> level;
+
+        occlusion->level_width_array[level] = width > 0 ? width : 1;
+        occlusion->level_height_array[level] = height > 0 ? height : 1;
+        occlusion->level_offset_array[level] = depth_count;
+
+        depth_count += occlusion->level_width_array[level] * occlusion->level_height_array[level];
+    }
+
+    occlusion->depth_array = malloc(sizeof(f32) * depth_count);
+
+    if (!occlusion->depth_array)
+    {
+        LOG_FATAL("Failed to allocate occlusion depth");
+    }
+
+    glm_mat4_identity(occlusion->projection_view_matrix);
+    glm_vec3_zero(occlusion->camera_position);
+
+    occlusion->occluder_face_count = 0;
+    occlusion->hidden_box_count = 0;
+
+    return occlusion;
+}
+
+void occlusion_destroy(Occlusion* occlusion)
+{
+    free(occlusion->depth_array);
+    free(occlusion);
+}
+
+void occlusion_begin(Occlusion* occlusion, mat4 projection_view_matrix, const vec3 camera_position)
+{
+    glm_mat4_copy(projection_view_matrix, occlusion->projection_view_matrix);
+    glm_vec3_copy((f32*)camera_position, occlusion->camera_position);
+
+    for (u32 pixel_index = 0; pixel_index < OCCLUSION_WIDTH * OCCLUSION_HEIGHT; ++pixel_index)
+    {
+        occlusion->depth_array[pixel_index] = 1.0f;
+    }
+
+    occlusion->occluder_face_count = 0;
+    occlusion->hidden_box_count = 0;
+}
+
+// Clips a planar convex polygon in clip space to the near side of the near
+// plane, where depth is not negative
+
+static u32 occlusion_clip_polygon(const vec4* vertex_array, u32 vertex_count, vec4* out_vertex_array)
+{
+    u32 out_vertex_count = 0;
+
+    for (u32 vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        const f32* a = vertex_array[vertex];
+        const f32* b = vertex_array[(vertex + 1) % vertex_count];
+
+        if (a[2] >= 0.0f)
+        {
+            glm_vec4_copy((f32*)a, out_vertex_array[out_vertex_count++]);
+        }
+
+        if ((a[2] >= 0.0f) != (b[2] >= 0.0f))
+        {
+            const f32 t = a[2] / (a[2] - b[2]);
+
+            glm_vec4_lerp((f32*)a, (f32*)b, t, out_vertex_array[out_vertex_count]);
+            out_vertex_array[out_vertex_count++][2] = 0.0f;
+        }
+    }
+
+    return out_vertex_count;
+}
+
+// Draws a planar convex quad into the finest level. A pixel is covered when
+// all of it lies inside every edge, and takes the furthest depth of the
+// quad's plane over it. Both are linear over the pixel, so their extremes
+// lie at the corner picked by the signs of their gradients. Each row is
+// filled over the span where every edge holds.
+
+static void occlusion_draw_quad(Occlusion* occlusion, const vec3* corner_array)
+{
+    vec4 clip_array[4];
+
+    for (u32 corner = 0; corner < 4; ++corner)
+    {
+        vec4 position = { corner_array[corner][0], corner_array[corner][1], corner_array[corner][2], 1.0f };
+        glm_mat4_mulv(occlusion->projection_view_matrix, position, clip_array[corner]);
+    }
+
+    vec4 clipped_array[OCCLUSION_MAX_POLYGON_VERTEX_COUNT];
+    const u32 vertex_count = occlusion_clip_polygon(clip_array, 4, clipped_array);
+
+    if (vertex_count < 3)
+    {
+        return;
+    }
+
+    vec3 screen_array[OCCLUSION_MAX_POLYGON_VERTEX_COUNT];
+
+    f32 min_x = FLT_MAX;
+    f32 min_y = FLT_MAX;
+    f32 max_x = -FLT_MAX;
+    f32 max_y = -FLT_MAX;
+
+    for (u32 vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        const f32 inverse_w = 1.0f / clipped_array[vertex][3];
+
+        screen_array[vertex][0] = (clipped_array[vertex][0] * inverse_w * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+        screen_array[vertex][1] = (clipped_array[vertex][1] * inverse_w * 0.5f + 0.5f) * OCCLUSION_HEIGHT;
+        screen_array[vertex][2] = clipped_array[vertex][2] * inverse_w;
+
+        min_x = screen_array[vertex][0] < min_x ? screen_array[vertex][0] : min_x;
+        min_y = screen_array[vertex][1] < min_y ? screen_array[vertex][1] : min_y;
+        max_x = screen_array[vertex][0] > max_x ? screen_array[vertex][0] : max_x;
+        max_y = screen_array[vertex][1] > max_y ? screen_array[vertex][1] : max_y;
+    }
+
+    const i32 first_x = min_x > 0.0f ? (i32)ceilf(min_x) : 0;
+    const i32 first_y = min_y > 0.0f ? (i32)ceilf(min_y) : 0;
+    const i32 last_x = max_x < OCCLUSION_WIDTH ? (i32)floorf(max_x) - 1 : OCCLUSION_WIDTH - 1;
+    const i32 last_y = max_y < OCCLUSION_HEIGHT ? (i32)floorf(max_y) - 1 : OCCLUSION_HEIGHT - 1;
+
+    if (first_x > last_x || first_y > last_y)
+    {
+        return;
+    }
+
+    f32 twice_area = 0.0f;
+
+    for (u32 vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        const f32* a = screen_array[vertex];
+        const f32* b = screen_array[(vertex + 1) % vertex_count];
+
+        twice_area += a[0] * b[1] - b[0] * a[1];
+    }
+
+    if (fabsf(twice_area) < 1e-3f)
+    {
+        return;
+    }
+
+    const f32 winding = twice_area > 0.0f ? 1.0f : -1.0f;
+
+    // Edge functions, positive inside, shifted to their minimum over a pixel
+
+    f32 edge_x_array[OCCLUSION_MAX_POLYGON_VERTEX_COUNT];
+    f32 edge_y_array[OCCLUSION_MAX_POLYGON_VERTEX_COUNT];
+    f32 edge_offset_array[OCCLUSION_MAX_POLYGON_VERTEX_COUNT];
+
+    for (u32 vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        const f32* a = screen_array[vertex];
+        const f32* b = screen_array[(vertex + 1) % vertex_count];
+
+        edge_x_array[vertex] = -winding * (b[1] - a[1]);
+        edge_y_array[vertex] = winding * (b[0] - a[0]);
+
+        edge_offset_array[vertex] =
+            -(edge_x_array[vertex] * a[0] + edge_y_array[vertex] * a[1]) +
+            (edge_x_array[vertex] < 0.0f ? edge_x_array[vertex] : 0.0f) +
+            (edge_y_array[vertex] < 0.0f ? edge_y_array[vertex] : 0.0f);
+    }
+
+    // Depth plane through the three vertices spanning the largest triangle
+    // with the first, shifted to its maximum over a pixel
+
+    const f32* p0 = screen_array[0];
+    const f32* p1 = screen_array[1];
+    const f32* p2 = screen_array[2];
+
+    f32 determinant = 0.0f;
+
+    for (u32 vertex = 2; vertex < vertex_count; ++vertex)
+    {
+        const f32* a = screen_array[vertex - 1];
+        const f32* b = screen_array[vertex];
+
+        const f32 vertex_determinant = (a[0] - p0[0]) * (b[1] - p0[1]) - (b[0] - p0[0]) * (a[1] - p0[1]);
+
+        if (fabsf(vertex_determinant) > fabsf(determinant))
+        {
+            determinant = vertex_determinant;
+            p1 = a;
+            p2 = b;
+        }
+    }
+
+    if (fabsf(determinant) < 1e-6f)
+    {
+        return;
+    }
+
+    const f32 depth_x = ((p1[2] - p0[2]) * (p2[1] - p0[1]) - (p2[2] - p0[2]) * (p1[1] - p0[1])) / determinant;
+    const f32 depth_y = ((p1[0] - p0[0]) * (p2[2] - p0[2]) - (p2[0] - p0[0]) * (p1[2] - p0[2])) / determinant;
+
+    const f32 depth_offset =
+        p0[2] - depth_x * p0[0] - depth_y * p0[1] +
+        (depth_x > 0.0f ? depth_x : 0.0f) +
+        (depth_y > 0.0f ? depth_y : 0.0f);
+
+    occlusion->occluder_face_count++;
+
+    for (i32 y = first_y; y <= last_y; ++y)
+    {
+        // Narrows the row to the pixels inside every edge, rounding inward
+
+        i32 span_first_x = first_x;
+        i32 span_last_x = last_x;
+
+        for (u32 edge = 0; edge < vertex_count && span_first_x <= span_last_x; ++edge)
+        {
+            const f32 row_value = edge_y_array[edge] * (f32)y + edge_offset_array[edge];
+
+            if (edge_x_array[edge] > 0.0f)
+            {
+                const i32 bound_x = (i32)ceilf(-row_value / edge_x_array[edge] + OCCLUSION_SPAN_EPSILON);
+
+                span_first_x = bound_x > span_first_x ? bound_x : span_first_x;
+            }
+            else if (edge_x_array[edge] < 0.0f)
+            {
+                const i32 bound_x = (i32)floorf(-row_value / edge_x_array[edge] - OCCLUSION_SPAN_EPSILON);
+
+                span_last_x = bound_x < span_last_x ? bound_x : span_last_x;
+            }
+            else if (row_value < 0.0f)
+            {
+                span_last_x = span_first_x - 1;
+            }
+        }
+
+        f32* depth_row = &occlusion->depth_array[y * OCCLUSION_WIDTH];
+
+        const f32 row_depth = depth_y * (f32)y + depth_offset;
+
+        for (i32 x = span_first_x; x <= span_last_x; ++x)
+        {
+            const f32 depth = depth_x * (f32)x + row_depth;
+
+            depth_row[x] = depth < depth_row[x] ? depth : depth_row[x];
+        }
+    }
+}
+
+// Each slab is drawn on its side away from the camera. Slabs containing the
+// camera hide nothing.
+
+void occlusion_draw_box_faces(Occlusion* occlusion, const vec3 min, const vec3 max, f32 thickness, u32 face_mask)
+{
+    for (u32 direction = 0; direction < 6; ++direction)
+    {
+        if (!(face_mask >> direction & 1))
+        {
+            continue;
+        }
+
+        const u32 axis = direction / 2;
+        const u32 u_axis = (axis + 1) % 3;
+        const u32 v_axis = (axis + 2) % 3;
+
+        const f32 slab_min = direction & 1 ? min[axis] : max[axis] - thickness;
+        const f32 slab_max = direction & 1 ? min[axis] + thickness : max[axis];
+
+        f32 plane;
+
+        if (occlusion->camera_position[axis] < slab_min)
+        {
+            plane = slab_max;
+        }
+        else if (occlusion->camera_position[axis] > slab_max)
+        {
+            plane = slab_min;
+        }
+        else
+        {
+            continue;
+        }
+
+        vec3 corner_array[4];
+
+        for (u32 corner = 0; corner < 4; ++corner)
+        {
+            corner_array[corner][axis] = plane;
+            corner_array[corner][u_axis] = corner == 1 || corner == 2 ? max[u_axis] : min[u_axis];
+            corner_array[corner][v_axis] = corner >= 2 ? max[v_axis] : min[v_axis];
+        }
+
+        occlusion_draw_quad(occlusion, corner_array);
+    }
+}
+
+void occlusion_build_pyramid(Occlusion* occlusion)
+{
+    for (u32 level = 1; level < OCCLUSION_LEVEL_COUNT; ++level)
+    {
+        const u32 source_width = occlusion->level_width_array[level - 1];
+        const u32 source_height = occlusion->level_height_array[level - 1];
+
+        const f32* source_array = &occlusion->depth_array[occlusion->level_offset_array[level - 1]];
+        f32* destination_array = &occlusion->depth_array[occlusion->level_offset_array[level]];
+
+        const u32 width = occlusion->level_width_array[level];
+        const u32 height = occlusion->level_height_array[level];
+
+        for (u32 y = 0; y < height; ++y)
+        {
+            const u32 source_y0 = 2 * y;
+            const u32 source_y1 = 2 * y + 1 < source_height ? 2 * y + 1 : source_y0;
+
+            for (u32 x = 0; x < width; ++x)
+            {
+                const u32 source_x0 = 2 * x;
+                const u32 source_x1 = 2 * x + 1 < source_width ? 2 * x + 1 : source_x0;
+
+                const f32 depth_00 = source_array[source_y0 * source_width + source_x0];
+                const f32 depth_10 = source_array[source_y0 * source_width + source_x1];
+                const f32 depth_01 = source_array[source_y1 * source_width + source_x0];
+                const f32 depth_11 = source_array[source_y1 * source_width + source_x1];
+
+                const f32 depth_0 = depth_00 > depth_10 ? depth_00 : depth_10;
+                const f32 depth_1 = depth_01 > depth_11 ? depth_01 : depth_11;
+
+                destination_array[y * width + x] = depth_0 > depth_1 ? depth_0 : depth_1;
+            }
+        }
+    }
+}
+
+bool occlusion_is_box_visible(Occlusion* occlusion, const vec3 min, const vec3 max)
+{
+    f32 min_x = FLT_MAX;
+    f32 min_y = FLT_MAX;
+    f32 max_x = -FLT_MAX;
+    f32 max_y = -FLT_MAX;
+    f32 min_depth = FLT_MAX;
+
+    for (u32 corner = 0; corner < 8; ++corner)
+    {
+        const vec3 position =
+        {
+            corner & 1 ? max[0] : min[0],
+            corner & 2 ? max[1] : min[1],
+            corner & 4 ? max[2] : min[2],
+        };
+
+        vec3 screen;
+
+        if (!occlusion_project(occlusion, position, screen))
+        {
+            return true;
+        }
+
+        min_x = screen[0] < min_x ? screen[0] : min_x;
+        min_y = screen[1] < min_y ? screen[1] : min_y;
+        max_x = screen[0] > max_x ? screen[0] : max_x;
+        max_y = screen[1] > max_y ? screen[1] : max_y;
+        min_depth = screen[2] < min_depth ? screen[2] : min_depth;
+    }
+
+    // Off screen boxes are left to the frustum
+
+    const i32 first_x = min_x > 0.0f ? (i32)min_x : 0;
+    const i32 first_y = min_y > 0.0f ? (i32)min_y : 0;
+    const i32 last_x = max_x < OCCLUSION_WIDTH - 1 ? (i32)max_x : OCCLUSION_WIDTH - 1;
+    const i32 last_y = max_y < OCCLUSION_HEIGHT - 1 ? (i32)max_y : OCCLUSION_HEIGHT - 1;
+
+    if (first_x > last_x || first_y > last_y)
+    {
+        return true;
+    }
+
+    u32 level = 0;
+
+    while (
+        level + 1 < OCCLUSION_LEVEL_COUNT &&
+        ((last_x >> level) - (first_x >> level) > 1 || (last_y >> level) - (first_y >> level) > 1)
+    ) {
+        level++;
+    }
+
+    const u32 width = occlusion->level_width_array[level];
+    const f32* depth_array = &occlusion->depth_array[occlusion->level_offset_array[level]];
+
+    f32 max_depth = 0.0f;
+
+    for (i32 y = first_y >> level; y <= last_y >> level; ++y)
+    {
+        for (i32 x = first_x >> level; x <= last_x >> level; ++x)
+        {
+            max_depth = depth_array[y * width + x] > max_depth ? depth_array[y * width + x] : max_depth;
+        }
+    }
+
+    if (min_depth > max_depth)
+    {
+        occlusion->hidden_box_count++;
+
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H 1
+
+#include <cglm/cglm.h>
+
+#include "core/types.h"
+
+// Occlusion culling against a low resolution depth buffer drawn on the CPU.
+// Occluders are solid slabs, such as the boundary layer of cells of a sector
+// that is all solid. A slab hides everything behind its far side, so only
+// that side is drawn, and only where it covers a whole pixel, at the
+// furthest depth it reaches over the pixel. The buffer never holds a depth
+// nearer than real geometry.
+//
+// A pyramid of depth levels then keeps the furthest depth of each 2 x 2
+// block of the level below. A box is hidden when its nearest corner lies
+// behind the furthest depth of the few texels of the level where its screen
+// rectangle spans at most 2 x 2 texels. Boxes crossing the near plane are
+// always visible.
+
+#define OCCLUSION_WIDTH 256
+#define OCCLUSION_HEIGHT 128
+
+#define OCCLUSION_LEVEL_COUNT 9
+
+typedef struct Occlusion
+{
+    mat4 projection_view_matrix;
+    vec3 camera_position;
+
+    u32 level_width_array[OCCLUSION_LEVEL_COUNT];
+    u32 level_height_array[OCCLUSION_LEVEL_COUNT];
+    u32 level_offset_array[OCCLUSION_LEVEL_COUNT];
+
+    // Depth of every level, finest first, cleared to the far plane
+
+    f32* depth_array;
+
+    // Statistics of the current frame
+
+    u32 occluder_face_count;
+    u32 hidden_box_count;
+}
+Occlusion;
+
+Occlusion* occlusion_create(void);
+void occlusion_destroy(Occlusion* occlusion);
+
+void occlusion_begin(Occlusion* occlusion, mat4 projection_view_matrix, const vec3 camera_position);
+
+// Draws the slabs of the given thickness along the inside of the faces of a
+// box, one per bit of the face mask, indexed as GridDirection
+
+void occlusion_draw_box_faces(Occlusion* occlusion, const vec3 min, const vec3 max, f32 thickness, u32 face_mask);
+
+void occlusion_build_pyramid(Occlusion* occlusion);
+
+bool occlusion_is_box_visible(Occlusion* occlusion, const vec3 min, const vec3 max);
+
+#endif
@@ -24,20 +24,29 @@ void render_destroy(Render* render)
 
     vkDeviceWaitIdle(device);
 
+    render_vulkan_destroy_mesh_context(render);
+
     render_vulkan_destroy_voxel_pipeline(render);
     render_vulkan_destroy_nuklear_pipeline(render);
 
     render_vulkan_destroy_frame_context(render);
 
+    render_vulkan_destroy_cull_pipeline(render);
+
     render_vulkan_destroy_swapchain_context(render);
 
+    render_vulkan_destroy_staging_context(render);
+    render_vulkan_destroy_memory_context(render);
+    render_vulkan_destroy_upload_context(render);
     render_vulkan_destroy_device_context(render);
 
     free(render);
 }
 
-void render_init(Render* render, Platform* platform)
+void render_init(Render* render, Platform* platform, JobSystem* job_system)
 {
+    render->job_system = job_system;
+
     render->window_width = WINDOW_WIDTH;
     render->window_height = WINDOW_HEIGHT;
 
@@ -63,11 +72,16 @@ void render_init(Render* render, Platform* platform)
     );
 
     render_vulkan_create_and_init_device_context(render, platform);
+    render_vulkan_create_and_init_upload_context(render);
+    render_vulkan_create_and_init_memory_context(render);
+    render_vulkan_create_and_init_staging_context(render);
     render_vulkan_create_and_init_swapchain_context(render);
+    render_vulkan_create_and_init_cull_pipeline(render);
     render_vulkan_create_and_init_voxel_pipeline(render);
     render_vulkan_create_and_init_frame_context(render);
 
-    render_vulkan_create_voxel_mesh(render);
+    render_vulkan_create_voxel_texture(render);
+    render_vulkan_create_and_init_mesh_context(render);
 
     render_nuklear_init(render);
 
@@ -89,6 +103,9 @@ void render_update(Render* render, World* world, f64 delta_time)
 
     glm_vec3_copy(world->camera.position, render->position);
     glm_mat4_mul(render->projection_matrix, render->view_matrix, render->projection_view_matrix);
+
+    render_vulkan_update_world_mesh(render, world);
+    render_vulkan_cull_world_mesh(render, world);
 }
 
 void render_begin_frame(Render* render, VulkanFrame* vulkan_frame)
@@ -100,6 +117,11 @@ void render_begin_frame(Render* render, VulkanFrame* vulkan_frame)
         VK_TRUE,
         UINT64_MAX
     );
+
+    // Uploads complete in the background, and are only checked on here
+
+    render_vulkan_poll_uploads(render);
+    render_vulkan_poll_staging(render);
 }
 
 bool render_record_frame(Render* render, VulkanFrame* vulkan_frame)
@@ -149,16 +171,38 @@ void render_submit_frame(Render* render, VulkanFrame* vulkan_frame)
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
     };
 
+    // The frame also signals the upload timeline, which releases the
+    // staging bytes its copies read. The value is ignored for the binary
+    // semaphore.
+
+    const VulkanUploadTicket ticket = render_vulkan_take_upload_ticket(render);
+
+    VkSemaphore signal_semaphore_array[] =
+    {
+        vulkan_frame->render_finished_semaphore,
+        render->vulkan_upload_context.timeline_semaphore,
+    };
+
+    const u64 signal_value_array[] = { 0, ticket };
+
+    VkTimelineSemaphoreSubmitInfo timeline_submit_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .signalSemaphoreValueCount = 2,
+        .pSignalSemaphoreValues = signal_value_array,
+    };
+
     VkSubmitInfo submit_info =
     {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_submit_info,
         .waitSemaphoreCount = 1,
         .pWaitSemaphores = &vulkan_frame->image_available_semaphore,
         .pWaitDstStageMask = wait_stage_array,
         .commandBufferCount = 1,
         .pCommandBuffers = &vulkan_frame->command_buffer,
-        .signalSemaphoreCount = 1,
-        .pSignalSemaphores = &vulkan_frame->render_finished_semaphore,
+        .signalSemaphoreCount = 2,
+        .pSignalSemaphores = signal_semaphore_array,
     };
 
     vkQueueSubmit(
@@ -167,6 +211,8 @@ void render_submit_frame(Render* render, VulkanFrame* vulkan_frame)
         &submit_info,
         vulkan_frame->in_flight_fence
     );
+
+    render_vulkan_retire_staging_frame(render, ticket);
 }
 
 void render_present_frame(Render* render, VulkanFrame* vulkan_frame)
@@ -11,10 +11,55 @@
 #include "nuklear/nuklear.h"
 
 #include "core/types.h"
+#include "core/job/job.h"
 #include "platform/platform.h"
+#include "render/cull.h"
+#include "render/mesh.h"
+#include "render/occlusion.h"
+#include "render/tlsf.h"
+#include "render/vertex_arena.h"
 
 #define MAX_FRAMES_IN_FLIGHT 2
-#define CUBE_RADIUS 0.5f
+
+#define MAX_REMESH_SECTORS_PER_FRAME 64
+
+// Sectors closer to the camera than this many sectors are meshed at full
+// resolution, and each further level of detail covers twice the distance of
+// the previous one
+
+#define LOD_DISTANCE_IN_SECTORS 1.5f
+
+// A sector only moves to a finer level once it is this many sectors inside
+// the threshold, so a camera resting on a threshold does not remesh every
+// frame
+
+#define LOD_HYSTERESIS_IN_SECTORS 0.1f
+
+// Vertices of the buffer every sector mesh is suballocated from
+
+#define VERTEX_ARENA_CAPACITY (4 * 1024 * 1024)
+
+// Sectors culled by each invocation group of cull.comp
+
+#define CULL_WORKGROUP_SIZE 64
+
+// Device memory is suballocated from blocks of this size, one set of blocks
+// per memory type. Resources at least the dedicated size get an allocation
+// of their own.
+
+#define VULKAN_MEMORY_BLOCK_SIZE        (64ull * 1024 * 1024)
+#define VULKAN_MEMORY_DEDICATED_SIZE    (VULKAN_MEMORY_BLOCK_SIZE / 2)
+
+// Uploads stage their bytes in one persistently mapped ring of this size,
+// and at most this many copies are recorded per frame
+
+#define VULKAN_STAGING_RING_SIZE        (16ull * 1024 * 1024)
+#define VULKAN_STAGING_ALIGNMENT        16
+#define VULKAN_STAGING_MAX_COPY_COUNT   256
+
+// Submissions reading the ring that may be in flight at once
+
+#define VULKAN_STAGING_MAX_RELEASE_COUNT 16
 
 #define NUKLEAR_MAX_VERTEX_BUFFER  (512 * 1024)
 #define NUKLEAR_MAX_INDEX_BUFFER   (128 * 1024)
@@ -22,74 +67,192 @@
 typedef struct Platform Platform;
 typedef struct World World;
 
-typedef struct Vertex
+typedef struct Image
 {
-    vec3 position;
-    vec2 uv;
+    u32 width;
+    u32 height;
+
+    u32 channels;
+
+    u8* pixels;
+}
+Image;
+
+// Buffers and linear images never share a block with optimal images, so no
+// two neighbors in a block are ever subject to bufferImageGranularity
+
+typedef enum VulkanMemoryKind
+{
+    VULKAN_MEMORY_KIND_LINEAR,
+    VULKAN_MEMORY_KIND_OPTIMAL,
+    VULKAN_MEMORY_KIND_COUNT
 }
-Vertex;
+VulkanMemoryKind;
+
+// A range of device memory bound to one resource, mapped when its memory
+// type is host visible. Dedicated allocations have no block.
 
-static const Vertex cube_vertex_array[] =
+typedef struct VulkanAllocation
 {
-    // +X
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS }, { +1.0f, +1.0f}},
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS }, { +1.0f, +0.0f}},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS }, { +0.0f, +0.0f}},
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS }, { +1.0f, +1.0f}},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS }, { +0.0f, +0.0f}},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS }, { +0.0f, +1.0f}},
-
-    // -X
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS }, { +0.0f, +0.0f }},
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS }, { +0.0f, +1.0f }},
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS }, { +1.0f, +1.0f }},
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS }, { +0.0f, +0.0f }},
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS }, { +1.0f, +1.0f }},
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS }, { +1.0f, +0.0f }},
-
-    // +Y
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS }, { +0.0f, +1.0f }},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS }, { +1.0f, +1.0f }},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS }, { +1.0f, +0.0f }},
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS }, { +0.0f, +1.0f }},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS }, { +1.0f, +0.0f }},
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS }, { +0.0f, +0.0f }},
-
-    // -Y
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS }, { +0.0f, +0.0f }},
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS }, { +1.0f, +0.0f }},
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS }, { +1.0f, +1.0f }},
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS }, { +0.0f, +0.0f }},
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS }, { +1.0f, +1.0f }},
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS }, { +0.0f, +1.0f }},
-
-    // +Z
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS}, { +0.0f, +1.0f }},
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS}, { +0.0f, +0.0f }},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS}, { +1.0f, +0.0f }},
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, +CUBE_RADIUS}, { +0.0f, +1.0f }},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS}, { +1.0f, +0.0f }},
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, +CUBE_RADIUS}, { +1.0f, +1.0f }},
-
-    // -Z
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS}, { +0.0f, +1.0f}},
-    {{ -CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS}, { +0.0f, +0.0f}},
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS}, { +1.0f, +0.0f}},
-    {{ +CUBE_RADIUS, -CUBE_RADIUS, -CUBE_RADIUS}, { +0.0f, +1.0f}},
-    {{ -CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS}, { +1.0f, +0.0f}},
-    {{ +CUBE_RADIUS, +CUBE_RADIUS, -CUBE_RADIUS}, { +1.0f, +1.0f}},
-};
+    VkDeviceMemory memory;
+    VkDeviceSize offset;
+    VkDeviceSize size;
 
-typedef struct Image
+    void* mapped;
+
+    u32 memory_type_index;
+    VulkanMemoryKind kind;
+
+    u32 block_index;
+    u32 tlsf_block;
+}
+VulkanAllocation;
+
+typedef struct VulkanMemoryBlock
+{
+    VkDeviceMemory memory;
+    Tlsf* tlsf;
+
+    void* mapped;
+}
+VulkanMemoryBlock;
+
+// Blocks of one memory type and kind. Emptied blocks are released, except
+// the last one, and their slot reused.
+
+typedef struct VulkanMemoryPool
+{
+    u32 block_count;
+    u32 block_capacity;
+    VulkanMemoryBlock* block_array;
+}
+VulkanMemoryPool;
+
+typedef struct VulkanMemoryHeapStats
+{
+    u32 block_count;
+    VkDeviceSize block_size;
+
+    u32 allocation_count;
+    VkDeviceSize used_size;
+
+    u32 dedicated_count;
+    VkDeviceSize dedicated_size;
+}
+VulkanMemoryHeapStats;
+
+typedef struct VulkanMemoryContext
+{
+    VkPhysicalDeviceMemoryProperties memory_properties;
+
+    u32 device_allocation_count;
+    u32 max_device_allocation_count;
+
+    VulkanMemoryPool pool_array[VK_MAX_MEMORY_TYPES][VULKAN_MEMORY_KIND_COUNT];
+
+    VulkanMemoryHeapStats heap_stats_array[VK_MAX_MEMORY_HEAPS];
+}
+VulkanMemoryContext;
+
+// Submissions that signal the upload timeline are identified by the value
+// they signal it to, counting up from one. A ticket is complete once the
+// timeline has reached it.
+
+typedef u64 VulkanUploadTicket;
+
+typedef struct VulkanUploadSubmission
 {
+    VkCommandBuffer command_buffer;
+    VulkanUploadTicket ticket;
+}
+VulkanUploadSubmission;
+
+// Upload command buffers in flight, oldest first, freed once polling finds
+// their ticket complete
+
+typedef struct VulkanUploadContext
+{
+    VkSemaphore timeline_semaphore;
+
+    VulkanUploadTicket submitted_ticket;
+    VulkanUploadTicket completed_ticket;
+
+    u32 submission_count;
+    u32 submission_capacity;
+    VulkanUploadSubmission* submission_array;
+}
+VulkanUploadContext;
+
+// A staged range of the ring waiting to be copied into a buffer, or into a
+// whole image along with its transitions from undefined to shader read
+
+typedef enum VulkanStagingCopyKind
+{
+    VULKAN_STAGING_COPY_KIND_BUFFER,
+    VULKAN_STAGING_COPY_KIND_IMAGE
+}
+VulkanStagingCopyKind;
+
+typedef struct VulkanStagingCopy
+{
+    VulkanStagingCopyKind kind;
+
+    VkDeviceSize staging_offset;
+    VkDeviceSize size;
+
+    VkBuffer dst_buffer;
+    VkDeviceSize dst_offset;
+
+    VkImage dst_image;
     u32 width;
     u32 height;
+}
+VulkanStagingCopy;
 
-    u32 channels;
+// The head a submission reading the ring reached, released once its ticket
+// completes
 
-    u8* pixels;
+typedef struct VulkanStagingRelease
+{
+    u64 head;
+    VulkanUploadTicket ticket;
 }
-Image;
+VulkanStagingRelease;
+
+// Bytes are reserved at the head of the ring and released from its tail.
+// Both count up without wrapping, so their difference is the staged size.
+// The copies of a frame are recorded ahead of its render pass, and go out
+// early on their own when the ring or the copy list fills up.
+
+typedef struct VulkanStagingContext
+{
+    VkBuffer buffer;
+    VulkanAllocation allocation;
+
+    u64 head;
+    u64 tail;
+
+    // Head of the copies recorded into the frame being built
+
+    u64 recorded_head;
+
+    u32 release_count;
+    VulkanStagingRelease release_array[VULKAN_STAGING_MAX_RELEASE_COUNT];
+
+    u32 copy_count;
+    VulkanStagingCopy copy_array[VULKAN_STAGING_MAX_COPY_COUNT];
+
+    // Statistics of the most recent flush, the number of times copies went
+    // out ahead of their frame, and the number of times staging had to wait
+    // for the GPU to release bytes
+
+    VkDeviceSize flushed_size;
+    u32 flushed_copy_count;
+
+    u32 early_flush_count;
+    u32 stall_count;
+}
+VulkanStagingContext;
 
 typedef struct VulkanTexture
 {
@@ -98,7 +261,7 @@ typedef struct VulkanTexture
 
     VkImage image;
     VkImageView image_view;
-    VkDeviceMemory image_memory;
+    VulkanAllocation image_allocation;
     VkSampler sampler;
 }
 VulkanTexture;
@@ -117,7 +280,7 @@ typedef struct VulkanSwapchainContext
 
     VkFormat depth_format;
     VkImage depth_image;
-    VkDeviceMemory depth_memory;
+    VulkanAllocation depth_allocation;
     VkImageView depth_image_view;
 
     VkFramebuffer* framebuffer_array;
@@ -129,17 +292,155 @@ typedef struct VulkanPipelineContext
     VkPipelineLayout layout;
     VkPipeline pipeline;
 
+    // Voxel only: draws instanced faces with the same layout
+
+    VkPipeline face_pipeline;
+
     VkDescriptorSetLayout descriptor_set_layout;
     VkDescriptorPool descriptor_pool;
     VkDescriptorSet descriptor_set;
 
-    VkBuffer vertex_buffer;
-    VkDeviceMemory vertex_memory;
-    
     VulkanTexture vulkan_texture;
 }
 VulkanPipelineContext;
 
+typedef struct VulkanSectorMesh
+{
+    u32 vertex_count;
+    u32 face_count;
+    u32 triangle_count;
+
+    // Level of detail the sector is meshed at, from its distance to the
+    // camera
+
+    u32 lod;
+
+    f64 build_time;
+
+    vec3 origin_position;
+
+    // Range of the vertex arena holding the mesh's vertices followed by its
+    // faces, empty when the mesh has neither
+
+    u32 first_vertex;
+
+    // The latest mesh found no room in the vertex arena and was dropped
+
+    bool is_deferred;
+}
+VulkanSectorMesh;
+
+// Sector meshes are built on the job system, one job per sector, into a
+// CPU mesh owned by the job. The render thread uploads them once done.
+
+typedef struct VulkanMeshJob
+{
+    World* world;
+    SectorIndex sector_index;
+
+    MeshMode mesh_mode;
+    u32 lod;
+    u32 skirt_direction_mask;
+
+    Mesh* mesh;
+
+    f64 build_time;
+}
+VulkanMeshJob;
+
+typedef struct VulkanMeshContext
+{
+    bool is_built;
+
+    MeshMode mesh_mode;
+
+    bool is_lod_enabled;
+
+    JobCounter job_counter;
+
+    Job* job_array;
+    VulkanMeshJob* mesh_job_array;
+
+    SectorIndex* remesh_sector_index_array;
+
+    u32 triangle_count;
+
+    // Statistics of the most recent remesh
+
+    u32 remesh_sector_count;
+    f64 build_time;
+    f64 wall_time;
+    f64 max_sector_build_time;
+
+    u32 sector_mesh_count;
+    VulkanSectorMesh* sector_mesh_array;
+
+    // Every sector mesh lives in one device local vertex buffer, so all of
+    // them are drawn without binding another
+
+    VertexArena* vertex_arena;
+
+    VkBuffer vertex_arena_buffer;
+    VulkanAllocation vertex_arena_allocation;
+
+    // Sectors whose mesh was dropped for want of room are meshed again only
+    // once a range has been freed since, rather than every frame
+
+    u32 deferred_sector_count;
+    bool is_vertex_arena_freed;
+
+    // Sector meshes are culled in groups of 2 x 2 x 2 window slots. The cull
+    // slot of every sector index places it in its group.
+
+    bool is_culling_enabled;
+
+    Cull* cull;
+    u32* cull_slot_array;
+
+    // Sectors in the frustum are then tested against the depth of the solid
+    // faces of the sectors drawn on the CPU
+
+    bool is_occlusion_enabled;
+
+    Occlusion* occlusion;
+
+    // Sectors to draw this frame, and the time it took to select them
+
+    u32 visible_sector_count;
+    SectorIndex* visible_sector_index_array;
+
+    u32 frustum_visible_sector_count;
+
+    f64 cull_time;
+    f64 occlusion_time;
+
+    // With GPU culling all sector meshes are drawn with one indirect draw,
+    // whose commands a compute pass writes with no instances for those
+    // outside the frustum. The visible count is read back once the frame
+    // completes.
+
+    bool is_gpu_culling_enabled;
+
+    u32 gpu_visible_sector_count;
+}
+VulkanMeshContext;
+
+// Bounds and arena range of a sector mesh, as read by cull.comp and by
+// voxel.vert and voxel_face.vert for the sector they draw. The minimum corner
+// holds the cell size in w.
+
+typedef struct VulkanCullSector
+{
+    vec4 min_position;
+    vec4 max_position;
+
+    u32 vertex_count;
+    u32 first_vertex;
+    u32 face_count;
+    u32 padding;
+}
+VulkanCullSector;
+
 typedef struct VulkanFrame
 {
     u32 image_index;
@@ -150,6 +451,23 @@ typedef struct VulkanFrame
     VkSemaphore render_finished_semaphore;
 
     VkFence in_flight_fence;
+
+    // Sector bounds written by the CPU, draw commands written by the cull
+    // pass, and the number of visible sectors it counted. The commands of
+    // every sector's vertices are followed by those of its faces.
+
+    VkDescriptorSet cull_descriptor_set;
+
+    VkBuffer cull_sector_buffer;
+    VulkanAllocation cull_sector_allocation;
+    VulkanCullSector* cull_sector_array;
+
+    VkBuffer draw_command_buffer;
+    VulkanAllocation draw_command_allocation;
+
+    VkBuffer visible_count_buffer;
+    VulkanAllocation visible_count_allocation;
+    u32* visible_count;
 }
 VulkanFrame;
 
@@ -177,12 +495,26 @@ typedef struct VulkanDeviceContext
 }
 VulkanDeviceContext;
 
+// Instanced faces add the draw index to the sector index to find their
+// sector, as they have no instance index to spare for it
+
 typedef struct VoxelPushConstants
 {
     mat4 projection_view_matrix;
+    u32 sector_index;
 }
 VoxelPushConstants;
 
+// The frustum planes and the number of sectors, pushed once per cull
+// dispatch
+
+typedef struct CullPushConstants
+{
+    vec4 plane_array[CULL_PLANE_COUNT];
+    u32 sector_count;
+}
+CullPushConstants;
+
 typedef struct NkVertex
 {
     float position[2];
@@ -219,11 +551,11 @@ typedef struct NuklearContext
     VkSampler font_sampler;
 
     VkBuffer vertex_buffer;
-    VkDeviceMemory vertex_buffer_memory;
+    VulkanAllocation vertex_buffer_allocation;
     void* vertex_buffer_mapped;
 
     VkBuffer index_buffer;
-    VkDeviceMemory index_buffer_memory;
+    VulkanAllocation index_buffer_allocation;
     void* index_buffer_mapped;
 
     u32 vertex_count;
@@ -245,21 +577,29 @@ typedef struct Render
     mat4 projection_view_matrix;
 
     VulkanDeviceContext vulkan_device_context;
+    VulkanMemoryContext vulkan_memory_context;
+    VulkanUploadContext vulkan_upload_context;
+    VulkanStagingContext vulkan_staging_context;
     VulkanSwapchainContext vulkan_swapchain_context;
     
     VulkanPipelineContext voxel_pipeline_context;
     VulkanPipelineContext nuklear_pipeline_context;
+    VulkanPipelineContext cull_pipeline_context;
+
+    VulkanMeshContext vulkan_mesh_context;
 
     VulkanFrameContext vulkan_frame_context;
 
     NuklearContext nuklear_context;
+
+    JobSystem* job_system;
 }
 Render;
 
 Render* render_create(Platform* platform);
 void render_destroy(Render* render);
 
-void render_init(Render* render, Platform* platform);
+void render_init(Render* render, Platform* platform, JobSystem* job_system);
 void render_update(Render* render, World* world, f64 delta_time);
 
 void render_begin_frame(Render* render, VulkanFrame* vulkan_frame);
@@ -308,12 +648,17 @@ void render_vulkan_update_texture_descriptor(
     VkSampler sampler
 );
 
+void render_vulkan_update_face_descriptor(Render* render, VkBuffer buffer, VkDeviceSize size);
+
 void render_vulkan_create_and_init_voxel_pipeline(Render* render);
 void render_vulkan_destroy_voxel_pipeline(Render* render);
 
 void render_vulkan_create_and_init_nuklear_pipeline(Render* render);
 void render_vulkan_destroy_nuklear_pipeline(Render* render);
 
+void render_vulkan_create_and_init_cull_pipeline(Render* render);
+void render_vulkan_destroy_cull_pipeline(Render* render);
+
 // VULKAN FRAME
 
 void render_vulkan_create_and_init_frame_context(Render* render);
@@ -321,26 +666,42 @@ void render_vulkan_destroy_frame_context(Render* render);
 
 void render_vulkan_create_and_init_frame_context(Render* render);
 
+void render_vulkan_record_cull_commands(Render* render, VkCommandBuffer command_buffer, VulkanFrame* vulkan_frame);
 void render_vulkan_record_command_buffer(Render* render, VkCommandBuffer command_buffer, u32 image_index);
 void render_vulkan_draw_frame(Render* render);
 
 // VULKAN MEMORY
 
+void render_vulkan_create_and_init_memory_context(Render* render);
+void render_vulkan_destroy_memory_context(Render* render);
+
 u32 render_vulkan_locate_memory_type(
     Render* render,
     u32 type_filter,
     VkMemoryPropertyFlags properties
 );
 
+void render_vulkan_allocate_memory(
+    Render* render,
+    const VkMemoryRequirements* mem_requirements,
+    VkMemoryPropertyFlags properties,
+    VulkanMemoryKind kind,
+    VulkanAllocation* allocation
+);
+
+void render_vulkan_free_memory(Render* render, VulkanAllocation* allocation);
+
 void render_vulkan_create_buffer(
     Render* render,
     VkDeviceSize size,
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer* buffer,
-    VkDeviceMemory* memory
+    VulkanAllocation* allocation
 );
 
+void render_vulkan_destroy_buffer(Render* render, VkBuffer buffer, VulkanAllocation* allocation);
+
 void render_vulkan_create_image(
     Render* render,
     u32 width,
@@ -350,9 +711,11 @@ void render_vulkan_create_image(
     VkImageUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkImage* image,
-    VkDeviceMemory* memory
+    VulkanAllocation* allocation
 );
 
+void render_vulkan_destroy_image(Render* render, VkImage image, VulkanAllocation* allocation);
+
 VkImageView render_vulkan_create_image_view(
     Render* render,
     VkImage image,
@@ -361,36 +724,13 @@ VkImageView render_vulkan_create_image_view(
 
 VkSampler render_vulkan_create_sampler(Render* render);
 
-void render_vulkan_transition_image_layout(
-    Render* render,
-    VkImage image,
-    VkFormat format,
-    VkImageLayout old_layout,
-    VkImageLayout new_layout
-);
-
-void render_vulkan_copy_buffer(
-    Render* render,
-    VkBuffer src_buffer,
-    VkBuffer dst_buffer,
-    VkDeviceSize size
-);
-
-void render_vulkan_copy_buffer_to_image(
-    Render* render,
-    VkBuffer buffer,
-    VkImage image,
-    u32 width,
-    u32 height
-);
-
 void render_vulkan_create_texture_from_pixels(
     Render* render,
     const void* pixels,
     u32 width,
     u32 height,
     VkImage* image,
-    VkDeviceMemory* image_memory,
+    VulkanAllocation* image_allocation,
     VkImageView* image_view,
     VkSampler* sampler
 );
@@ -399,25 +739,57 @@ void render_vulkan_create_texture_from_file(
     Render* render,
     const char* path,
     VkImage* image,
-    VkDeviceMemory* image_memory,
+    VulkanAllocation* image_allocation,
     VkImageView* image_view,
     VkSampler* sampler
 );
 
-void render_vulkan_create_voxel_mesh(Render* render);
+void render_vulkan_create_voxel_texture(Render* render);
+
+// VULKAN MESH
+
+void render_vulkan_create_and_init_mesh_context(Render* render);
+void render_vulkan_destroy_mesh_context(Render* render);
+
+void render_vulkan_update_sector_mesh(Render* render, World* world, SectorIndex sector_index);
+void render_vulkan_update_world_mesh(Render* render, World* world);
+void render_vulkan_cull_world_mesh(Render* render, World* world);
 
 // VULKAN COMMANDS
 
+void render_vulkan_create_and_init_upload_context(Render* render);
+void render_vulkan_destroy_upload_context(Render* render);
+
+// Single time commands are submitted without waiting. Their ticket tells
+// when they are done, and their command buffer is freed by a later poll.
+
 VkCommandBuffer render_vulkan_begin_single_time_commands(Render* render);
-void render_vulkan_end_single_time_commands(Render* render, VkCommandBuffer command_buffer);
+VulkanUploadTicket render_vulkan_end_single_time_commands(Render* render, VkCommandBuffer command_buffer);
 
-void render_vulkan_copy_buffer_to_image(
-    Render* render,
-    VkBuffer buffer,
-    VkImage image,
-    u32 width,
-    u32 height
-);
+// Takes the ticket of a submission made elsewhere, which must signal the
+// timeline semaphore to it
+
+VulkanUploadTicket render_vulkan_take_upload_ticket(Render* render);
+
+VulkanUploadTicket render_vulkan_poll_uploads(Render* render);
+bool render_vulkan_is_upload_complete(Render* render, VulkanUploadTicket ticket);
+void render_vulkan_wait_upload(Render* render, VulkanUploadTicket ticket);
+
+// VULKAN STAGING
+
+void render_vulkan_create_and_init_staging_context(Render* render);
+void render_vulkan_destroy_staging_context(Render* render);
+
+// Reserve staging bytes for a copy recorded with the next frame, returning
+// where to write them before then, or NULL when they exceed the ring
+
+void* render_vulkan_stage_buffer_copy(Render* render, VkBuffer dst_buffer, VkDeviceSize dst_offset, VkDeviceSize size);
+void* render_vulkan_stage_image_copy(Render* render, VkImage dst_image, u32 width, u32 height);
+
+void render_vulkan_poll_staging(Render* render);
+
+void render_vulkan_record_staging_commands(Render* render, VkCommandBuffer command_buffer);
+void render_vulkan_retire_staging_frame(Render* render, VulkanUploadTicket ticket);
 
 // NUKLEAR
 
@@ -0,0 +1,395 @@
+#include "render/tlsf.h"
+
+#include <stdlib.h>
+
+#include "core/log/log.h"
+
+#define TLSF_INITIAL_BLOCK_CAPACITY 64
+
+// Largest size the first level bins cover
+
+#define TLSF_MAX_SIZE (1ull << (TLSF_FIRST_LEVEL_COUNT + TLSF_SMALL_LOG2 - 1))
+
+static inline u64 tlsf_align_up(u64 value, u64 alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Bin of a size: small sizes split the first bin linearly, larger ones take
+// the bin of their log2 and the sub-bin of the bits below it
+
+static inline void tlsf_get_bin(u64 size, u32* out_first_level, u32* out_second_level)
+{
+    if (size < TLSF_SMALL_SIZE)
+    {
+        *out_first_level = 0;
+        *out_second_level = (u32)(size / TLSF_MIN_BLOCK_SIZE);
+
+        return;
+    }
+
+    const u32 size_log2 = 63 - (u32)__builtin_clzll(size);
+
+    *out_first_level = size_log2 - TLSF_SMALL_LOG2 + 1;
+    *out_second_level = (u32)(size >> (size_log2 - TLSF_SECOND_LEVEL_LOG2)) ^ TLSF_SECOND_LEVEL_COUNT;
+}
+
+// Rounds a size up to the next sub-bin boundary, so that every block of the
+// bin it maps to holds it
+
+static inline u64 tlsf_round_up_to_bin(u64 size)
+{
+    if (size < TLSF_SMALL_SIZE)
+    {
+        return size;
+    }
+
+    const u32 size_log2 = 63 - (u32)__builtin_clzll(size);
+    const u64 sub_bin_size = 1ull << (size_log2 - TLSF_SECOND_LEVEL_LOG2);
+
+    return tlsf_align_up(size, sub_bin_size);
+}
+
+static u32 tlsf_create_block(Tlsf* tlsf, u64 offset, u64 size)
+{
+    u32 block;
+
+    if (tlsf->unused_block != TLSF_NULL_BLOCK)
+    {
+        block = tlsf->unused_block;
+        tlsf->unused_block = tlsf->block_array[block].next_free_block;
+    }
+    else
+    {
+        if (tlsf->block_count == tlsf->block_capacity)
+        {
+            const u32 block_capacity = tlsf->block_capacity * 2;
+
+            TlsfBlock* block_array = realloc(tlsf->block_array, sizeof(TlsfBlock) * block_capacity);
+
+            if (!block_array)
+            {
+                LOG_FATAL("Failed to grow TLSF blocks");
+            }
+
+            tlsf->block_capacity = block_capacity;
+            tlsf->block_array = block_array;
+        }
+
+        block = tlsf->block_count++;
+    }
+
+    TlsfBlock* tlsf_block = &tlsf->block_array[block];
+
+    tlsf_block->offset = offset;
+    tlsf_block->size = size;
+    tlsf_block->previous_physical_block = TLSF_NULL_BLOCK;
+    tlsf_block->next_physical_block = TLSF_NULL_BLOCK;
+    tlsf_block->previous_free_block = TLSF_NULL_BLOCK;
+    tlsf_block->next_free_block = TLSF_NULL_BLOCK;
+    tlsf_block->is_free = false;
+
+    return block;
+}
+
+static void tlsf_release_block(Tlsf* tlsf, u32 block)
+{
+    tlsf->block_array[block].next_free_block = tlsf->unused_block;
+    tlsf->unused_block = block;
+}
+
+static void tlsf_insert_free_block(Tlsf* tlsf, u32 block)
+{
+    TlsfBlock* tlsf_block = &tlsf->block_array[block];
+
+    u32 first_level;
+    u32 second_level;
+    tlsf_get_bin(tlsf_block->size, &first_level, &second_level);
+
+    const u32 head = tlsf->free_head_array[first_level][second_level];
+
+    tlsf_block->is_free = true;
+    tlsf_block->previous_free_block = TLSF_NULL_BLOCK;
+    tlsf_block->next_free_block = head;
+
+    if (head != TLSF_NULL_BLOCK)
+    {
+        tlsf->block_array[head].previous_free_block = block;
+    }
+
+    tlsf->free_head_array[first_level][second_level] = block;
+
+    tlsf->first_level_bitmap |= 1u << first_level;
+    tlsf->second_level_bitmap_array[first_level] |= 1u << second_level;
+
+    tlsf->free_block_count++;
+}
+
+static void tlsf_remove_free_block(Tlsf* tlsf, u32 block)
+{
+    TlsfBlock* tlsf_block = &tlsf->block_array[block];
+
+    u32 first_level;
+    u32 second_level;
+    tlsf_get_bin(tlsf_block->size, &first_level, &second_level);
+
+    if (tlsf_block->previous_free_block != TLSF_NULL_BLOCK)
+    {
+        tlsf->block_array[tlsf_block->previous_free_block].next_free_block = tlsf_block->next_free_block;
+    }
+    else
+    {
+        tlsf->free_head_array[first_level][second_level] = tlsf_block->next_free_block;
+    }
+
+    if (tlsf_block->next_free_block != TLSF_NULL_BLOCK)
+    {
+        tlsf->block_array[tlsf_block->next_free_block].previous_free_block = tlsf_block->previous_free_block;
+    }
+
+    if (tlsf->free_head_array[first_level][second_level] == TLSF_NULL_BLOCK)
+    {
+        tlsf->second_level_bitmap_array[first_level] &= ~(1u << second_level);
+
+        if (tlsf->second_level_bitmap_array[first_level] == 0)
+        {
+            tlsf->first_level_bitmap &= ~(1u << first_level);
+        }
+    }
+
+    tlsf_block->is_free = false;
+    tlsf_block->previous_free_block = TLSF_NULL_BLOCK;
+    tlsf_block->next_free_block = TLSF_NULL_BLOCK;
+
+    tlsf->free_block_count--;
+}
+
+// Splits the tail of a block past the size off into a new block, linked
+// after it in offset order
+
+static u32 tlsf_split_block(Tlsf* tlsf, u32 block, u64 size)
+{
+    const u32 tail_block = tlsf_create_block(
+        tlsf,
+        tlsf->block_array[block].offset + size,
+        tlsf->block_array[block].size - size
+    );
+
+    TlsfBlock* tlsf_block = &tlsf->block_array[block];
+    TlsfBlock* tlsf_tail_block = &tlsf->block_array[tail_block];
+
+    tlsf_block->size = size;
+
+    tlsf_tail_block->previous_physical_block = block;
+    tlsf_tail_block->next_physical_block = tlsf_block->next_physical_block;
+
+    if (tlsf_block->next_physical_block != TLSF_NULL_BLOCK)
+    {
+        tlsf->block_array[tlsf_block->next_physical_block].previous_physical_block = tail_block;
+    }
+
+    tlsf_block->next_physical_block = tail_block;
+
+    return tail_block;
+}
+
+// Merges a block into the block before it in offset order, releasing its
+// record
+
+static void tlsf_merge_into_previous(Tlsf* tlsf, u32 block)
+{
+    TlsfBlock* tlsf_block = &tlsf->block_array[block];
+
+    const u32 previous_block = tlsf_block->previous_physical_block;
+    TlsfBlock* tlsf_previous_block = &tlsf->block_array[previous_block];
+
+    tlsf_previous_block->size += tlsf_block->size;
+    tlsf_previous_block->next_physical_block = tlsf_block->next_physical_block;
+
+    if (tlsf_block->next_physical_block != TLSF_NULL_BLOCK)
+    {
+        tlsf->block_array[tlsf_block->next_physical_block].previous_physical_block = previous_block;
+    }
+
+    tlsf_release_block(tlsf, block);
+}
+
+Tlsf* tlsf_create(u64 size)
+{
+    if (size >= TLSF_MAX_SIZE)
+    {
+        LOG_FATAL("TLSF size %llu exceeds the largest bin", (unsigned long long)size);
+    }
+
+    Tlsf* tlsf = malloc(sizeof(*tlsf));
+
+    if (!tlsf)
+    {
+        LOG_FATAL("Failed to allocate TLSF");
+    }
+
+    tlsf->size = size & ~(TLSF_MIN_BLOCK_SIZE - 1);
+
+    tlsf->used_size = 0;
+    tlsf->allocation_count = 0;
+    tlsf->free_block_count = 0;
+
+    tlsf->first_level_bitmap = 0;
+
+    for (u32 first_level = 0; first_level < TLSF_FIRST_LEVEL_COUNT; ++first_level)
+    {
+        tlsf->second_level_bitmap_array[first_level] = 0;
+
+        for (u32 second_level = 0; second_level < TLSF_SECOND_LEVEL_COUNT; ++second_level)
+        {
+            tlsf->free_head_array[first_level][second_level] = TLSF_NULL_BLOCK;
+        }
+    }
+
+    tlsf->block_count = 0;
+    tlsf->block_capacity = TLSF_INITIAL_BLOCK_CAPACITY;
+    tlsf->block_array = malloc(sizeof(TlsfBlock) * tlsf->block_capacity);
+
+    if (!tlsf->block_array)
+    {
+        LOG_FATAL("Failed to allocate TLSF blocks");
+    }
+
+    tlsf->unused_block = TLSF_NULL_BLOCK;
+
+    if (tlsf->size > 0)
+    {
+        tlsf_insert_free_block(tlsf, tlsf_create_block(tlsf, 0, tlsf->size));
+    }
+
+    return tlsf;
+}
+
+void tlsf_destroy(Tlsf* tlsf)
+{
+    free(tlsf->block_array);
+    free(tlsf);
+}
+
+bool tlsf_allocate(Tlsf* tlsf, u64 size, u64 alignment, u32* out_block, u64* out_offset)
+{
+    if (size == 0)
+    {
+        return false;
+    }
+
+    size = tlsf_align_up(size, TLSF_MIN_BLOCK_SIZE);
+    alignment = alignment > TLSF_MIN_BLOCK_SIZE ? alignment : TLSF_MIN_BLOCK_SIZE;
+
+    // Block offsets are only aligned to the minimum block size, so a larger
+    // alignment may cost up to its difference in padding
+
+    const u64 search_size = tlsf_round_up_to_bin(size + alignment - TLSF_MIN_BLOCK_SIZE);
+
+    if (search_size >= TLSF_MAX_SIZE)
+    {
+        return false;
+    }
+
+    u32 first_level;
+    u32 second_level;
+    tlsf_get_bin(search_size, &first_level, &second_level);
+
+    u32 second_level_bitmap = tlsf->second_level_bitmap_array[first_level] & (~0u << second_level);
+
+    if (second_level_bitmap == 0)
+    {
+        const u32 first_level_bitmap = first_level + 1 < TLSF_FIRST_LEVEL_COUNT ? tlsf->first_level_bitmap & (~0u << (first_level + 1)) : 0;
+
+        if (first_level_bitmap == 0)
+        {
+            return false;
+        }
+
+        first_level = (u32)__builtin_ctz(first_level_bitmap);
+        second_level_bitmap = tlsf->second_level_bitmap_array[first_level];
+    }
+
+    second_level = (u32)__builtin_ctz(second_level_bitmap);
+
+    u32 block = tlsf->free_head_array[first_level][second_level];
+
+    tlsf_remove_free_block(tlsf, block);
+
+    // Padding in front of the aligned offset goes back to the free lists as
+    // a block of its own. Free blocks never neighbor each other, so neither
+    // the padding nor the tail past the size can merge with anything.
+
+    const u64 padding = tlsf_align_up(tlsf->block_array[block].offset, alignment) - tlsf->block_array[block].offset;
+
+    if (padding > 0)
+    {
+        const u32 aligned_block = tlsf_split_block(tlsf, block, padding);
+
+        tlsf_insert_free_block(tlsf, block);
+
+        block = aligned_block;
+    }
+
+    if (tlsf->block_array[block].size - size >= TLSF_MIN_BLOCK_SIZE)
+    {
+        tlsf_insert_free_block(tlsf, tlsf_split_block(tlsf, block, size));
+    }
+
+    tlsf->used_size += tlsf->block_array[block].size;
+    tlsf->allocation_count++;
+
+    *out_block = block;
+    *out_offset = tlsf->block_array[block].offset;
+
+    return true;
+}
+
+void tlsf_free(Tlsf* tlsf, u32 block)
+{
+    tlsf->used_size -= tlsf->block_array[block].size;
+    tlsf->allocation_count--;
+
+    const u32 next_block = tlsf->block_array[block].next_physical_block;
+
+    if (next_block != TLSF_NULL_BLOCK && tlsf->block_array[next_block].is_free)
+    {
+        tlsf_remove_free_block(tlsf, next_block);
+        tlsf_merge_into_previous(tlsf, next_block);
+    }
+
+    const u32 previous_block = tlsf->block_array[block].previous_physical_block;
+
+    if (previous_block != TLSF_NULL_BLOCK && tlsf->block_array[previous_block].is_free)
+    {
+        tlsf_remove_free_block(tlsf, previous_block);
+        tlsf_merge_into_previous(tlsf, block);
+
+        block = previous_block;
+    }
+
+    tlsf_insert_free_block(tlsf, block);
+}
+
+u64 tlsf_get_largest_free_size(Tlsf* tlsf)
+{
+    if (tlsf->first_level_bitmap == 0)
+    {
+        return 0;
+    }
+
+    const u32 first_level = 31 - (u32)__builtin_clz(tlsf->first_level_bitmap);
+    const u32 second_level = 31 - (u32)__builtin_clz(tlsf->second_level_bitmap_array[first_level]);
+
+    u64 largest_size = 0;
+
+    for (
+        u32 block = tlsf->free_head_array[first_level][second_level];
+        block != TLSF_NULL_BLOCK;
+        block = tlsf->block_array[block].next_free_block
+    ) {
+        largest_size = tlsf->block_array[block].size > largest_size ? tlsf->block_array[block].size : largest_size;
+    }
+
+    return largest_size;
+}
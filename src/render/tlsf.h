@@ -0,0 +1,85 @@
+#ifndef TLSF_H
+#define TLSF_H 1
+
+#include "core/types.h"
+
+// Two level segregated fit suballocation of byte ranges. Free ranges are
+// binned by the log2 of their size, each bin split linearly into
+// TLSF_SECOND_LEVEL_COUNT sub-bins, and a bitmap per level finds the
+// smallest non-empty bin that fits a request in constant time. Freed
+// ranges merge with free physical neighbors at once.
+//
+// The ranges describe memory the allocator never touches, so the block
+// records live in their own array and are referred to by index.
+
+#define TLSF_SECOND_LEVEL_LOG2      4
+#define TLSF_SECOND_LEVEL_COUNT     (1 << TLSF_SECOND_LEVEL_LOG2)
+
+// Sizes below the small size share the first bin, split into sub-bins of
+// the minimum block size
+
+#define TLSF_SMALL_LOG2             8
+#define TLSF_SMALL_SIZE             (1ull << TLSF_SMALL_LOG2)
+
+#define TLSF_FIRST_LEVEL_COUNT      32
+
+// Every block offset and size is a multiple of the minimum block size
+
+#define TLSF_MIN_BLOCK_SIZE         (TLSF_SMALL_SIZE / TLSF_SECOND_LEVEL_COUNT)
+
+#define TLSF_NULL_BLOCK             UINT32_MAX
+
+typedef struct TlsfBlock
+{
+    u64 offset;
+    u64 size;
+
+    // Neighbors in offset order, and in the free list of the block's bin
+    // while it is free
+
+    u32 previous_physical_block;
+    u32 next_physical_block;
+
+    u32 previous_free_block;
+    u32 next_free_block;
+
+    bool is_free;
+}
+TlsfBlock;
+
+typedef struct Tlsf
+{
+    u64 size;
+
+    u64 used_size;
+    u32 allocation_count;
+    u32 free_block_count;
+
+    u32 first_level_bitmap;
+    u32 second_level_bitmap_array[TLSF_FIRST_LEVEL_COUNT];
+
+    u32 free_head_array[TLSF_FIRST_LEVEL_COUNT][TLSF_SECOND_LEVEL_COUNT];
+
+    // Block records, with unused records chained through their next free
+    // block
+
+    u32 block_count;
+    u32 block_capacity;
+    TlsfBlock* block_array;
+
+    u32 unused_block;
+}
+Tlsf;
+
+Tlsf* tlsf_create(u64 size);
+void tlsf_destroy(Tlsf* tlsf);
+
+// Returns false when no free range holds the size at the alignment, which
+// must be a power of two. The block identifies the range when it is freed.
+
+bool tlsf_allocate(Tlsf* tlsf, u64 size, u64 alignment, u32* out_block, u64* out_offset);
+void tlsf_free(Tlsf* tlsf, u32 block);
+
+u64 tlsf_get_largest_free_size(Tlsf* tlsf);
+
+#endif
@@ -0,0 +1,202 @@
+#include "render/vertex_arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/log/log.h"
+
+#define VERTEX_ARENA_INITIAL_FREE_RANGE_CAPACITY 64
+
+VertexArena* vertex_arena_create(u32 vertex_capacity)
+{
+    VertexArena* vertex_arena = malloc(sizeof(*vertex_arena));
+
+    if (!vertex_arena)
+    {
+        LOG_FATAL("Failed to allocate vertex arena");
+    }
+
+    vertex_arena->vertex_capacity = vertex_capacity;
+
+    vertex_arena->free_range_capacity = VERTEX_ARENA_INITIAL_FREE_RANGE_CAPACITY;
+    vertex_arena->free_range_array = malloc(sizeof(VertexArenaRange) * vertex_arena->free_range_capacity);
+
+    if (!vertex_arena->free_range_array)
+    {
+        LOG_FATAL("Failed to allocate vertex arena free ranges");
+    }
+
+    vertex_arena->free_range_array[0].first_vertex = 0;
+    vertex_arena->free_range_array[0].vertex_count = vertex_capacity;
+    vertex_arena->free_range_count = vertex_capacity > 0 ? 1 : 0;
+
+    vertex_arena->allocation_count = 0;
+    vertex_arena->used_vertex_count = 0;
+
+    return vertex_arena;
+}
+
+void vertex_arena_destroy(VertexArena* vertex_arena)
+{
+    free(vertex_arena->free_range_array);
+    free(vertex_arena);
+}
+
+bool vertex_arena_allocate(VertexArena* vertex_arena, u32 vertex_count, u32* out_first_vertex)
+{
+    if (vertex_count == 0)
+    {
+        return false;
+    }
+
+    u32 best_range_index = UINT32_MAX;
+    u32 best_vertex_count = UINT32_MAX;
+
+    for (u32 range_index = 0; range_index < vertex_arena->free_range_count; ++range_index)
+    {
+        const u32 range_vertex_count = vertex_arena->free_range_array[range_index].vertex_count;
+
+        if (range_vertex_count >= vertex_count && range_vertex_count < best_vertex_count)
+        {
+            best_range_index = range_index;
+            best_vertex_count = range_vertex_count;
+
+            if (range_vertex_count == vertex_count)
+            {
+                break;
+            }
+        }
+    }
+
+    if (best_range_index == UINT32_MAX)
+    {
+        return false;
+    }
+
+    VertexArenaRange* range = &vertex_arena->free_range_array[best_range_index];
+
+    *out_first_vertex = range->first_vertex;
+
+    if (range->vertex_count == vertex_count)
+    {
+        memmove(
+            range,
+            range + 1,
+            sizeof(VertexArenaRange) * (vertex_arena->free_range_count - best_range_index - 1)
+        );
+
+        vertex_arena->free_range_count--;
+    }
+    else
+    {
+        range->first_vertex += vertex_count;
+        range->vertex_count -= vertex_count;
+    }
+
+    vertex_arena->allocation_count++;
+    vertex_arena->used_vertex_count += vertex_count;
+
+    return true;
+}
+
+void vertex_arena_free(VertexArena* vertex_arena, u32 first_vertex, u32 vertex_count)
+{
+    if (vertex_count == 0)
+    {
+        return;
+    }
+
+    // Index of the first free range past the freed one
+
+    u32 low = 0;
+    u32 high = vertex_arena->free_range_count;
+
+    while (low < high)
+    {
+        const u32 middle = (low + high) / 2;
+
+        if (vertex_arena->free_range_array[middle].first_vertex < first_vertex)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    const u32 next_index = low;
+
+    VertexArenaRange* previous_range = next_index > 0 ? &vertex_arena->free_range_array[next_index - 1] : NULL;
+    VertexArenaRange* next_range = next_index < vertex_arena->free_range_count ? &vertex_arena->free_range_array[next_index] : NULL;
+
+    const bool is_previous_adjacent = previous_range && previous_range->first_vertex + previous_range->vertex_count == first_vertex;
+    const bool is_next_adjacent = next_range && first_vertex + vertex_count == next_range->first_vertex;
+
+    if (is_previous_adjacent && is_next_adjacent)
+    {
+        previous_range->vertex_count += vertex_count + next_range->vertex_count;
+
+        memmove(
+            next_range,
+            next_range + 1,
+            sizeof(VertexArenaRange) * (vertex_arena->free_range_count - next_index - 1)
+        );
+
+        vertex_arena->free_range_count--;
+    }
+    else if (is_previous_adjacent)
+    {
+        previous_range->vertex_count += vertex_count;
+    }
+    else if (is_next_adjacent)
+    {
+        next_range->first_vertex = first_vertex;
+        next_range->vertex_count += vertex_count;
+    }
+    else
+    {
+        if (vertex_arena->free_range_count == vertex_arena->free_range_capacity)
+        {
+            const u32 free_range_capacity = vertex_arena->free_range_capacity * 2;
+
+            VertexArenaRange* free_range_array = realloc(vertex_arena->free_range_array, sizeof(VertexArenaRange) * free_range_capacity);
+
+            if (!free_range_array)
+            {
+                LOG_FATAL("Failed to grow vertex arena free ranges");
+            }
+
+            vertex_arena->free_range_capacity = free_range_capacity;
+            vertex_arena->free_range_array = free_range_array;
+        }
+
+        memmove(
+            &vertex_arena->free_range_array[next_index + 1],
+            &vertex_arena->free_range_array[next_index],
+            sizeof(VertexArenaRange) * (vertex_arena->free_range_count - next_index)
+        );
+
+        vertex_arena->free_range_array[next_index].first_vertex = first_vertex;
+        vertex_arena->free_range_array[next_index].vertex_count = vertex_count;
+
+        vertex_arena->free_range_count++;
+    }
+
+    vertex_arena->allocation_count--;
+    vertex_arena->used_vertex_count -= vertex_count;
+}
+
+u32 vertex_arena_get_largest_free_range(VertexArena* vertex_arena)
+{
+    u32 largest_vertex_count = 0;
+
+    for (u32 range_index = 0; range_index < vertex_arena->free_range_count; ++range_index)
+    {
+        const u32 range_vertex_count = vertex_arena->free_range_array[range_index].vertex_count;
+
+        largest_vertex_count = range_vertex_count > largest_vertex_count ? range_vertex_count : largest_vertex_count;
+    }
+
+    return largest_vertex_count;
+}
@@ -0,0 +1,42 @@
+#ifndef VERTEX_ARENA_H
+#define VERTEX_ARENA_H 1
+
+#include "core/types.h"
+
+// Suballocates ranges of vertices from one large vertex buffer. Free ranges
+// are kept sorted by their first vertex and merged with their neighbors when
+// freed, so no two free ranges are ever adjacent. Allocations take the
+// smallest free range they fit in, which keeps large ranges whole for large
+// meshes.
+
+typedef struct VertexArenaRange
+{
+    u32 first_vertex;
+    u32 vertex_count;
+}
+VertexArenaRange;
+
+typedef struct VertexArena
+{
+    u32 vertex_capacity;
+
+    u32 free_range_count;
+    u32 free_range_capacity;
+    VertexArenaRange* free_range_array;
+
+    u32 allocation_count;
+    u32 used_vertex_count;
+}
+VertexArena;
+
+VertexArena* vertex_arena_create(u32 vertex_capacity);
+void vertex_arena_destroy(VertexArena* vertex_arena);
+
+// Returns false when no free range holds the vertices
+
+bool vertex_arena_allocate(VertexArena* vertex_arena, u32 vertex_count, u32* out_first_vertex);
+void vertex_arena_free(VertexArena* vertex_arena, u32 first_vertex, u32 vertex_count);
+
+u32 vertex_arena_get_largest_free_range(VertexArena* vertex_arena);
+
+#endif
@@ -1,8 +1,65 @@
 #include "render/render.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/log/log.h"
+
+void render_vulkan_create_and_init_upload_context(Render* render)
+{
+    VulkanUploadContext* vulkan_upload_context = &render->vulkan_upload_context;
+
+    VkSemaphoreTypeCreateInfo semaphore_type_create_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+
+    VkSemaphoreCreateInfo semaphore_create_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &semaphore_type_create_info,
+    };
+
+    vkCreateSemaphore(
+        render->vulkan_device_context.device,
+        &semaphore_create_info,
+        NULL,
+        &vulkan_upload_context->timeline_semaphore
+    );
+
+    vulkan_upload_context->submitted_ticket = 0;
+    vulkan_upload_context->completed_ticket = 0;
+
+    vulkan_upload_context->submission_count = 0;
+    vulkan_upload_context->submission_capacity = 16;
+    vulkan_upload_context->submission_array = malloc(sizeof(VulkanUploadSubmission) * vulkan_upload_context->submission_capacity);
+
+    if (!vulkan_upload_context->submission_array)
+    {
+        LOG_FATAL("Failed to allocate upload submissions");
+    }
+
+    LOG_INFO("Vulkan Upload Initialized");
+}
+
+// Expects the device to be idle, so every submission is complete
+
+void render_vulkan_destroy_upload_context(Render* render)
+{
+    VulkanUploadContext* vulkan_upload_context = &render->vulkan_upload_context;
+
+    render_vulkan_poll_uploads(render);
+
+    vkDestroySemaphore(render->vulkan_device_context.device, vulkan_upload_context->timeline_semaphore, NULL);
+
+    free(vulkan_upload_context->submission_array);
+}
+
 VkCommandBuffer render_vulkan_begin_single_time_commands(Render* render)
 {
-    VkCommandBufferAllocateInfo alloc_info = 
+    VkCommandBufferAllocateInfo alloc_info =
     {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
         .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
@@ -18,7 +75,7 @@ VkCommandBuffer render_vulkan_begin_single_time_commands(Render* render)
         &command_buffer
     );
 
-    VkCommandBufferBeginInfo begin_info = 
+    VkCommandBufferBeginInfo begin_info =
     {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
         .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
@@ -29,15 +86,29 @@ VkCommandBuffer render_vulkan_begin_single_time_commands(Render* render)
     return command_buffer;
 }
 
-void render_vulkan_end_single_time_commands(Render* render, VkCommandBuffer command_buffer)
+VulkanUploadTicket render_vulkan_end_single_time_commands(Render* render, VkCommandBuffer command_buffer)
 {
+    VulkanUploadContext* vulkan_upload_context = &render->vulkan_upload_context;
+
     vkEndCommandBuffer(command_buffer);
 
-    VkSubmitInfo submit_info = 
+    const VulkanUploadTicket ticket = render_vulkan_take_upload_ticket(render);
+
+    VkTimelineSemaphoreSubmitInfo timeline_submit_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &ticket,
+    };
+
+    VkSubmitInfo submit_info =
     {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_submit_info,
         .commandBufferCount = 1,
-        .pCommandBuffers = &command_buffer
+        .pCommandBuffers = &command_buffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &vulkan_upload_context->timeline_semaphore,
     };
 
     vkQueueSubmit(
@@ -47,12 +118,104 @@ void render_vulkan_end_single_time_commands(Render* render, VkCommandBuffer comm
         VK_NULL_HANDLE
     );
 
-    vkQueueWaitIdle(render->vulkan_device_context.graphics_queue);
+    if (vulkan_upload_context->submission_count == vulkan_upload_context->submission_capacity)
+    {
+        vulkan_upload_context->submission_capacity *= 2;
+        vulkan_upload_context->submission_array = realloc(
+            vulkan_upload_context->submission_array,
+            sizeof(VulkanUploadSubmission) * vulkan_upload_context->submission_capacity
+        );
+
+        if (!vulkan_upload_context->submission_array)
+        {
+            LOG_FATAL("Failed to grow upload submissions");
+        }
+    }
+
+    vulkan_upload_context->submission_array[vulkan_upload_context->submission_count++] = (VulkanUploadSubmission)
+    {
+        .command_buffer = command_buffer,
+        .ticket = ticket,
+    };
 
-    vkFreeCommandBuffers(
+    return ticket;
+}
+
+VulkanUploadTicket render_vulkan_take_upload_ticket(Render* render)
+{
+    return ++render->vulkan_upload_context.submitted_ticket;
+}
+
+// Reads how far the timeline has come, and frees the command buffers of the
+// submissions it has passed
+
+VulkanUploadTicket render_vulkan_poll_uploads(Render* render)
+{
+    VulkanUploadContext* vulkan_upload_context = &render->vulkan_upload_context;
+
+    vkGetSemaphoreCounterValue(
         render->vulkan_device_context.device,
-        render->vulkan_device_context.command_pool,
-        1,
-        &command_buffer
+        vulkan_upload_context->timeline_semaphore,
+        &vulkan_upload_context->completed_ticket
     );
+
+    u32 completed_count = 0;
+
+    while (
+        completed_count < vulkan_upload_context->submission_count &&
+        vulkan_upload_context->submission_array[completed_count].ticket <= vulkan_upload_context->completed_ticket
+    ) {
+        vkFreeCommandBuffers(
+            render->vulkan_device_context.device,
+            render->vulkan_device_context.command_pool,
+            1,
+            &vulkan_upload_context->submission_array[completed_count].command_buffer
+        );
+
+        completed_count++;
+    }
+
+    if (completed_count > 0)
+    {
+        vulkan_upload_context->submission_count -= completed_count;
+
+        memmove(
+            vulkan_upload_context->submission_array,
+            vulkan_upload_context->submission_array + completed_count,
+            sizeof(VulkanUploadSubmission) * vulkan_upload_context->submission_count
+        );
+    }
+
+    return vulkan_upload_context->completed_ticket;
+}
+
+// As of the most recent poll
+
+bool render_vulkan_is_upload_complete(Render* render, VulkanUploadTicket ticket)
+{
+    return ticket <= render->vulkan_upload_context.completed_ticket;
+}
+
+// Blocks until a ticket completes, for callers that need its result now
+
+void render_vulkan_wait_upload(Render* render, VulkanUploadTicket ticket)
+{
+    VulkanUploadContext* vulkan_upload_context = &render->vulkan_upload_context;
+
+    if (render_vulkan_is_upload_complete(render, ticket))
+    {
+        return;
+    }
+
+    VkSemaphoreWaitInfo wait_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &vulkan_upload_context->timeline_semaphore,
+        .pValues = &ticket,
+    };
+
+    vkWaitSemaphores(render->vulkan_device_context.device, &wait_info, UINT64_MAX);
+
+    render_vulkan_poll_uploads(render);
 }
@@ -113,6 +113,39 @@ void render_vulkan_choose_physical_device(Render* render)
     {
         VkPhysicalDevice device = physical_device_array[device_index];
 
+        // All sector meshes are drawn with one indirect draw, each as the
+        // instance of its sector index. Instanced faces find their sector
+        // from the draw index instead. Uploads complete on a timeline
+        // semaphore.
+
+        VkPhysicalDeviceVulkan12Features vulkan_12_features =
+        {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        };
+
+        VkPhysicalDeviceVulkan11Features vulkan_11_features =
+        {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
+            .pNext = &vulkan_12_features,
+        };
+
+        VkPhysicalDeviceFeatures2 features =
+        {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &vulkan_11_features,
+        };
+
+        vkGetPhysicalDeviceFeatures2(device, &features);
+
+        if (
+            !features.features.multiDrawIndirect ||
+            !features.features.drawIndirectFirstInstance ||
+            !vulkan_11_features.shaderDrawParameters ||
+            !vulkan_12_features.timelineSemaphore
+        ) {
+            continue;
+        }
+
         u32 queue_family_count = 0;
 
         vkGetPhysicalDeviceQueueFamilyProperties(
@@ -178,11 +211,37 @@ void render_vulkan_create_logical_device(Render* render)
         "VK_KHR_portability_subset"
     };
 
+    VkPhysicalDeviceVulkan12Features vulkan_12_features =
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .timelineSemaphore = VK_TRUE,
+    };
+
+    VkPhysicalDeviceVulkan11Features vulkan_11_features =
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
+        .pNext = &vulkan_12_features,
+        .shaderDrawParameters = VK_TRUE,
+    };
+
+    VkPhysicalDeviceFeatures2 features =
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &vulkan_11_features,
+        .features =
+        {
+            .multiDrawIndirect = VK_TRUE,
+            .drawIndirectFirstInstance = VK_TRUE,
+        },
+    };
+
     VkDeviceCreateInfo device_info = 
     {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &features,
         .queueCreateInfoCount = 1,
         .pQueueCreateInfos = &device_queue_info,
+        .pEnabledFeatures = NULL,
         .enabledLayerCount = 0,
         .enabledExtensionCount = 2,
         .ppEnabledExtensionNames = extension_array,
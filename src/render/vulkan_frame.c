@@ -1,9 +1,114 @@
 #include "render/render.h"
 
+#include <stddef.h>
+#include <string.h>
 #include <cglm/cglm.h>
 
 #include "core/log/log.h"
 
+// Creates the buffers the cull pass of a frame reads and writes, those the
+// CPU touches in host visible memory, and points the frame's descriptor set
+// at them
+
+static void render_vulkan_create_frame_cull_resources(Render* render, VulkanFrame* frame)
+{
+    VkDevice device = render->vulkan_device_context.device;
+
+    const u32 sector_count = get_world_volume_in_sectors();
+
+    const VkDeviceSize sector_buffer_size = sizeof(VulkanCullSector) * sector_count;
+    const VkDeviceSize draw_command_buffer_size = sizeof(VkDrawIndirectCommand) * 2 * sector_count;
+
+    render_vulkan_create_buffer(
+        render,
+        sector_buffer_size,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        &frame->cull_sector_buffer,
+        &frame->cull_sector_allocation
+    );
+
+    render_vulkan_create_buffer(
+        render,
+        draw_command_buffer_size,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &frame->draw_command_buffer,
+        &frame->draw_command_allocation
+    );
+
+    render_vulkan_create_buffer(
+        render,
+        sizeof(u32),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        &frame->visible_count_buffer,
+        &frame->visible_count_allocation
+    );
+
+    frame->cull_sector_array = frame->cull_sector_allocation.mapped;
+    frame->visible_count = frame->visible_count_allocation.mapped;
+
+    memset(frame->cull_sector_array, 0, sector_buffer_size);
+    *frame->visible_count = 0;
+
+    VkDescriptorSetAllocateInfo descriptor_set_allocate_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = render->cull_pipeline_context.descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &render->cull_pipeline_context.descriptor_set_layout
+    };
+
+    VkResult descriptor_set_result =
+        vkAllocateDescriptorSets(
+            device,
+            &descriptor_set_allocate_info,
+            &frame->cull_descriptor_set
+        );
+
+    if (descriptor_set_result != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to allocate cull descriptor set");
+    }
+
+    VkDescriptorBufferInfo buffer_info_array[3] =
+    {
+        { .buffer = frame->cull_sector_buffer, .offset = 0, .range = sector_buffer_size },
+        { .buffer = frame->draw_command_buffer, .offset = 0, .range = draw_command_buffer_size },
+        { .buffer = frame->visible_count_buffer, .offset = 0, .range = sizeof(u32) },
+    };
+
+    VkWriteDescriptorSet write_descriptor_set_array[3];
+
+    for (u32 binding = 0; binding < 3; ++binding)
+    {
+        write_descriptor_set_array[binding] = (VkWriteDescriptorSet)
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = frame->cull_descriptor_set,
+            .dstBinding = binding,
+            .dstArrayElement = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .pBufferInfo = &buffer_info_array[binding],
+        };
+    }
+
+    vkUpdateDescriptorSets(device, 3, write_descriptor_set_array, 0, NULL);
+}
+
+static void render_vulkan_destroy_frame_cull_resources(Render* render, VulkanFrame* frame)
+{
+    render_vulkan_destroy_buffer(render, frame->cull_sector_buffer, &frame->cull_sector_allocation);
+    render_vulkan_destroy_buffer(render, frame->draw_command_buffer, &frame->draw_command_allocation);
+    render_vulkan_destroy_buffer(render, frame->visible_count_buffer, &frame->visible_count_allocation);
+}
+
 void render_vulkan_create_and_init_frame_context(Render* render)
 {
     VkCommandBufferAllocateInfo command_buffer_allocate_info =
@@ -59,6 +164,8 @@ void render_vulkan_create_and_init_frame_context(Render* render)
             NULL, 
             &frame->in_flight_fence
         );
+
+        render_vulkan_create_frame_cull_resources(render, frame);
     }
 
     render->vulkan_frame_context.frame_index = 0;
@@ -72,6 +179,8 @@ void render_vulkan_destroy_frame_context(Render* render)
     {
         VulkanFrame* frame = &render->vulkan_frame_context.frame_array[frame_index];
 
+        render_vulkan_destroy_frame_cull_resources(render, frame);
+
         vkDestroyFence(
             render->vulkan_device_context.device, 
             frame->in_flight_fence, 
@@ -92,6 +201,135 @@ void render_vulkan_destroy_frame_context(Render* render)
     }
 }
 
+// Writes the bounds and arena range of every sector mesh for a frame, which
+// is safe as the frame's fence has been waited on. Sectors off the visible
+// list get no vertices or faces, so the cull pass never draws those the CPU
+// culled.
+
+static void render_vulkan_write_frame_sectors(Render* render, VulkanFrame* vulkan_frame)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    const f32 sector_size = get_sector_size_in_cells() * get_cell_size();
+
+    for (SectorIndex sector_index = 0; sector_index < vulkan_mesh_context->sector_mesh_count; ++sector_index)
+    {
+        VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_index];
+        VulkanCullSector* cull_sector = &vulkan_frame->cull_sector_array[sector_index];
+
+        vec3 sector_max_position;
+        glm_vec3_adds(sector_mesh->origin_position, sector_size, sector_max_position);
+
+        glm_vec4(sector_mesh->origin_position, get_cell_size(), cull_sector->min_position);
+        glm_vec4(sector_max_position, 0.0f, cull_sector->max_position);
+
+        cull_sector->vertex_count = 0;
+        cull_sector->first_vertex = sector_mesh->first_vertex;
+        cull_sector->face_count = 0;
+    }
+
+    for (u32 visible_index = 0; visible_index < vulkan_mesh_context->visible_sector_count; ++visible_index)
+    {
+        const SectorIndex sector_index = vulkan_mesh_context->visible_sector_index_array[visible_index];
+
+        VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_index];
+        VulkanCullSector* cull_sector = &vulkan_frame->cull_sector_array[sector_index];
+
+        cull_sector->vertex_count = sector_mesh->vertex_count;
+        cull_sector->face_count = sector_mesh->face_count;
+    }
+}
+
+// Records the cull pass of a frame ahead of its render pass. The visible
+// count the frame holds is that of its previous use.
+
+void render_vulkan_record_cull_commands(Render* render, VkCommandBuffer command_buffer, VulkanFrame* vulkan_frame)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    vulkan_mesh_context->gpu_visible_sector_count = *vulkan_frame->visible_count;
+
+    vkCmdFillBuffer(command_buffer, vulkan_frame->visible_count_buffer, 0, sizeof(u32), 0);
+
+    VkMemoryBarrier clear_barrier =
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1,
+        &clear_barrier,
+        0,
+        NULL,
+        0,
+        NULL
+    );
+
+    vkCmdBindPipeline(
+        command_buffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        render->cull_pipeline_context.pipeline
+    );
+
+    vkCmdBindDescriptorSets(
+        command_buffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        render->cull_pipeline_context.layout,
+        0,
+        1,
+        &vulkan_frame->cull_descriptor_set,
+        0,
+        NULL
+    );
+
+    Frustum frustum;
+    frustum_from_projection_view_matrix(render->projection_view_matrix, &frustum);
+
+    CullPushConstants cull_push_constants;
+
+    memcpy(cull_push_constants.plane_array, frustum.plane_array, sizeof(frustum.plane_array));
+    cull_push_constants.sector_count = vulkan_mesh_context->sector_mesh_count;
+
+    vkCmdPushConstants(
+        command_buffer,
+        render->cull_pipeline_context.layout,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(cull_push_constants),
+        &cull_push_constants
+    );
+
+    vkCmdDispatch(command_buffer, (vulkan_mesh_context->sector_mesh_count + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+    // Draws read the commands, and the host reads the count after the fence
+
+    VkMemoryBarrier cull_barrier =
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT,
+    };
+
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+        0,
+        1,
+        &cull_barrier,
+        0,
+        NULL,
+        0,
+        NULL
+    );
+}
+
 void render_vulkan_record_command_buffer(Render* render, VkCommandBuffer command_buffer, u32 image_index) 
 {
     VkCommandBufferBeginInfo command_buffer_info = 
@@ -101,6 +339,19 @@ void render_vulkan_record_command_buffer(Render* render, VkCommandBuffer command
 
     vkBeginCommandBuffer(command_buffer, &command_buffer_info);
 
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    VulkanFrame* vulkan_frame = &render->vulkan_frame_context.frame_array[render->vulkan_frame_context.frame_index];
+
+    render_vulkan_record_staging_commands(render, command_buffer);
+
+    render_vulkan_write_frame_sectors(render, vulkan_frame);
+
+    if (vulkan_mesh_context->is_gpu_culling_enabled)
+    {
+        render_vulkan_record_cull_commands(render, command_buffer, vulkan_frame);
+    }
+
     VkRect2D render_area = 
     {
         .offset = {0, 0},
@@ -154,23 +405,19 @@ void render_vulkan_record_command_buffer(Render* render, VkCommandBuffer command
 
     vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
-    VkDeviceSize offset_array[] = {0};
-
-    vkCmdBindVertexBuffers(
-        command_buffer,
-        0,
-        1,
-        &render->voxel_pipeline_context.vertex_buffer,
-        offset_array
-    );
+    VkDescriptorSet descriptor_set_array[] =
+    {
+        render->voxel_pipeline_context.descriptor_set,
+        vulkan_frame->cull_descriptor_set,
+    };
 
     vkCmdBindDescriptorSets(
         command_buffer,
         VK_PIPELINE_BIND_POINT_GRAPHICS,
         render->voxel_pipeline_context.layout,
         0,
-        1,
-        &render->voxel_pipeline_context.descriptor_set,
+        2,
+        descriptor_set_array,
         0,
         NULL
     );
@@ -178,24 +425,110 @@ void render_vulkan_record_command_buffer(Render* render, VkCommandBuffer command
     VoxelPushConstants voxel_push_constants;
 
     glm_mat4_copy(render->projection_view_matrix, voxel_push_constants.projection_view_matrix);
+    voxel_push_constants.sector_index = 0;
 
     vkCmdPushConstants(
-        render->vulkan_frame_context.frame_array[render->vulkan_frame_context.frame_index].command_buffer,
+        command_buffer,
         render->voxel_pipeline_context.layout,
         VK_SHADER_STAGE_VERTEX_BIT,
         0,
-        sizeof(VoxelPushConstants),
+        sizeof(voxel_push_constants),
         &voxel_push_constants
     );
 
-    vkCmdDraw(
+    VkDeviceSize offset_array[] = {0};
+
+    vkCmdBindVertexBuffers(
         command_buffer,
-        36,
-        1,
         0,
-        0
+        1,
+        &vulkan_mesh_context->vertex_arena_buffer,
+        offset_array
+    );
+
+    // Each sector is drawn as the instance of its index, from which
+    // voxel.vert reads its origin
+
+    if (vulkan_mesh_context->is_gpu_culling_enabled)
+    {
+        vkCmdDrawIndirect(
+            command_buffer,
+            vulkan_frame->draw_command_buffer,
+            0,
+            vulkan_mesh_context->sector_mesh_count,
+            sizeof(VkDrawIndirectCommand)
+        );
+    }
+    else
+    {
+        for (u32 visible_index = 0; visible_index < vulkan_mesh_context->visible_sector_count; ++visible_index)
+        {
+            const SectorIndex sector_index = vulkan_mesh_context->visible_sector_index_array[visible_index];
+
+            VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_index];
+
+            vkCmdDraw(
+                command_buffer,
+                sector_mesh->vertex_count,
+                1,
+                sector_mesh->first_vertex,
+                sector_index
+            );
+        }
+    }
+
+    // Instanced faces are drawn as strips of 4 vertices, one instance per
+    // face, whose index voxel_face.vert reads the face at. The layout is
+    // shared, so the sets and push constants stay bound.
+
+    vkCmdBindPipeline(
+        command_buffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        render->voxel_pipeline_context.face_pipeline
     );
 
+    if (vulkan_mesh_context->is_gpu_culling_enabled)
+    {
+        vkCmdDrawIndirect(
+            command_buffer,
+            vulkan_frame->draw_command_buffer,
+            sizeof(VkDrawIndirectCommand) * vulkan_mesh_context->sector_mesh_count,
+            vulkan_mesh_context->sector_mesh_count,
+            sizeof(VkDrawIndirectCommand)
+        );
+    }
+    else
+    {
+        for (u32 visible_index = 0; visible_index < vulkan_mesh_context->visible_sector_count; ++visible_index)
+        {
+            const SectorIndex sector_index = vulkan_mesh_context->visible_sector_index_array[visible_index];
+
+            VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_index];
+
+            if (sector_mesh->face_count == 0)
+            {
+                continue;
+            }
+
+            vkCmdPushConstants(
+                command_buffer,
+                render->voxel_pipeline_context.layout,
+                VK_SHADER_STAGE_VERTEX_BIT,
+                offsetof(VoxelPushConstants, sector_index),
+                sizeof(sector_index),
+                &sector_index
+            );
+
+            vkCmdDraw(
+                command_buffer,
+                4,
+                sector_mesh->face_count,
+                0,
+                2 * (sector_mesh->first_vertex + sector_mesh->vertex_count)
+            );
+        }
+    }
+
     vkCmdEndRenderPass(command_buffer);
     vkEndCommandBuffer(command_buffer);
 }
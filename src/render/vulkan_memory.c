@@ -1,27 +1,72 @@
 #include "render/render.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include "stb/stb_image.h"
 
 #include "core/log/log.h"
 
+void render_vulkan_create_and_init_memory_context(Render* render)
+{
+    VulkanMemoryContext* vulkan_memory_context = &render->vulkan_memory_context;
+
+    vkGetPhysicalDeviceMemoryProperties(
+        render->vulkan_device_context.physical_device,
+        &vulkan_memory_context->memory_properties
+    );
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(render->vulkan_device_context.physical_device, &properties);
+
+    vulkan_memory_context->device_allocation_count = 0;
+    vulkan_memory_context->max_device_allocation_count = properties.limits.maxMemoryAllocationCount;
+
+    memset(vulkan_memory_context->pool_array, 0, sizeof(vulkan_memory_context->pool_array));
+    memset(vulkan_memory_context->heap_stats_array, 0, sizeof(vulkan_memory_context->heap_stats_array));
+
+    LOG_INFO("Vulkan Memory Initialized");
+}
+
+void render_vulkan_destroy_memory_context(Render* render)
+{
+    VulkanMemoryContext* vulkan_memory_context = &render->vulkan_memory_context;
+
+    for (u32 memory_type_index = 0; memory_type_index < VK_MAX_MEMORY_TYPES; ++memory_type_index)
+    {
+        for (u32 kind = 0; kind < VULKAN_MEMORY_KIND_COUNT; ++kind)
+        {
+            VulkanMemoryPool* pool = &vulkan_memory_context->pool_array[memory_type_index][kind];
+
+            for (u32 block_index = 0; block_index < pool->block_count; ++block_index)
+            {
+                VulkanMemoryBlock* block = &pool->block_array[block_index];
+
+                if (block->memory == VK_NULL_HANDLE)
+                {
+                    continue;
+                }
+
+                vkFreeMemory(render->vulkan_device_context.device, block->memory, NULL);
+                tlsf_destroy(block->tlsf);
+            }
+
+            free(pool->block_array);
+        }
+    }
+}
+
 u32 render_vulkan_locate_memory_type(
     Render* render,
     u32 type_filter,
     VkMemoryPropertyFlags properties
 ) {
-    VkPhysicalDeviceMemoryProperties mem_properties;
+    const VkPhysicalDeviceMemoryProperties* mem_properties = &render->vulkan_memory_context.memory_properties;
 
-    vkGetPhysicalDeviceMemoryProperties(
-        render->vulkan_device_context.physical_device,
-        &mem_properties
-    );
-
-    for (u32 i = 0; i < mem_properties.memoryTypeCount; i++)
+    for (u32 i = 0; i < mem_properties->memoryTypeCount; i++)
     {
         if (
             (type_filter & (1 << i)) &&
-            (mem_properties.memoryTypes[i].propertyFlags & properties) == properties
+            (mem_properties->memoryTypes[i].propertyFlags & properties) == properties
         ) {
             return i;
         }
@@ -30,13 +75,243 @@ u32 render_vulkan_locate_memory_type(
     return UINT32_MAX;
 }
 
+// Allocates device memory of one memory type, mapping all of it when the
+// type is host visible
+
+static VkDeviceMemory render_vulkan_allocate_device_memory(Render* render, VkDeviceSize size, u32 memory_type_index, void** out_mapped)
+{
+    VulkanMemoryContext* vulkan_memory_context = &render->vulkan_memory_context;
+
+    if (vulkan_memory_context->device_allocation_count >= vulkan_memory_context->max_device_allocation_count)
+    {
+        LOG_FATAL("Exceeded %u device memory allocations", vulkan_memory_context->max_device_allocation_count);
+    }
+
+    VkMemoryAllocateInfo alloc_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = size,
+        .memoryTypeIndex = memory_type_index
+    };
+
+    VkDeviceMemory memory;
+
+    VkResult allocate_result =
+        vkAllocateMemory(
+            render->vulkan_device_context.device,
+            &alloc_info,
+            NULL,
+            &memory
+        );
+
+    if (allocate_result != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to allocate %llu bytes of device memory", (unsigned long long)size);
+    }
+
+    vulkan_memory_context->device_allocation_count++;
+
+    *out_mapped = NULL;
+
+    if (vulkan_memory_context->memory_properties.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        vkMapMemory(render->vulkan_device_context.device, memory, 0, VK_WHOLE_SIZE, 0, out_mapped);
+    }
+
+    return memory;
+}
+
+static void render_vulkan_free_device_memory(Render* render, VkDeviceMemory memory)
+{
+    vkFreeMemory(render->vulkan_device_context.device, memory, NULL);
+
+    render->vulkan_memory_context.device_allocation_count--;
+}
+
+// Finds a block of the pool with room for the requirements, creating one
+// when none has it. Returns whether it created a block.
+
+static bool render_vulkan_allocate_from_pool(
+    Render* render,
+    VulkanMemoryPool* pool,
+    u32 memory_type_index,
+    const VkMemoryRequirements* mem_requirements,
+    VulkanAllocation* allocation
+) {
+    u32 empty_block_index = UINT32_MAX;
+
+    for (u32 block_index = 0; block_index < pool->block_count; ++block_index)
+    {
+        VulkanMemoryBlock* block = &pool->block_array[block_index];
+
+        if (block->memory == VK_NULL_HANDLE)
+        {
+            empty_block_index = block_index;
+
+            continue;
+        }
+
+        if (tlsf_allocate(block->tlsf, mem_requirements->size, mem_requirements->alignment, &allocation->tlsf_block, &allocation->offset))
+        {
+            allocation->block_index = block_index;
+
+            return false;
+        }
+    }
+
+    if (empty_block_index == UINT32_MAX)
+    {
+        if (pool->block_count == pool->block_capacity)
+        {
+            const u32 block_capacity = pool->block_capacity ? pool->block_capacity * 2 : 4;
+
+            VulkanMemoryBlock* block_array = realloc(pool->block_array, sizeof(VulkanMemoryBlock) * block_capacity);
+
+            if (!block_array)
+            {
+                LOG_FATAL("Failed to grow device memory blocks");
+            }
+
+            pool->block_capacity = block_capacity;
+            pool->block_array = block_array;
+        }
+
+        empty_block_index = pool->block_count++;
+    }
+
+    VulkanMemoryBlock* block = &pool->block_array[empty_block_index];
+
+    block->memory = render_vulkan_allocate_device_memory(render, VULKAN_MEMORY_BLOCK_SIZE, memory_type_index, &block->mapped);
+    block->tlsf = tlsf_create(VULKAN_MEMORY_BLOCK_SIZE);
+
+    if (!tlsf_allocate(block->tlsf, mem_requirements->size, mem_requirements->alignment, &allocation->tlsf_block, &allocation->offset))
+    {
+        LOG_FATAL("Failed to suballocate %llu bytes from a new block", (unsigned long long)mem_requirements->size);
+    }
+
+    allocation->block_index = empty_block_index;
+
+    return true;
+}
+
+void render_vulkan_allocate_memory(
+    Render* render,
+    const VkMemoryRequirements* mem_requirements,
+    VkMemoryPropertyFlags properties,
+    VulkanMemoryKind kind,
+    VulkanAllocation* allocation
+) {
+    VulkanMemoryContext* vulkan_memory_context = &render->vulkan_memory_context;
+
+    const u32 memory_type_index = render_vulkan_locate_memory_type(
+        render,
+        mem_requirements->memoryTypeBits,
+        properties
+    );
+
+    if (memory_type_index == UINT32_MAX)
+    {
+        LOG_FATAL("Failed to find suitable memory type");
+    }
+
+    VulkanMemoryHeapStats* heap_stats =
+        &vulkan_memory_context->heap_stats_array[vulkan_memory_context->memory_properties.memoryTypes[memory_type_index].heapIndex];
+
+    allocation->size = mem_requirements->size;
+    allocation->memory_type_index = memory_type_index;
+    allocation->kind = kind;
+
+    if (mem_requirements->size >= VULKAN_MEMORY_DEDICATED_SIZE)
+    {
+        allocation->memory = render_vulkan_allocate_device_memory(render, mem_requirements->size, memory_type_index, &allocation->mapped);
+        allocation->offset = 0;
+        allocation->block_index = UINT32_MAX;
+        allocation->tlsf_block = TLSF_NULL_BLOCK;
+
+        heap_stats->dedicated_count++;
+        heap_stats->dedicated_size += mem_requirements->size;
+
+        return;
+    }
+
+    VulkanMemoryPool* pool = &vulkan_memory_context->pool_array[memory_type_index][kind];
+
+    if (render_vulkan_allocate_from_pool(render, pool, memory_type_index, mem_requirements, allocation))
+    {
+        heap_stats->block_count++;
+        heap_stats->block_size += VULKAN_MEMORY_BLOCK_SIZE;
+    }
+
+    VulkanMemoryBlock* block = &pool->block_array[allocation->block_index];
+
+    allocation->memory = block->memory;
+    allocation->mapped = block->mapped ? (u8*)block->mapped + allocation->offset : NULL;
+
+    heap_stats->allocation_count++;
+    heap_stats->used_size += mem_requirements->size;
+}
+
+void render_vulkan_free_memory(Render* render, VulkanAllocation* allocation)
+{
+    VulkanMemoryContext* vulkan_memory_context = &render->vulkan_memory_context;
+
+    VulkanMemoryHeapStats* heap_stats =
+        &vulkan_memory_context->heap_stats_array[vulkan_memory_context->memory_properties.memoryTypes[allocation->memory_type_index].heapIndex];
+
+    if (allocation->block_index == UINT32_MAX)
+    {
+        render_vulkan_free_device_memory(render, allocation->memory);
+
+        heap_stats->dedicated_count--;
+        heap_stats->dedicated_size -= allocation->size;
+
+        return;
+    }
+
+    VulkanMemoryPool* pool = &vulkan_memory_context->pool_array[allocation->memory_type_index][allocation->kind];
+    VulkanMemoryBlock* block = &pool->block_array[allocation->block_index];
+
+    tlsf_free(block->tlsf, allocation->tlsf_block);
+
+    heap_stats->allocation_count--;
+    heap_stats->used_size -= allocation->size;
+
+    // Emptied blocks go back to the device, unless no other block of the
+    // pool is left to serve the next allocation
+
+    if (block->tlsf->allocation_count > 0)
+    {
+        return;
+    }
+
+    u32 live_block_count = 0;
+
+    for (u32 block_index = 0; block_index < pool->block_count; ++block_index)
+    {
+        live_block_count += pool->block_array[block_index].memory != VK_NULL_HANDLE;
+    }
+
+    if (live_block_count > 1)
+    {
+        render_vulkan_free_device_memory(render, block->memory);
+        tlsf_destroy(block->tlsf);
+
+        block->memory = VK_NULL_HANDLE;
+        block->tlsf = NULL;
+        block->mapped = NULL;
+
+        heap_stats->block_count--;
+        heap_stats->block_size -= VULKAN_MEMORY_BLOCK_SIZE;
+    }
+}
+
 void render_vulkan_create_buffer(
     Render* render,
     VkDeviceSize size,
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer* buffer,
-    VkDeviceMemory* memory
+    VulkanAllocation* allocation
 ) {
     VkBufferCreateInfo buffer_info = 
     {
@@ -61,39 +336,29 @@ void render_vulkan_create_buffer(
         &mem_requirements
     );
 
-    u32 memory_type_index = render_vulkan_locate_memory_type(
+    render_vulkan_allocate_memory(
         render,
-        mem_requirements.memoryTypeBits,
-        properties
-    );
-
-    if (memory_type_index == UINT32_MAX) 
-    {
-        LOG_FATAL("Failed to find suitable memory type for buffer");
-    }
-
-    VkMemoryAllocateInfo alloc_info = 
-    {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = mem_requirements.size,
-        .memoryTypeIndex = memory_type_index
-    };
-
-    vkAllocateMemory(
-        render->vulkan_device_context.device,
-        &alloc_info,
-        NULL,
-        memory
+        &mem_requirements,
+        properties,
+        VULKAN_MEMORY_KIND_LINEAR,
+        allocation
     );
 
     vkBindBufferMemory(
         render->vulkan_device_context.device,
         *buffer,
-        *memory,
-        0
+        allocation->memory,
+        allocation->offset
     );
 }
 
+void render_vulkan_destroy_buffer(Render* render, VkBuffer buffer, VulkanAllocation* allocation)
+{
+    vkDestroyBuffer(render->vulkan_device_context.device, buffer, NULL);
+
+    render_vulkan_free_memory(render, allocation);
+}
+
 void render_vulkan_create_image(
     Render* render,
     u32 width,
@@ -103,7 +368,7 @@ void render_vulkan_create_image(
     VkImageUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkImage* image,
-    VkDeviceMemory* memory
+    VulkanAllocation* allocation
 ) {
     VkImageCreateInfo image_info =
     {
@@ -139,39 +404,29 @@ void render_vulkan_create_image(
         &mem_requirements
     );
 
-    u32 memory_type_index = render_vulkan_locate_memory_type(
+    render_vulkan_allocate_memory(
         render,
-        mem_requirements.memoryTypeBits,
-        properties
-    );
-
-    if (memory_type_index == UINT32_MAX) 
-    {
-        LOG_FATAL("Failed to find suitable memory type for image");
-    }
-
-    VkMemoryAllocateInfo alloc_info =
-    {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = mem_requirements.size,
-        .memoryTypeIndex = memory_type_index
-    };
-
-    vkAllocateMemory(
-        render->vulkan_device_context.device,
-        &alloc_info,
-        NULL,
-        memory
+        &mem_requirements,
+        properties,
+        tiling == VK_IMAGE_TILING_LINEAR ? VULKAN_MEMORY_KIND_LINEAR : VULKAN_MEMORY_KIND_OPTIMAL,
+        allocation
     );
 
     vkBindImageMemory(
         render->vulkan_device_context.device,
         *image,
-        *memory,
-        0
+        allocation->memory,
+        allocation->offset
     );
 }
 
+void render_vulkan_destroy_image(Render* render, VkImage image, VulkanAllocation* allocation)
+{
+    vkDestroyImage(render->vulkan_device_context.device, image, NULL);
+
+    render_vulkan_free_memory(render, allocation);
+}
+
 VkImageView render_vulkan_create_image_view(
     Render* render,
     VkImage image,
@@ -250,215 +505,16 @@ VkSampler render_vulkan_create_sampler(Render* render)
     return sampler;
 }
 
-void render_vulkan_transition_image_layout(
-    Render* render,
-    VkImage image,
-    VkFormat format,
-    VkImageLayout old_layout,
-    VkImageLayout new_layout
-) {
-    VkCommandBuffer command_buffer = render_vulkan_begin_single_time_commands(render);
-
-    VkImageMemoryBarrier barrier =
-    {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .oldLayout = old_layout,
-        .newLayout = new_layout,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = image,
-        .subresourceRange = {
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1
-        }
-    };
-
-    if (new_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-    {
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-
-        if (
-            format == VK_FORMAT_D32_SFLOAT_S8_UINT ||
-            format == VK_FORMAT_D24_UNORM_S8_UINT
-        ) {
-            barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-        }
-    }
-    else
-    {
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    }
-
-    VkPipelineStageFlags source_stage;
-    VkPipelineStageFlags destination_stage;
-
-    if (
-        old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
-        new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    ) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else if (
-        old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-        new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    ) {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    }
-    else if (
-        old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
-        new_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-    ) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = 
-            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
-            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-        source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destination_stage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    }
-    else
-    {
-        source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destination_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-    }
-
-    vkCmdPipelineBarrier(
-        command_buffer,
-        source_stage,
-        destination_stage,
-        0,
-        0,
-        NULL,
-        0,
-        NULL,
-        1,
-        &barrier
-    );
-
-    render_vulkan_end_single_time_commands(render, command_buffer);
-}
-
-void render_vulkan_copy_buffer(
-    Render* render,
-    VkBuffer src_buffer,
-    VkBuffer dst_buffer,
-    VkDeviceSize size
-) {
-    VkCommandBuffer command_buffer = render_vulkan_begin_single_time_commands(render);
-
-    VkBufferCopy copy_region =
-    {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size = size
-    };
-
-    vkCmdCopyBuffer(
-        command_buffer,
-        src_buffer,
-        dst_buffer,
-        1,
-        &copy_region
-    );
-
-    render_vulkan_end_single_time_commands(render, command_buffer);
-}
-
-void render_vulkan_copy_buffer_to_image(
-    Render* render,
-    VkBuffer buffer,
-    VkImage image,
-    u32 width,
-    u32 height
-) {
-    VkCommandBuffer command_buffer = render_vulkan_begin_single_time_commands(render);
-
-    VkBufferImageCopy region =
-    {
-        .bufferOffset = 0,
-        .bufferRowLength = 0,
-        .bufferImageHeight = 0,
-        .imageSubresource = {
-            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            .mipLevel = 0,
-            .baseArrayLayer = 0,
-            .layerCount = 1
-        },
-        .imageOffset = {
-            .x = 0,
-            .y = 0,
-            .z = 0
-        },
-        .imageExtent = {
-            .width = width,
-            .height = height,
-            .depth = 1
-        }
-    };
-
-    vkCmdCopyBufferToImage(
-        command_buffer,
-        buffer,
-        image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1,
-        &region
-    );
-
-    render_vulkan_end_single_time_commands(render, command_buffer);
-}
-
 void render_vulkan_create_texture_from_pixels(
     Render* render,
     const void* pixels,
     u32 width,
     u32 height,
     VkImage* image,
-    VkDeviceMemory* image_memory,
+    VulkanAllocation* image_allocation,
     VkImageView* image_view,
     VkSampler* sampler
 ) {
-    VkDeviceSize image_size = width * height * 4;
-
-    VkBuffer staging_buffer;
-    VkDeviceMemory staging_memory;
-
-    render_vulkan_create_buffer(
-        render,
-        image_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &staging_buffer,
-        &staging_memory
-    );
-
-    void* data;
-    vkMapMemory(
-        render->vulkan_device_context.device,
-        staging_memory,
-        0,
-        image_size,
-        0,
-        &data
-    );
-
-    memcpy(data, pixels, (size_t)image_size);
-
-    vkUnmapMemory(
-        render->vulkan_device_context.device,
-        staging_memory
-    );
-
     render_vulkan_create_image(
         render,
         width,
@@ -468,32 +524,20 @@ void render_vulkan_create_texture_from_pixels(
         VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         image,
-        image_memory
+        image_allocation
     );
 
-    render_vulkan_transition_image_layout(
-        render,
-        *image,
-        VK_FORMAT_R8G8B8A8_UNORM,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    );
+    // The copy and the transitions around it are recorded with the next
+    // frame, ahead of any draw sampling the image
 
-    render_vulkan_copy_buffer_to_image(
-        render,
-        staging_buffer,
-        *image,
-        width,
-        height
-    );
+    void* staging_data = render_vulkan_stage_image_copy(render, *image, width, height);
 
-    render_vulkan_transition_image_layout(
-        render,
-        *image,
-        VK_FORMAT_R8G8B8A8_UNORM,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
+    if (!staging_data)
+    {
+        LOG_FATAL("Texture of %ux%u does not fit the staging ring", width, height);
+    }
+
+    memcpy(staging_data, pixels, (size_t)width * height * 4);
 
     *image_view = render_vulkan_create_image_view(
         render,
@@ -502,25 +546,13 @@ void render_vulkan_create_texture_from_pixels(
     );
 
     *sampler = render_vulkan_create_sampler(render);
-
-    vkDestroyBuffer(
-        render->vulkan_device_context.device,
-        staging_buffer,
-        NULL
-    );
-
-    vkFreeMemory(
-        render->vulkan_device_context.device,
-        staging_memory,
-        NULL
-    );
 }
 
 void render_vulkan_create_texture_from_file(
     Render* render,
     const char* path,
     VkImage* image,
-    VkDeviceMemory* image_memory,
+    VulkanAllocation* image_allocation,
     VkImageView* image_view,
     VkSampler* sampler
 ) {
@@ -550,7 +582,7 @@ void render_vulkan_create_texture_from_file(
         (u32)width,
         (u32)height,
         image,
-        image_memory,
+        image_allocation,
         image_view,
         sampler
     );
@@ -558,7 +590,7 @@ void render_vulkan_create_texture_from_file(
     stbi_image_free(pixel_array);
 }
 
-void render_vulkan_create_voxel_mesh(Render* render)
+void render_vulkan_create_voxel_texture(Render* render)
 {
     VulkanTexture* vulkan_texture = &render->voxel_pipeline_context.vulkan_texture;
 
@@ -566,7 +598,7 @@ void render_vulkan_create_voxel_mesh(Render* render)
         render,
         "assets/textures/lion.png",
         &vulkan_texture->image,
-        &vulkan_texture->image_memory,
+        &vulkan_texture->image_allocation,
         &vulkan_texture->image_view,
         &vulkan_texture->sampler
     );
@@ -576,57 +608,4 @@ void render_vulkan_create_voxel_mesh(Render* render)
         vulkan_texture->image_view,
         vulkan_texture->sampler
     );
-
-    VkBuffer staging_buffer;
-    VkDeviceMemory staging_memory;
-
-    VkDeviceSize buffer_size = sizeof(cube_vertex_array);
-
-    render_vulkan_create_buffer(
-        render,
-        buffer_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &staging_buffer,
-        &staging_memory
-    );
-
-    void* data;
-
-    vkMapMemory(
-        render->vulkan_device_context.device,
-        staging_memory,
-        0,
-        buffer_size,
-        0,
-        &data
-    );
-
-    memcpy(data, cube_vertex_array, buffer_size);
-
-    vkUnmapMemory(
-        render->vulkan_device_context.device,
-        staging_memory
-    );
-
-    render_vulkan_create_buffer(
-        render,
-        buffer_size,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        &render->voxel_pipeline_context.vertex_buffer,
-        &render->voxel_pipeline_context.vertex_memory
-    );
-
-    render_vulkan_copy_buffer(
-        render,
-        staging_buffer,
-        render->voxel_pipeline_context.vertex_buffer,
-        buffer_size
-    );
-
-    vkDestroyBuffer(render->vulkan_device_context.device, staging_buffer, NULL);
-    vkFreeMemory(render->vulkan_device_context.device, staging_memory, NULL);
 }
\ No newline at end of file
@@ -0,0 +1,736 @@
+#include "render/render.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <GLFW/glfw3.h>
+
+#include "core/log/log.h"
+#include "app/world/world.h"
+
+// Builds the CPU mesh of one sector. Runs on any worker, reading the world
+// without modifying it.
+
+static void render_vulkan_build_sector_mesh(void* data)
+{
+    VulkanMeshJob* mesh_job = data;
+
+    Mesh* mesh = mesh_job->mesh;
+    mesh_clear(mesh);
+
+    const f64 build_start_time = glfwGetTime();
+
+    Sector* sector = world_get_sector(mesh_job->world, mesh_job->sector_index);
+
+    if (sector)
+    {
+        Sector* neighbor_sector_array[GRID_NEIGHBORHOOD_COUNT];
+        world_get_neighbor_sector_array(mesh_job->world, mesh_job->sector_index, neighbor_sector_array);
+
+        const u8* neighbor_light_array[GRID_NEIGHBORHOOD_COUNT];
+        world_get_neighbor_light_array(mesh_job->world, mesh_job->sector_index, neighbor_light_array);
+
+        mesh_build_sector(
+            mesh,
+            mesh_job->mesh_mode,
+            mesh_job->lod,
+            mesh_job->skirt_direction_mask,
+            sector,
+            neighbor_sector_array,
+            neighbor_light_array
+        );
+    }
+
+    mesh_job->build_time = glfwGetTime() - build_start_time;
+}
+
+// Vertices of the arena a mesh takes. Faces are half the size of a vertex,
+// so two of them share each vertex of the range.
+
+static u32 render_vulkan_get_arena_vertex_count(u32 vertex_count, u32 face_count)
+{
+    return vertex_count + (face_count + 1) / 2;
+}
+
+static void render_vulkan_destroy_sector_mesh(Render* render, VulkanSectorMesh* sector_mesh)
+{
+    const u32 arena_vertex_count = render_vulkan_get_arena_vertex_count(sector_mesh->vertex_count, sector_mesh->face_count);
+
+    vertex_arena_free(render->vulkan_mesh_context.vertex_arena, sector_mesh->first_vertex, arena_vertex_count);
+
+    if (arena_vertex_count > 0)
+    {
+        render->vulkan_mesh_context.is_vertex_arena_freed = true;
+    }
+
+    sector_mesh->vertex_count = 0;
+    sector_mesh->face_count = 0;
+    sector_mesh->triangle_count = 0;
+    sector_mesh->first_vertex = 0;
+}
+
+// Places a sector in the cull group of the 2 x 2 x 2 block of window slots
+// it falls in. Blocks at the far side of a window of odd size are partial.
+
+static u32 render_vulkan_get_cull_slot(SectorIndex sector_index)
+{
+    const u32 world_size_in_sectors = get_world_size_in_sectors();
+    const u32 group_size_in_sectors = (world_size_in_sectors + 1) / 2;
+
+    const u32 slot_array[3] =
+    {
+        sector_index % world_size_in_sectors,
+        (sector_index / world_size_in_sectors) % world_size_in_sectors,
+        sector_index / get_world_area_in_sectors(),
+    };
+
+    const u32 group_index =
+        slot_array[0] / 2 +
+        slot_array[1] / 2 * group_size_in_sectors +
+        slot_array[2] / 2 * group_size_in_sectors * group_size_in_sectors;
+
+    const u32 member = (slot_array[0] & 1) | (slot_array[1] & 1) << 1 | (slot_array[2] & 1) << 2;
+
+    return group_index * CULL_GROUP_SIZE + member;
+}
+
+void render_vulkan_create_and_init_mesh_context(Render* render)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    vulkan_mesh_context->is_built = false;
+
+    vulkan_mesh_context->mesh_mode = MESH_MODE_GREEDY;
+    vulkan_mesh_context->is_lod_enabled = true;
+
+    vulkan_mesh_context->triangle_count = 0;
+
+    vulkan_mesh_context->remesh_sector_count = 0;
+    vulkan_mesh_context->build_time = 0.0;
+    vulkan_mesh_context->wall_time = 0.0;
+    vulkan_mesh_context->max_sector_build_time = 0.0;
+
+    vulkan_mesh_context->sector_mesh_count = get_world_volume_in_sectors();
+    vulkan_mesh_context->sector_mesh_array = calloc(vulkan_mesh_context->sector_mesh_count, sizeof(VulkanSectorMesh));
+
+    vulkan_mesh_context->job_array = calloc(vulkan_mesh_context->sector_mesh_count, sizeof(Job));
+    vulkan_mesh_context->mesh_job_array = calloc(vulkan_mesh_context->sector_mesh_count, sizeof(VulkanMeshJob));
+
+    vulkan_mesh_context->remesh_sector_index_array = malloc(sizeof(SectorIndex) * vulkan_mesh_context->sector_mesh_count);
+
+    vulkan_mesh_context->cull_slot_array = malloc(sizeof(u32) * vulkan_mesh_context->sector_mesh_count);
+    vulkan_mesh_context->visible_sector_index_array = malloc(sizeof(SectorIndex) * vulkan_mesh_context->sector_mesh_count);
+
+    if (
+        !vulkan_mesh_context->sector_mesh_array ||
+        !vulkan_mesh_context->job_array ||
+        !vulkan_mesh_context->mesh_job_array ||
+        !vulkan_mesh_context->remesh_sector_index_array ||
+        !vulkan_mesh_context->cull_slot_array ||
+        !vulkan_mesh_context->visible_sector_index_array
+    ) {
+        LOG_FATAL("Failed to allocate sector meshes");
+    }
+
+    vulkan_mesh_context->vertex_arena = vertex_arena_create(VERTEX_ARENA_CAPACITY);
+
+    vulkan_mesh_context->deferred_sector_count = 0;
+    vulkan_mesh_context->is_vertex_arena_freed = false;
+
+    render_vulkan_create_buffer(
+        render,
+        sizeof(VoxelVertex) * VERTEX_ARENA_CAPACITY,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &vulkan_mesh_context->vertex_arena_buffer,
+        &vulkan_mesh_context->vertex_arena_allocation
+    );
+
+    render_vulkan_update_face_descriptor(render, vulkan_mesh_context->vertex_arena_buffer, sizeof(VoxelVertex) * VERTEX_ARENA_CAPACITY);
+
+    const u32 group_size_in_sectors = (get_world_size_in_sectors() + 1) / 2;
+
+    vulkan_mesh_context->is_culling_enabled = true;
+    vulkan_mesh_context->cull = cull_create(group_size_in_sectors * group_size_in_sectors * group_size_in_sectors * CULL_GROUP_SIZE);
+
+    vulkan_mesh_context->is_occlusion_enabled = true;
+    vulkan_mesh_context->occlusion = occlusion_create();
+
+    vulkan_mesh_context->is_gpu_culling_enabled = true;
+    vulkan_mesh_context->gpu_visible_sector_count = 0;
+
+    vulkan_mesh_context->visible_sector_count = 0;
+    vulkan_mesh_context->frustum_visible_sector_count = 0;
+    vulkan_mesh_context->cull_time = 0.0;
+    vulkan_mesh_context->occlusion_time = 0.0;
+
+    atomic_init(&vulkan_mesh_context->job_counter.value, 0);
+
+    for (SectorIndex sector_index = 0; sector_index < vulkan_mesh_context->sector_mesh_count; ++sector_index)
+    {
+        VulkanMeshJob* mesh_job = &vulkan_mesh_context->mesh_job_array[sector_index];
+
+        mesh_job->sector_index = sector_index;
+        mesh_job->mesh = mesh_create();
+
+        vulkan_mesh_context->cull_slot_array[sector_index] = render_vulkan_get_cull_slot(sector_index);
+    }
+
+    LOG_INFO("Vulkan Mesh Initialized");
+}
+
+void render_vulkan_destroy_mesh_context(Render* render)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    for (u32 sector_mesh_index = 0; sector_mesh_index < vulkan_mesh_context->sector_mesh_count; ++sector_mesh_index)
+    {
+        render_vulkan_destroy_sector_mesh(render, &vulkan_mesh_context->sector_mesh_array[sector_mesh_index]);
+
+        mesh_destroy(vulkan_mesh_context->mesh_job_array[sector_mesh_index].mesh);
+    }
+
+    occlusion_destroy(vulkan_mesh_context->occlusion);
+    cull_destroy(vulkan_mesh_context->cull);
+
+    render_vulkan_destroy_buffer(render, vulkan_mesh_context->vertex_arena_buffer, &vulkan_mesh_context->vertex_arena_allocation);
+
+    vertex_arena_destroy(vulkan_mesh_context->vertex_arena);
+
+    free(vulkan_mesh_context->visible_sector_index_array);
+    free(vulkan_mesh_context->cull_slot_array);
+    free(vulkan_mesh_context->remesh_sector_index_array);
+    free(vulkan_mesh_context->mesh_job_array);
+    free(vulkan_mesh_context->job_array);
+    free(vulkan_mesh_context->sector_mesh_array);
+}
+
+// Marks whether the latest mesh of a sector was dropped for want of room in
+// the vertex arena. The warning is logged once per stall, when the first
+// sector is deferred.
+
+static void render_vulkan_set_sector_mesh_deferred(Render* render, VulkanSectorMesh* sector_mesh, bool is_deferred)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    if (sector_mesh->is_deferred == is_deferred)
+    {
+        return;
+    }
+
+    sector_mesh->is_deferred = is_deferred;
+
+    if (!is_deferred)
+    {
+        vulkan_mesh_context->deferred_sector_count--;
+
+        return;
+    }
+
+    if (vulkan_mesh_context->deferred_sector_count++ == 0)
+    {
+        LOG_WARN("Vertex arena is full, deferring sector meshes until ranges are freed");
+
+        vulkan_mesh_context->is_vertex_arena_freed = false;
+    }
+}
+
+// Queues the deferred sectors to be meshed again once a range of the vertex
+// arena has been freed since they were dropped
+
+static void render_vulkan_requeue_deferred_sectors(Render* render, World* world)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    if (vulkan_mesh_context->deferred_sector_count == 0 || !vulkan_mesh_context->is_vertex_arena_freed)
+    {
+        return;
+    }
+
+    vulkan_mesh_context->is_vertex_arena_freed = false;
+
+    for (SectorIndex sector_index = 0; sector_index < vulkan_mesh_context->sector_mesh_count; ++sector_index)
+    {
+        if (vulkan_mesh_context->sector_mesh_array[sector_index].is_deferred)
+        {
+            world_mark_sector_dirty(world, sector_index);
+        }
+    }
+}
+
+// Stages the CPU mesh of a finished mesh job for a new range of the vertex
+// arena, vertices first and then faces, then frees the sector's previous
+// range. A mesh that finds no room is dropped and its sector deferred.
+
+static void render_vulkan_upload_sector_mesh(Render* render, SectorIndex sector_index)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+    VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_index];
+    VulkanMeshJob* mesh_job = &vulkan_mesh_context->mesh_job_array[sector_index];
+
+    Mesh* mesh = mesh_job->mesh;
+
+    sector_mesh->build_time = mesh_job->build_time;
+
+    const u32 arena_vertex_count = render_vulkan_get_arena_vertex_count(mesh->vertex_count, mesh->face_count);
+
+    u32 first_vertex = 0;
+
+    bool is_allocated = arena_vertex_count > 0 && vertex_arena_allocate(vulkan_mesh_context->vertex_arena, arena_vertex_count, &first_vertex);
+
+    // Set ahead of freeing the previous range, which may make the room the
+    // mesh lacked
+
+    render_vulkan_set_sector_mesh_deferred(render, sector_mesh, arena_vertex_count > 0 && !is_allocated);
+
+    const VkDeviceSize vertex_size = sizeof(VoxelVertex) * mesh->vertex_count;
+    const VkDeviceSize buffer_size = vertex_size + sizeof(VoxelFace) * mesh->face_count;
+
+    u8* data = NULL;
+
+    if (is_allocated)
+    {
+        data = render_vulkan_stage_buffer_copy(
+            render,
+            vulkan_mesh_context->vertex_arena_buffer,
+            sizeof(VoxelVertex) * first_vertex,
+            buffer_size
+        );
+
+        if (!data)
+        {
+            LOG_WARN("Staging ring is too small, dropping the mesh of sector %u", sector_index);
+
+            vertex_arena_free(vulkan_mesh_context->vertex_arena, first_vertex, arena_vertex_count);
+
+            is_allocated = false;
+        }
+    }
+
+    vulkan_mesh_context->triangle_count -= sector_mesh->triangle_count;
+
+    // Staged copies are recorded behind a barrier on the vertex reads of
+    // earlier frames, and behind any pending copy into the same bytes, so
+    // the previous range is free to reuse at once
+
+    render_vulkan_destroy_sector_mesh(render, sector_mesh);
+
+    if (!is_allocated)
+    {
+        cull_clear_box(vulkan_mesh_context->cull, vulkan_mesh_context->cull_slot_array[sector_index]);
+
+        return;
+    }
+
+    if (mesh->vertex_count > 0)
+    {
+        memcpy(data, mesh->vertex_array, vertex_size);
+    }
+
+    if (mesh->face_count > 0)
+    {
+        memcpy(data + vertex_size, mesh->face_array, buffer_size - vertex_size);
+    }
+
+    const u32 triangle_count = mesh->vertex_count / 3 + 2 * mesh->face_count;
+
+    vulkan_mesh_context->triangle_count += triangle_count;
+
+    sector_mesh->vertex_count = mesh->vertex_count;
+    sector_mesh->face_count = mesh->face_count;
+    sector_mesh->triangle_count = triangle_count;
+    sector_mesh->first_vertex = first_vertex;
+    glm_vec3_copy(mesh->origin_position, sector_mesh->origin_position);
+
+    vec3 sector_max_position;
+    glm_vec3_adds(sector_mesh->origin_position, get_sector_size_in_cells() * get_cell_size(), sector_max_position);
+
+    cull_set_box(
+        vulkan_mesh_context->cull,
+        vulkan_mesh_context->cull_slot_array[sector_index],
+        sector_index,
+        sector_mesh->origin_position,
+        sector_max_position
+    );
+}
+
+static u32 render_vulkan_get_distance_lod(f32 distance)
+{
+    u32 lod = 0;
+    f32 lod_distance = LOD_DISTANCE_IN_SECTORS * get_sector_size_in_cells() * get_cell_size();
+
+    while (lod + 1 < MESH_LOD_COUNT && distance >= lod_distance)
+    {
+        lod++;
+        lod_distance *= 2.0f;
+    }
+
+    return lod;
+}
+
+// Picks the level of detail of a sector from the distance between its center
+// and the camera. Coarser levels are taken at their threshold, finer levels
+// only once the sector is closer than theirs by the hysteresis margin.
+
+static u32 render_vulkan_get_sector_lod(Render* render, World* world, SectorIndex sector_index, u32 current_lod)
+{
+    if (!render->vulkan_mesh_context.is_lod_enabled)
+    {
+        return 0;
+    }
+
+    SectorCoordinate sector_coordinate;
+    sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+    GridCoordinate sector_grid_coordinate;
+    sector_coordinate_to_grid_coordinate(sector_coordinate, sector_grid_coordinate);
+
+    vec3 sector_position;
+    grid_coordinate_to_world_position(sector_grid_coordinate, sector_position);
+
+    const f32 distance = glm_vec3_distance(sector_position, world->camera.position);
+
+    const u32 lod = render_vulkan_get_distance_lod(distance);
+
+    if (lod >= current_lod)
+    {
+        return lod;
+    }
+
+    const f32 hysteresis_distance = LOD_HYSTERESIS_IN_SECTORS * get_sector_size_in_cells() * get_cell_size();
+
+    const u32 hysteresis_lod = render_vulkan_get_distance_lod(distance + hysteresis_distance);
+
+    return hysteresis_lod < current_lod ? hysteresis_lod : current_lod;
+}
+
+// A face gets a skirt when the neighbor across it is meshed at another
+// level, or when coarse cells do not line up across sectors because the
+// sector size is not a multiple of their scale
+
+static u32 render_vulkan_get_skirt_direction_mask(Render* render, World* world, SectorIndex sector_index)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    const u32 lod = vulkan_mesh_context->sector_mesh_array[sector_index].lod;
+
+    if (get_sector_size_in_cells() % (1u << lod) != 0)
+    {
+        return (1u << GRID_DIRECTION_COUNT) - 1;
+    }
+
+    SectorCoordinate sector_coordinate;
+    sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+    u32 skirt_direction_mask = 0;
+
+    for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+    {
+        SectorCoordinate neighbor_sector_coordinate;
+        glm_ivec3_add(sector_coordinate, (i32*)grid_direction_offset_array[direction], neighbor_sector_coordinate);
+
+        if (!sector_coordinate_is_valid(neighbor_sector_coordinate, world->window_sector_coordinate))
+        {
+            continue;
+        }
+
+        const SectorIndex neighbor_sector_index = sector_coordinate_to_sector_index(neighbor_sector_coordinate);
+
+        if (vulkan_mesh_context->sector_mesh_array[neighbor_sector_index].lod != lod)
+        {
+            skirt_direction_mask |= 1u << direction;
+        }
+    }
+
+    return skirt_direction_mask;
+}
+
+// Moves sectors to the level of detail of their current distance. A sector
+// changing level is remeshed along with its face neighbors, whose skirts
+// depend on it.
+
+static void render_vulkan_update_sector_lods(Render* render, World* world)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    for (SectorIndex sector_index = 0; sector_index < vulkan_mesh_context->sector_mesh_count; ++sector_index)
+    {
+        VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_index];
+
+        const u32 lod = render_vulkan_get_sector_lod(render, world, sector_index, sector_mesh->lod);
+
+        if (lod == sector_mesh->lod)
+        {
+            continue;
+        }
+
+        sector_mesh->lod = lod;
+
+        if (!vulkan_mesh_context->is_built || !world_sector_is_loaded(world, sector_index))
+        {
+            continue;
+        }
+
+        world_mark_sector_dirty(world, sector_index);
+
+        SectorCoordinate sector_coordinate;
+        sector_index_to_sector_coordinate(sector_index, world->window_sector_coordinate, sector_coordinate);
+
+        for (u32 direction = 0; direction < GRID_DIRECTION_COUNT; ++direction)
+        {
+            SectorCoordinate neighbor_sector_coordinate;
+            glm_ivec3_add(sector_coordinate, (i32*)grid_direction_offset_array[direction], neighbor_sector_coordinate);
+
+            if (!sector_coordinate_is_valid(neighbor_sector_coordinate, world->window_sector_coordinate))
+            {
+                continue;
+            }
+
+            const SectorIndex neighbor_sector_index = sector_coordinate_to_sector_index(neighbor_sector_coordinate);
+
+            if (world_sector_is_loaded(world, neighbor_sector_index))
+            {
+                world_mark_sector_dirty(world, neighbor_sector_index);
+            }
+        }
+    }
+}
+
+// Builds the meshes of the given sectors on the job system and uploads them
+// on the calling thread
+
+static void render_vulkan_remesh_sector_array(Render* render, World* world, const SectorIndex* sector_index_array, u32 sector_count)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    for (u32 remesh_index = 0; remesh_index < sector_count; ++remesh_index)
+    {
+        VulkanMeshJob* mesh_job = &vulkan_mesh_context->mesh_job_array[sector_index_array[remesh_index]];
+
+        mesh_job->world = world;
+        mesh_job->mesh_mode = vulkan_mesh_context->mesh_mode;
+        mesh_job->lod = vulkan_mesh_context->sector_mesh_array[mesh_job->sector_index].lod;
+        mesh_job->skirt_direction_mask = render_vulkan_get_skirt_direction_mask(render, world, mesh_job->sector_index);
+
+        Job* job = &vulkan_mesh_context->job_array[remesh_index];
+
+        job->function = render_vulkan_build_sector_mesh;
+        job->data = mesh_job;
+    }
+
+    const f64 build_start_time = glfwGetTime();
+
+    // A single sector is cheaper to mesh in place than to hand to a worker
+
+    if (sector_count == 1)
+    {
+        render_vulkan_build_sector_mesh(vulkan_mesh_context->job_array[0].data);
+    }
+    else
+    {
+        job_system_submit(
+            render->job_system,
+            vulkan_mesh_context->job_array,
+            sector_count,
+            &vulkan_mesh_context->job_counter
+        );
+
+        job_system_wait(render->job_system, &vulkan_mesh_context->job_counter);
+    }
+
+    vulkan_mesh_context->wall_time = glfwGetTime() - build_start_time;
+
+    vulkan_mesh_context->remesh_sector_count = sector_count;
+    vulkan_mesh_context->build_time = 0.0;
+    vulkan_mesh_context->max_sector_build_time = 0.0;
+
+    for (u32 remesh_index = 0; remesh_index < sector_count; ++remesh_index)
+    {
+        const SectorIndex sector_index = sector_index_array[remesh_index];
+
+        render_vulkan_upload_sector_mesh(render, sector_index);
+
+        VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_index];
+
+        vulkan_mesh_context->build_time += sector_mesh->build_time;
+
+        if (sector_mesh->build_time > vulkan_mesh_context->max_sector_build_time)
+        {
+            vulkan_mesh_context->max_sector_build_time = sector_mesh->build_time;
+        }
+    }
+}
+
+void render_vulkan_update_sector_mesh(Render* render, World* world, SectorIndex sector_index)
+{
+    render_vulkan_remesh_sector_array(render, world, &sector_index, 1);
+}
+
+// Rebuilds every sector when the mesh is invalidated as a whole, and
+// otherwise drains up to MAX_REMESH_SECTORS_PER_FRAME sectors from the
+// world's dirty queue
+
+void render_vulkan_update_world_mesh(Render* render, World* world)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    SectorIndex* sector_index_array = vulkan_mesh_context->remesh_sector_index_array;
+
+    render_vulkan_update_sector_lods(render, world);
+    render_vulkan_requeue_deferred_sectors(render, world);
+
+    if (!vulkan_mesh_context->is_built)
+    {
+        for (SectorIndex sector_index = 0; sector_index < vulkan_mesh_context->sector_mesh_count; ++sector_index)
+        {
+            sector_index_array[sector_index] = sector_index;
+        }
+
+        world_clear_dirty_sectors(world);
+
+        render_vulkan_remesh_sector_array(render, world, sector_index_array, vulkan_mesh_context->sector_mesh_count);
+
+        vulkan_mesh_context->is_built = true;
+
+        LOG_INFO(
+            "World Mesh Built: %u triangles in %.3f ms (%.3f ms on %u workers)",
+            vulkan_mesh_context->triangle_count,
+            vulkan_mesh_context->build_time * 1e3,
+            vulkan_mesh_context->wall_time * 1e3,
+            render->job_system->worker_count
+        );
+
+        return;
+    }
+
+    const u32 sector_count = world_take_dirty_sector_array(world, sector_index_array, MAX_REMESH_SECTORS_PER_FRAME);
+
+    if (sector_count > 0)
+    {
+        render_vulkan_remesh_sector_array(render, world, sector_index_array, sector_count);
+    }
+}
+
+// Draws the solid faces of every loaded sector as occluders, then drops the
+// visible sectors hidden behind them. Faces are read from the live sector,
+// since a mesh slot may still hold the sector that left the window, and
+// sectors meshed at a coarser level are skipped because their mesh does not
+// follow the boundary cells exactly.
+
+static void render_vulkan_occlude_world_mesh(Render* render, World* world)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    Occlusion* occlusion = vulkan_mesh_context->occlusion;
+
+    occlusion_begin(occlusion, render->projection_view_matrix, render->position);
+
+    const f32 sector_size = get_sector_size_in_cells() * get_cell_size();
+
+    for (SectorIndex sector_index = 0; sector_index < vulkan_mesh_context->sector_mesh_count; ++sector_index)
+    {
+        Sector* sector = world_get_sector(world, sector_index);
+
+        if (
+            !sector ||
+            !world_sector_is_loaded(world, sector_index) ||
+            vulkan_mesh_context->sector_mesh_array[sector_index].lod > 0
+        ) {
+            continue;
+        }
+
+        const u32 solid_face_mask = sector_get_solid_face_mask(sector);
+
+        if (solid_face_mask == 0)
+        {
+            continue;
+        }
+
+        GridCoordinate sector_grid_coordinate;
+        sector_coordinate_to_grid_coordinate(sector->coordinate, sector_grid_coordinate);
+        glm_ivec3_adds(sector_grid_coordinate, SECTOR_MIN_CELL, sector_grid_coordinate);
+
+        vec3 sector_min_position;
+        grid_coordinate_to_world_position(sector_grid_coordinate, sector_min_position);
+        glm_vec3_subs(sector_min_position, CELL_RADIUS, sector_min_position);
+
+        vec3 sector_max_position;
+        glm_vec3_adds(sector_min_position, sector_size, sector_max_position);
+
+        occlusion_draw_box_faces(occlusion, sector_min_position, sector_max_position, get_cell_size(), solid_face_mask);
+    }
+
+    occlusion_build_pyramid(occlusion);
+
+    u32 visible_sector_count = 0;
+
+    for (u32 visible_index = 0; visible_index < vulkan_mesh_context->visible_sector_count; ++visible_index)
+    {
+        const SectorIndex sector_index = vulkan_mesh_context->visible_sector_index_array[visible_index];
+
+        VulkanSectorMesh* sector_mesh = &vulkan_mesh_context->sector_mesh_array[sector_index];
+
+        vec3 sector_max_position;
+        glm_vec3_adds(sector_mesh->origin_position, sector_size, sector_max_position);
+
+        if (occlusion_is_box_visible(occlusion, sector_mesh->origin_position, sector_max_position))
+        {
+            vulkan_mesh_context->visible_sector_index_array[visible_sector_count++] = sector_index;
+        }
+    }
+
+    vulkan_mesh_context->visible_sector_count = visible_sector_count;
+}
+
+// Selects the sector meshes to draw this frame, those whose bounds are not
+// outside the view frustum, or every sector with a mesh when culling is off
+// or left to the GPU, and not hidden behind solid sector faces
+
+void render_vulkan_cull_world_mesh(Render* render, World* world)
+{
+    VulkanMeshContext* vulkan_mesh_context = &render->vulkan_mesh_context;
+
+    const f64 cull_start_time = glfwGetTime();
+
+    vulkan_mesh_context->visible_sector_count = 0;
+
+    if (vulkan_mesh_context->is_culling_enabled && !vulkan_mesh_context->is_gpu_culling_enabled)
+    {
+        Frustum frustum;
+        frustum_from_projection_view_matrix(render->projection_view_matrix, &frustum);
+
+        Cull* cull = vulkan_mesh_context->cull;
+
+        cull_frustum(cull, &frustum);
+
+        for (u32 visible_index = 0; visible_index < cull->visible_count; ++visible_index)
+        {
+            vulkan_mesh_context->visible_sector_index_array[visible_index] = cull->visible_id_array[visible_index];
+        }
+
+        vulkan_mesh_context->visible_sector_count = cull->visible_count;
+    }
+    else
+    {
+        for (SectorIndex sector_index = 0; sector_index < vulkan_mesh_context->sector_mesh_count; ++sector_index)
+        {
+            if (vulkan_mesh_context->sector_mesh_array[sector_index].triangle_count > 0)
+            {
+                vulkan_mesh_context->visible_sector_index_array[vulkan_mesh_context->visible_sector_count++] = sector_index;
+            }
+        }
+    }
+
+    vulkan_mesh_context->frustum_visible_sector_count = vulkan_mesh_context->visible_sector_count;
+
+    const f64 occlusion_start_time = glfwGetTime();
+
+    if (vulkan_mesh_context->is_occlusion_enabled)
+    {
+        render_vulkan_occlude_world_mesh(render, world);
+    }
+
+    vulkan_mesh_context->occlusion_time = glfwGetTime() - occlusion_start_time;
+    vulkan_mesh_context->cull_time = occlusion_start_time - cull_start_time;
+}
@@ -73,6 +73,37 @@ void render_vulkan_update_texture_descriptor(
     );
 }
 
+// Points the voxel set at the buffer instanced faces are read from
+
+void render_vulkan_update_face_descriptor(Render* render, VkBuffer buffer, VkDeviceSize size)
+{
+    VkDescriptorBufferInfo buffer_info =
+    {
+        .buffer = buffer,
+        .offset = 0,
+        .range = size,
+    };
+
+    VkWriteDescriptorSet write_descriptor_set =
+    {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = render->voxel_pipeline_context.descriptor_set,
+        .dstBinding = 1,
+        .dstArrayElement = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .pBufferInfo = &buffer_info,
+    };
+
+    vkUpdateDescriptorSets(
+        render->vulkan_device_context.device,
+        1,
+        &write_descriptor_set,
+        0,
+        NULL
+    );
+}
+
 void render_vulkan_create_and_init_voxel_pipeline(Render* render)
 {
     VkShaderModule vert_module = 
@@ -81,6 +112,12 @@ void render_vulkan_create_and_init_voxel_pipeline(Render* render)
             "assets/shaders/bin/voxel.vert.spv"
         );
 
+    VkShaderModule face_vert_module =
+        render_vulkan_create_shader_module(
+            render->vulkan_device_context.device,
+            "assets/shaders/bin/voxel_face.vert.spv"
+        );
+
     VkShaderModule frag_module = 
         render_vulkan_create_shader_module(
             render->vulkan_device_context.device, 
@@ -112,7 +149,7 @@ void render_vulkan_create_and_init_voxel_pipeline(Render* render)
     VkVertexInputBindingDescription vertex_input_binding =
     {
         .binding = 0,
-        .stride = sizeof(Vertex),
+        .stride = sizeof(VoxelVertex),
         .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
     };
 
@@ -121,14 +158,14 @@ void render_vulkan_create_and_init_voxel_pipeline(Render* render)
         {
             .binding = 0,
             .location = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(Vertex, position)
+            .format = VK_FORMAT_R32_UINT,
+            .offset = offsetof(VoxelVertex, data)
         },
         {
             .binding = 0,
             .location = 1,
-            .format = VK_FORMAT_R32G32_SFLOAT,
-            .offset = offsetof(Vertex, uv)
+            .format = VK_FORMAT_R32_UINT,
+            .offset = offsetof(VoxelVertex, light)
         },
     };
 
@@ -241,20 +278,31 @@ void render_vulkan_create_and_init_voxel_pipeline(Render* render)
         .blendConstants = { 0, 0, 0, 0 },
     };
 
-    VkDescriptorSetLayoutBinding descriptor_set_layout_binding = 
+    // The texture, and the vertex arena instanced faces are read from
+
+    VkDescriptorSetLayoutBinding descriptor_set_layout_binding_array[2] =
     {
-        .binding = 0,
-        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-        .descriptorCount = 1,
-        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-        .pImmutableSamplers = NULL,
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .pImmutableSamplers = NULL,
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .pImmutableSamplers = NULL,
+        },
     };
 
     VkDescriptorSetLayoutCreateInfo descriptor_set_layout_info =
     {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = 1,
-        .pBindings = &descriptor_set_layout_binding
+        .bindingCount = 2,
+        .pBindings = descriptor_set_layout_binding_array
     };
 
     VkResult descriptor_set_layout_result = 
@@ -270,18 +318,24 @@ void render_vulkan_create_and_init_voxel_pipeline(Render* render)
         LOG_FATAL("Failed to create descriptor set layout");
     }
 
-    VkDescriptorPoolSize pool_size =
+    VkDescriptorPoolSize pool_size_array[2] =
     {
-        .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-        .descriptorCount = 64
+        {
+            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 64
+        },
+        {
+            .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 64
+        },
     };
 
     VkDescriptorPoolCreateInfo pool_info =
     {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .maxSets = 64,
-        .poolSizeCount = 1,
-        .pPoolSizes = &pool_size
+        .poolSizeCount = 2,
+        .pPoolSizes = pool_size_array
     };
 
     VkResult descriptor_pool_result =
@@ -324,11 +378,20 @@ void render_vulkan_create_and_init_voxel_pipeline(Render* render)
         .size = sizeof(VoxelPushConstants),
     };
 
+    // The sectors of the frame are bound as the second set, with the layout
+    // of the cull pipeline
+
+    VkDescriptorSetLayout descriptor_set_layout_array[] =
+    {
+        render->voxel_pipeline_context.descriptor_set_layout,
+        render->cull_pipeline_context.descriptor_set_layout,
+    };
+
     VkPipelineLayoutCreateInfo pipeline_layout_info = 
     {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount = 1,
-        .pSetLayouts = &render->voxel_pipeline_context.descriptor_set_layout,
+        .setLayoutCount = 2,
+        .pSetLayouts = descriptor_set_layout_array,
         .pushConstantRangeCount = 1,
         .pPushConstantRanges = &push_constant_range,
     };
@@ -381,7 +444,39 @@ void render_vulkan_create_and_init_voxel_pipeline(Render* render)
         LOG_FATAL("Failed to create Vulkan graphics pipeline");
     }
 
+    // Instanced faces have no vertex input and expand each instance into a
+    // strip of two triangles
+
+    shader_stage_array[0].module = face_vert_module;
+
+    VkPipelineVertexInputStateCreateInfo face_vertex_input_state_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = 0,
+        .vertexAttributeDescriptionCount = 0,
+    };
+
+    pipeline_input_assembly_state_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+
+    graphics_pipeline_info.pVertexInputState = &face_vertex_input_state_info;
+
+    VkResult face_pipeline_result =
+        vkCreateGraphicsPipelines(
+            render->vulkan_device_context.device,
+            VK_NULL_HANDLE,
+            1,
+            &graphics_pipeline_info,
+            NULL,
+            &render->voxel_pipeline_context.face_pipeline
+        );
+
+    if (face_pipeline_result != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to create Vulkan face pipeline");
+    }
+
     vkDestroyShaderModule(render->vulkan_device_context.device, frag_module, NULL);
+    vkDestroyShaderModule(render->vulkan_device_context.device, face_vert_module, NULL);
     vkDestroyShaderModule(render->vulkan_device_context.device, vert_module, NULL);
 
     LOG_INFO("Voxel Pipeline Initialized");
@@ -404,29 +499,10 @@ void render_vulkan_destroy_voxel_pipeline(Render* render)
         NULL
     );
 
-    vkDestroyImage(
-        device,
+    render_vulkan_destroy_image(
+        render,
         render->voxel_pipeline_context.vulkan_texture.image,
-        NULL
-    );
-
-    vkFreeMemory(
-        device,
-        render->voxel_pipeline_context.vulkan_texture.image_memory,
-        NULL
-    );
-
-    // Destroy vertex buffer
-    vkDestroyBuffer(
-        device,
-        render->voxel_pipeline_context.vertex_buffer,
-        NULL
-    );
-
-    vkFreeMemory(
-        device,
-        render->voxel_pipeline_context.vertex_memory,
-        NULL
+        &render->voxel_pipeline_context.vulkan_texture.image_allocation
     );
 
     // Destroy descriptor resources
@@ -443,6 +519,12 @@ void render_vulkan_destroy_voxel_pipeline(Render* render)
     );
 
     // Destroy pipeline objects
+    vkDestroyPipeline(
+        device,
+        render->voxel_pipeline_context.face_pipeline,
+        NULL
+    );
+
     vkDestroyPipeline(
         device,
         render->voxel_pipeline_context.pipeline,
@@ -716,3 +798,156 @@ void render_vulkan_destroy_nuklear_pipeline(Render* render)
 {
 
 }
+
+void render_vulkan_create_and_init_cull_pipeline(Render* render)
+{
+    VkShaderModule comp_module =
+        render_vulkan_create_shader_module(
+            render->vulkan_device_context.device,
+            "assets/shaders/bin/cull.comp.spv"
+        );
+
+    VkPipelineShaderStageCreateInfo comp_stage_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+        .module = comp_module,
+        .pName = "main",
+    };
+
+    // Sector bounds, draw commands and the visible count. The voxel
+    // pipeline binds the same set to read the sector origins.
+
+    VkDescriptorSetLayoutBinding descriptor_set_layout_binding_array[3];
+
+    for (u32 binding = 0; binding < 3; ++binding)
+    {
+        descriptor_set_layout_binding_array[binding] = (VkDescriptorSetLayoutBinding)
+        {
+            .binding = binding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = binding == 0 ? VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = NULL,
+        };
+    }
+
+    VkDescriptorSetLayoutCreateInfo descriptor_set_layout_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 3,
+        .pBindings = descriptor_set_layout_binding_array
+    };
+
+    VkResult descriptor_set_layout_result =
+        vkCreateDescriptorSetLayout(
+            render->vulkan_device_context.device,
+            &descriptor_set_layout_info,
+            NULL,
+            &render->cull_pipeline_context.descriptor_set_layout
+        );
+
+    if (descriptor_set_layout_result != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to create cull descriptor set layout");
+    }
+
+    // Each frame in flight allocates its own set
+
+    VkDescriptorPoolSize pool_size =
+    {
+        .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 3 * MAX_FRAMES_IN_FLIGHT
+    };
+
+    VkDescriptorPoolCreateInfo pool_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets = MAX_FRAMES_IN_FLIGHT,
+        .poolSizeCount = 1,
+        .pPoolSizes = &pool_size
+    };
+
+    VkResult descriptor_pool_result =
+        vkCreateDescriptorPool(
+            render->vulkan_device_context.device,
+            &pool_info,
+            NULL,
+            &render->cull_pipeline_context.descriptor_pool
+        );
+
+    if (descriptor_pool_result != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to create cull descriptor pool");
+    }
+
+    render->cull_pipeline_context.descriptor_set = VK_NULL_HANDLE;
+
+    VkPushConstantRange push_constant_range =
+    {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(CullPushConstants),
+    };
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &render->cull_pipeline_context.descriptor_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range,
+    };
+
+    VkResult pipeline_layout_result =
+        vkCreatePipelineLayout(
+            render->vulkan_device_context.device,
+            &pipeline_layout_info,
+            NULL,
+            &render->cull_pipeline_context.layout
+        );
+
+    if (pipeline_layout_result != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to create cull pipeline layout");
+    }
+
+    VkComputePipelineCreateInfo compute_pipeline_info =
+    {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = comp_stage_info,
+        .layout = render->cull_pipeline_context.layout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
+    };
+
+    VkResult compute_pipeline_result =
+        vkCreateComputePipelines(
+            render->vulkan_device_context.device,
+            VK_NULL_HANDLE,
+            1,
+            &compute_pipeline_info,
+            NULL,
+            &render->cull_pipeline_context.pipeline
+        );
+
+    if (compute_pipeline_result != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to create cull compute pipeline");
+    }
+
+    vkDestroyShaderModule(render->vulkan_device_context.device, comp_module, NULL);
+
+    LOG_INFO("Cull Pipeline Initialized");
+}
+
+void render_vulkan_destroy_cull_pipeline(Render* render)
+{
+    VkDevice device = render->vulkan_device_context.device;
+
+    vkDestroyDescriptorPool(device, render->cull_pipeline_context.descriptor_pool, NULL);
+    vkDestroyDescriptorSetLayout(device, render->cull_pipeline_context.descriptor_set_layout, NULL);
+
+    vkDestroyPipeline(device, render->cull_pipeline_context.pipeline, NULL);
+    vkDestroyPipelineLayout(device, render->cull_pipeline_context.layout, NULL);
+}
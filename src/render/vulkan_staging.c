@@ -0,0 +1,472 @@
+#include "render/render.h"
+
+#include <string.h>
+
+#include "core/log/log.h"
+
+void render_vulkan_create_and_init_staging_context(Render* render)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    render_vulkan_create_buffer(
+        render,
+        VULKAN_STAGING_RING_SIZE,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        &vulkan_staging_context->buffer,
+        &vulkan_staging_context->allocation
+    );
+
+    vulkan_staging_context->head = 0;
+    vulkan_staging_context->tail = 0;
+    vulkan_staging_context->recorded_head = 0;
+
+    vulkan_staging_context->release_count = 0;
+    vulkan_staging_context->copy_count = 0;
+
+    vulkan_staging_context->flushed_size = 0;
+    vulkan_staging_context->flushed_copy_count = 0;
+    vulkan_staging_context->early_flush_count = 0;
+    vulkan_staging_context->stall_count = 0;
+
+    LOG_INFO("Vulkan Staging Initialized");
+}
+
+void render_vulkan_destroy_staging_context(Render* render)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    render_vulkan_destroy_buffer(render, vulkan_staging_context->buffer, &vulkan_staging_context->allocation);
+}
+
+// Whether a buffer copy writes bytes that one of the buffer copies from a
+// first index on also writes
+
+static bool render_vulkan_is_staging_copy_overlapping(const VulkanStagingContext* vulkan_staging_context, u32 first_copy_index, u32 copy_index)
+{
+    const VulkanStagingCopy* copy = &vulkan_staging_context->copy_array[copy_index];
+
+    for (u32 other_copy_index = first_copy_index; other_copy_index < copy_index; ++other_copy_index)
+    {
+        const VulkanStagingCopy* other_copy = &vulkan_staging_context->copy_array[other_copy_index];
+
+        if (
+            other_copy->kind == VULKAN_STAGING_COPY_KIND_BUFFER &&
+            other_copy->dst_buffer == copy->dst_buffer &&
+            other_copy->dst_offset < copy->dst_offset + copy->size &&
+            copy->dst_offset < other_copy->dst_offset + other_copy->size
+        ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Records every pending copy, behind a barrier on the vertex reads of
+// earlier submissions, as a copy may overwrite an arena range they draw
+// from that has been freed since. Runs of buffer copies into the same
+// buffer go out as one command.
+//
+// A freed range may be reused while a copy into it is still pending, when
+// copies carry over a frame that was not recorded. A copy writing bytes
+// that an earlier copy also writes is ordered behind it with a transfer
+// barrier, so the later copy lands last.
+
+static void render_vulkan_record_staging_copies(Render* render, VkCommandBuffer command_buffer)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    vulkan_staging_context->flushed_size = 0;
+    vulkan_staging_context->flushed_copy_count = vulkan_staging_context->copy_count;
+
+    if (vulkan_staging_context->copy_count == 0)
+    {
+        return;
+    }
+
+    VkImageMemoryBarrier image_barrier_array[VULKAN_STAGING_MAX_COPY_COUNT];
+    u32 image_barrier_count = 0;
+
+    for (u32 copy_index = 0; copy_index < vulkan_staging_context->copy_count; ++copy_index)
+    {
+        const VulkanStagingCopy* copy = &vulkan_staging_context->copy_array[copy_index];
+
+        vulkan_staging_context->flushed_size += copy->size;
+
+        if (copy->kind != VULKAN_STAGING_COPY_KIND_IMAGE)
+        {
+            continue;
+        }
+
+        image_barrier_array[image_barrier_count++] = (VkImageMemoryBarrier)
+        {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = copy->dst_image,
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+    }
+
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0,
+        NULL,
+        0,
+        NULL,
+        image_barrier_count,
+        image_barrier_array
+    );
+
+    VkBufferCopy region_array[VULKAN_STAGING_MAX_COPY_COUNT];
+
+    VkMemoryBarrier transfer_barrier =
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    };
+
+    u32 copy_index = 0;
+
+    // First copy not yet ordered behind a transfer barrier
+
+    u32 unordered_copy_index = 0;
+
+    while (copy_index < vulkan_staging_context->copy_count)
+    {
+        const VulkanStagingCopy* copy = &vulkan_staging_context->copy_array[copy_index];
+
+        if (copy->kind == VULKAN_STAGING_COPY_KIND_IMAGE)
+        {
+            VkBufferImageCopy image_region =
+            {
+                .bufferOffset = copy->staging_offset,
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = 0,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1
+                },
+                .imageOffset = { 0, 0, 0 },
+                .imageExtent = { copy->width, copy->height, 1 }
+            };
+
+            vkCmdCopyBufferToImage(
+                command_buffer,
+                vulkan_staging_context->buffer,
+                copy->dst_image,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1,
+                &image_region
+            );
+
+            copy_index++;
+
+            continue;
+        }
+
+        if (render_vulkan_is_staging_copy_overlapping(vulkan_staging_context, unordered_copy_index, copy_index))
+        {
+            vkCmdPipelineBarrier(
+                command_buffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                1,
+                &transfer_barrier,
+                0,
+                NULL,
+                0,
+                NULL
+            );
+
+            unordered_copy_index = copy_index;
+        }
+
+        u32 region_count = 0;
+
+        while (
+            copy_index < vulkan_staging_context->copy_count &&
+            vulkan_staging_context->copy_array[copy_index].kind == VULKAN_STAGING_COPY_KIND_BUFFER &&
+            vulkan_staging_context->copy_array[copy_index].dst_buffer == copy->dst_buffer &&
+            !render_vulkan_is_staging_copy_overlapping(vulkan_staging_context, unordered_copy_index, copy_index)
+        ) {
+            const VulkanStagingCopy* region_copy = &vulkan_staging_context->copy_array[copy_index];
+
+            region_array[region_count++] = (VkBufferCopy)
+            {
+                .srcOffset = region_copy->staging_offset,
+                .dstOffset = region_copy->dst_offset,
+                .size = region_copy->size
+            };
+
+            copy_index++;
+        }
+
+        vkCmdCopyBuffer(command_buffer, vulkan_staging_context->buffer, copy->dst_buffer, region_count, region_array);
+    }
+
+    for (u32 image_barrier_index = 0; image_barrier_index < image_barrier_count; ++image_barrier_index)
+    {
+        VkImageMemoryBarrier* image_barrier = &image_barrier_array[image_barrier_index];
+
+        image_barrier->srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        image_barrier->dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        image_barrier->oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        image_barrier->newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+
+    VkMemoryBarrier copy_barrier =
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+    };
+
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        1,
+        &copy_barrier,
+        0,
+        NULL,
+        image_barrier_count,
+        image_barrier_array
+    );
+
+    vulkan_staging_context->copy_count = 0;
+}
+
+// Releases the bytes read by every submission whose ticket has completed,
+// as of the most recent poll of the uploads
+
+void render_vulkan_poll_staging(Render* render)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    u32 released_count = 0;
+
+    while (
+        released_count < vulkan_staging_context->release_count &&
+        render_vulkan_is_upload_complete(render, vulkan_staging_context->release_array[released_count].ticket)
+    ) {
+        vulkan_staging_context->tail = vulkan_staging_context->release_array[released_count].head;
+
+        released_count++;
+    }
+
+    if (released_count > 0)
+    {
+        vulkan_staging_context->release_count -= released_count;
+
+        memmove(
+            vulkan_staging_context->release_array,
+            vulkan_staging_context->release_array + released_count,
+            sizeof(VulkanStagingRelease) * vulkan_staging_context->release_count
+        );
+    }
+}
+
+// Waits for the oldest submission still reading the ring and releases its
+// bytes
+
+static void render_vulkan_wait_staging(Render* render)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    render_vulkan_wait_upload(render, vulkan_staging_context->release_array[0].ticket);
+    render_vulkan_poll_staging(render);
+
+    vulkan_staging_context->stall_count++;
+}
+
+// Holds the ring up to a head until a submission's ticket completes. A head
+// no further than the previous one holds nothing more.
+
+static void render_vulkan_push_staging_release(Render* render, u64 head, VulkanUploadTicket ticket)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    const u64 held_head = vulkan_staging_context->release_count > 0 ?
+        vulkan_staging_context->release_array[vulkan_staging_context->release_count - 1].head :
+        vulkan_staging_context->tail;
+
+    if (head <= held_head)
+    {
+        return;
+    }
+
+    if (vulkan_staging_context->release_count == VULKAN_STAGING_MAX_RELEASE_COUNT)
+    {
+        render_vulkan_wait_staging(render);
+    }
+
+    vulkan_staging_context->release_array[vulkan_staging_context->release_count++] = (VulkanStagingRelease)
+    {
+        .head = head,
+        .ticket = ticket,
+    };
+}
+
+// Submits the pending copies on their own, ahead of the frame they were
+// staged for, without waiting for them
+
+static void render_vulkan_flush_staging(Render* render)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    VkCommandBuffer command_buffer = render_vulkan_begin_single_time_commands(render);
+
+    render_vulkan_record_staging_copies(render, command_buffer);
+
+    const VulkanUploadTicket ticket = render_vulkan_end_single_time_commands(render, command_buffer);
+
+    render_vulkan_push_staging_release(render, vulkan_staging_context->head, ticket);
+
+    vulkan_staging_context->early_flush_count++;
+}
+
+// Start of a reservation at the head, aligned and moved to the start of
+// the ring when it would run past the end
+
+static u64 render_vulkan_get_staging_start(const VulkanStagingContext* vulkan_staging_context, VkDeviceSize size)
+{
+    u64 start = (vulkan_staging_context->head + VULKAN_STAGING_ALIGNMENT - 1) & ~(u64)(VULKAN_STAGING_ALIGNMENT - 1);
+
+    if (start % VULKAN_STAGING_RING_SIZE + size > VULKAN_STAGING_RING_SIZE)
+    {
+        start += VULKAN_STAGING_RING_SIZE - start % VULKAN_STAGING_RING_SIZE;
+    }
+
+    return start;
+}
+
+// Reserves staging bytes and appends a copy of them. A full copy list goes
+// out early, and a full ring waits for the oldest submissions reading it,
+// sending out the pending copies first when they hold the rest.
+
+static VulkanStagingCopy* render_vulkan_reserve_staging_copy(Render* render, VkDeviceSize size)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    if (size > VULKAN_STAGING_RING_SIZE)
+    {
+        return NULL;
+    }
+
+    if (vulkan_staging_context->copy_count == VULKAN_STAGING_MAX_COPY_COUNT)
+    {
+        render_vulkan_flush_staging(render);
+    }
+
+    u64 start = render_vulkan_get_staging_start(vulkan_staging_context, size);
+
+    while (start + size - vulkan_staging_context->tail > VULKAN_STAGING_RING_SIZE)
+    {
+        render_vulkan_poll_uploads(render);
+        render_vulkan_poll_staging(render);
+
+        if (vulkan_staging_context->tail == vulkan_staging_context->head)
+        {
+            // Nothing reads the ring, so the reservation starts over at its
+            // beginning
+
+            vulkan_staging_context->head = 0;
+            vulkan_staging_context->tail = 0;
+            vulkan_staging_context->recorded_head = 0;
+        }
+        else if (vulkan_staging_context->release_count > 0)
+        {
+            render_vulkan_wait_staging(render);
+        }
+        else
+        {
+            render_vulkan_flush_staging(render);
+        }
+
+        start = render_vulkan_get_staging_start(vulkan_staging_context, size);
+    }
+
+    vulkan_staging_context->head = start + size;
+
+    VulkanStagingCopy* copy = &vulkan_staging_context->copy_array[vulkan_staging_context->copy_count++];
+
+    copy->staging_offset = start % VULKAN_STAGING_RING_SIZE;
+    copy->size = size;
+
+    return copy;
+}
+
+void* render_vulkan_stage_buffer_copy(Render* render, VkBuffer dst_buffer, VkDeviceSize dst_offset, VkDeviceSize size)
+{
+    VulkanStagingCopy* copy = render_vulkan_reserve_staging_copy(render, size);
+
+    if (!copy)
+    {
+        return NULL;
+    }
+
+    copy->kind = VULKAN_STAGING_COPY_KIND_BUFFER;
+    copy->dst_buffer = dst_buffer;
+    copy->dst_offset = dst_offset;
+
+    return (u8*)render->vulkan_staging_context.allocation.mapped + copy->staging_offset;
+}
+
+void* render_vulkan_stage_image_copy(Render* render, VkImage dst_image, u32 width, u32 height)
+{
+    VulkanStagingCopy* copy = render_vulkan_reserve_staging_copy(render, (VkDeviceSize)width * height * 4);
+
+    if (!copy)
+    {
+        return NULL;
+    }
+
+    copy->kind = VULKAN_STAGING_COPY_KIND_IMAGE;
+    copy->dst_image = dst_image;
+    copy->width = width;
+    copy->height = height;
+
+    return (u8*)render->vulkan_staging_context.allocation.mapped + copy->staging_offset;
+}
+
+// Records the copies staged since the previous frame into a frame's command
+// buffer, ahead of anything that reads their destinations
+
+void render_vulkan_record_staging_commands(Render* render, VkCommandBuffer command_buffer)
+{
+    VulkanStagingContext* vulkan_staging_context = &render->vulkan_staging_context;
+
+    render_vulkan_record_staging_copies(render, command_buffer);
+
+    vulkan_staging_context->recorded_head = vulkan_staging_context->head;
+}
+
+// Holds the bytes of the recorded copies until the frame's ticket completes
+
+void render_vulkan_retire_staging_frame(Render* render, VulkanUploadTicket ticket)
+{
+    render_vulkan_push_staging_release(render, render->vulkan_staging_context.recorded_head, ticket);
+}
@@ -228,59 +228,16 @@ void render_vulkan_create_depth_resources(Render* render)
 {
     VkFormat depth_format = VK_FORMAT_D32_SFLOAT;
 
-    VkImageCreateInfo image_info =
-    {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .imageType = VK_IMAGE_TYPE_2D,
-        .extent =
-        {
-            render->vulkan_swapchain_context.extent.width,
-            render->vulkan_swapchain_context.extent.height,
-            1
-        },
-        .mipLevels = 1,
-        .arrayLayers = 1,
-        .format = depth_format,
-        .tiling = VK_IMAGE_TILING_OPTIMAL,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-        .samples = VK_SAMPLE_COUNT_1_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-    };
-
-    vkCreateImage(
-        render->vulkan_device_context.device,
-        &image_info,
-        NULL,
-        &render->vulkan_swapchain_context.depth_image
-    );
-
-    VkMemoryRequirements mem_requirements;
-    vkGetImageMemoryRequirements(
-        render->vulkan_device_context.device,
-        render->vulkan_swapchain_context.depth_image,
-        &mem_requirements
-    );
-
-    VkMemoryAllocateInfo alloc_info =
-    {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = mem_requirements.size,
-        .memoryTypeIndex = 0
-    };
-
-    vkAllocateMemory(
-        render->vulkan_device_context.device,
-        &alloc_info,
-        NULL,
-        &render->vulkan_swapchain_context.depth_memory
-    );
-
-    vkBindImageMemory(
-        render->vulkan_device_context.device,
-        render->vulkan_swapchain_context.depth_image,
-        render->vulkan_swapchain_context.depth_memory,
-        0
+    render_vulkan_create_image(
+        render,
+        render->vulkan_swapchain_context.extent.width,
+        render->vulkan_swapchain_context.extent.height,
+        depth_format,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &render->vulkan_swapchain_context.depth_image,
+        &render->vulkan_swapchain_context.depth_allocation
     );
 
     VkImageViewCreateInfo view_info =
@@ -375,16 +332,10 @@ void render_vulkan_destroy_swapchain_context(Render* render)
         NULL
     );
 
-    vkDestroyImage(
-        render->vulkan_device_context.device,
+    render_vulkan_destroy_image(
+        render,
         render->vulkan_swapchain_context.depth_image,
-        NULL
-    );
-
-    vkFreeMemory(
-        render->vulkan_device_context.device,
-        render->vulkan_swapchain_context.depth_memory,
-        NULL
+        &render->vulkan_swapchain_context.depth_allocation
     );
 
     vkDestroyRenderPass(